@@ -0,0 +1,112 @@
+/**
+ **************************************************
+ *
+ * @file        WaveformBenchmark.ino
+ * @brief       Measures how long each phase of the waveform takes to send to the panel and
+ *              compares refresh time and CPU usage of sending lines with polling and in the
+ *              background (interrupt driven). Results are printed to the Serial Monitor (115200 baud).
+ *
+ * For info on how to quickly get started with Inkplate 10 visit
+ * https://soldered.com/documentation/inkplate/10/overview/
+ *
+ * @authors     Soldered
+ * @date        November 2025
+ ***************************************************/
+
+// Next 3 lines are a precaution, you can ignore those, and the example would also work without them
+#ifndef ARDUINO_INKPLATE10V2
+#error "Wrong board selection for this example, please select Soldered Inkplate 10"
+#endif
+
+// Include the Inkplate LVGL Library
+#include <Inkplate-LVGL.h>
+
+// Create an instance of Inkplate object in grayscale mode
+Inkplate inkplate(INKPLATE_3BIT);
+
+// Print how long each phase of the last refresh took. One line per phase: "phase,<refresh>,<index>,<time us>"
+void printPhaseTimes(const char *refresh)
+{
+  uint32_t total = 0;
+  for (int i = 0; i < inkplate.getPhaseCount(); i++)
+  {
+    Serial.printf("phase,%s,%d,%lu\n", refresh, i, (unsigned long)inkplate.getPhaseTime(i));
+    total += inkplate.getPhaseTime(i);
+  }
+  Serial.printf("total,%s,%lu\n", refresh, (unsigned long)total);
+}
+
+// Print refresh time and how much of it the CPU was busy. One line: "refresh,<sender>,<time us>,<cpu %>"
+void printRefreshTime(const char *sender)
+{
+  uint32_t refreshTime = inkplate.getRefreshTime();
+  uint32_t busyTime = refreshTime - inkplate.getCpuFreeTime();
+  Serial.printf("refresh,%s,%lu,%lu\n", sender, (unsigned long)refreshTime,
+                (unsigned long)(refreshTime ? (100ULL * busyTime / refreshTime) : 0));
+}
+
+// Fill the screen with 8 gray bars so every phase of the grayscale waveform has work to do
+void drawTestImage()
+{
+  lv_display_t *disp = lv_display_get_default();
+  int w = lv_display_get_horizontal_resolution(disp);
+  int h = lv_display_get_vertical_resolution(disp);
+
+  lv_obj_clean(lv_screen_active());
+  for (int i = 0; i < 8; i++)
+  {
+    lv_obj_t *rect = lv_obj_create(lv_screen_active());
+    lv_obj_remove_flag(rect, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_size(rect, w / 8, h);
+    lv_obj_set_pos(rect, i * (w / 8), 0);
+    lv_obj_set_style_border_width(rect, 0, LV_PART_MAIN);
+    lv_obj_set_style_radius(rect, 0, LV_PART_MAIN);
+    lv_obj_set_style_bg_color(rect, lv_color_make(i * 36, i * 36, i * 36), LV_PART_MAIN);
+  }
+
+  lv_tick_inc(50);
+  lv_timer_handler();
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  inkplate.begin();
+
+  // Grayscale full refresh
+  drawTestImage();
+  inkplate.display();
+  printPhaseTimes("3bit");
+
+  // Same refresh with lines sent using polling and in the background
+  if (inkplate.setAsyncLines(false))
+  {
+    inkplate.display();
+    printRefreshTime("polling");
+    inkplate.setAsyncLines(true);
+    inkplate.display();
+    printRefreshTime("interrupt");
+    // Back to the default
+    inkplate.setAsyncLines(false);
+  }
+  else
+  {
+    printRefreshTime("polling");
+    Serial.println("Background line sending is not supported on this board");
+  }
+
+  // Black and white full refresh
+  inkplate.selectDisplayMode(INKPLATE_1BIT);
+  drawTestImage();
+  inkplate.display();
+  printPhaseTimes("1bit");
+
+  // Partial update of the same image
+  inkplate.partialUpdate();
+  printPhaseTimes("partial");
+}
+
+void loop()
+{
+  // Empty loop
+}
@@ -0,0 +1,58 @@
+/**
+ **************************************************
+ *
+ * @file        PipelineBenchmark.ino
+ * @brief       Measures the display pipeline hot paths (LVGL flush (1 bit and 3 bit), dithering, waveform LUT calculation, partial
+ *              update diff and line building) on synthetic, text, UI and
+ *              photo frames at the resolution of the Inkplate 5V2. Results are printed to the Serial Monitor
+ *              (115200 baud) as CSV, one line per kernel and frame:
+ *              bench,<board>,<kernel>,<frame>,<pixels>,<bytes>,<iterations>,<ns min>,<ns mean>,<ns/pixel>,<MB/s>
+ *
+ *              The same benchmark runs on the PC with "make bench" in extras/simulator.
+ *
+ * For info on how to quickly get started with Inkplate 5V2 visit
+ * https://soldered.com/documentation/inkplate/5v2/overview/
+ *
+ * @authors     Soldered
+ * @date        November 2025
+ ***************************************************/
+
+// Next 3 lines are a precaution, you can ignore those, and the example would also work without them
+#ifndef ARDUINO_INKPLATE5V2
+#error "Wrong board selection for this example, please select Soldered Inkplate 5 V2"
+#endif
+
+// Include the Inkplate LVGL Library
+#include <Inkplate-LVGL.h>
+
+// How many times each kernel runs, the fastest run is reported
+#define ITERATIONS 5
+
+// Create an instance of Inkplate object, benchmark switches between 1 bit and 3 bit mode itself
+Inkplate inkplate(INKPLATE_1BIT);
+
+// Create the benchmark
+PipelineBenchmark benchmark;
+
+void setup()
+{
+  Serial.begin(115200);
+  inkplate.begin();
+
+  if (!benchmark.begin(&inkplate))
+  {
+    Serial.println("Not enough memory for the benchmark");
+    return;
+  }
+
+  if (!benchmark.run(Serial, ITERATIONS))
+    Serial.println("Benchmark failed");
+  benchmark.end();
+
+  Serial.println("Done");
+}
+
+void loop()
+{
+  // Empty loop
+}
@@ -0,0 +1,72 @@
+/**
+ **************************************************
+ *
+ * @file        LowPowerLvglService.ino
+ * @brief       Example showing the library managed LVGL task on Inkplate 6.
+ *
+ *              Instead of a 5 ms lv_tick_inc() timer and a lv_timer_handler() loop, begin() starts
+ *              a task that runs LVGL only when an LVGL timer is due or something is invalidated.
+ *              Here a counter is updated by an LVGL timer every 10 seconds, in between the
+ *              CPU is idle. Serial prints how many times the task woke up.
+ *
+ * For info on how to quickly get started with Inkplate 6 visit:
+ * https://soldered.com/documentation/inkplate/6/overview/
+ *
+ * @authors     Soldered
+ * @date        November 2025
+ **************************************************
+ */
+
+#if !defined(ARDUINO_ESP32_DEV) && !defined(ARDUINO_INKPLATE6V2)
+#error "Wrong board selection for this example, please select e-radionica Inkplate6 or Soldered Inkplate6 in the boards menu."
+#endif
+
+#include <Inkplate-LVGL.h>
+
+// Inkplate in 1-bit (black & white) mode
+Inkplate inkplate(INKPLATE_1BIT);
+
+static lv_obj_t *label = nullptr;
+static int counter = 0;
+
+// LVGL timer callback, it runs inside the service task with the LVGL lock held
+static void update_cb(lv_timer_t *timer)
+{
+  lv_label_set_text_fmt(label, "Updated %d times", ++counter);
+
+  // Render now and show it with a partial update
+  lv_refr_now(NULL);
+  inkplate.partialUpdate();
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  // Partial render mode, default memory placement, start the LVGL service
+  inkplate.begin(LV_DISP_RENDER_MODE_PARTIAL, NULL, true);
+
+  // LVGL is now used by the service task, take the lock before touching it from the sketch
+  inkplate.lvglService.lock();
+
+  label = lv_label_create(lv_screen_active());
+  lv_obj_set_style_text_font(label, &lv_font_montserrat_48, 0);
+  lv_label_set_text(label, "LVGL service started");
+  lv_obj_center(label);
+
+  // First full refresh
+  lv_refr_now(NULL);
+  inkplate.display();
+
+  // Every 10 seconds update the counter
+  lv_timer_create(update_cb, 10000, NULL);
+
+  inkplate.lvglService.unlock();
+}
+
+void loop()
+{
+  // Nothing to do here, LVGL task sleeps until the next timer
+  Serial.printf("LVGL service woke up %lu times\n", (unsigned long)inkplate.lvglService.getWakeCount());
+  delay(10000);
+}
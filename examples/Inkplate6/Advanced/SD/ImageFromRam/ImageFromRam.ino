@@ -0,0 +1,89 @@
+/**
+ **************************************************
+ *
+ * @file        ImageFromRam.ino
+ * @brief       Example showing how to keep images that are shown on every refresh in RAM with the 'M:' drive.
+ *              The image is read from the SD card only once, every next refresh takes it from PSRAM.
+ *              Copy cat.jpg from the ImageFromSD example to the root of the SD card.
+ *
+ *              Files opened as "M:<path>" are loaded from the same path on the SD card the first time. The
+ *              drive keeps as many files as fit into its budget (lv_fs_mem_set_budget()) and drops the least
+ *              recently used ones when it's full.
+ *
+ * For info on how to quickly get started with Inkplate 6 visit
+ * https://soldered.com/documentation/inkplate/6/overview/
+ *
+ * @authors     Soldered
+ * @date        November 2025
+ ***************************************************/
+
+// Next 3 lines are a precaution, you can ignore those, and the example would also work without them
+#ifndef ARDUINO_INKPLATE6V2
+#error "Wrong board selection for this example, please select Soldered Inkplate 6"
+#endif
+
+// Include the Inkplate LVGL Library
+#include <Inkplate-LVGL.h>
+
+// Create an instance of Inkplate object
+Inkplate inkplate(INKPLATE_1BIT);
+
+lv_obj_t *img;
+lv_obj_t *label;
+int refreshes = 0;
+
+void setup()
+{
+  Serial.begin(115200);
+
+  // Initialize Inkplate + LVGL in full render mode
+  inkplate.begin(LV_DISP_RENDER_MODE_FULL);
+  inkplate.enableDithering(1);
+
+  if (!inkplate.sdCardInit())
+  {
+    Serial.println("SD Card init failed!");
+    return;
+  }
+
+  // Up to 2 MB of files in PSRAM
+  lv_fs_mem_set_budget(2 * 1024 * 1024);
+
+  // Load the image now, so the first refresh doesn't wait for the SD card
+  if (!lv_fs_mem_load("/cat.jpg"))
+  {
+    Serial.println("cat.jpg can't be loaded!");
+    return;
+  }
+
+  // SD card is not needed anymore
+  inkplate.sdCardSleep();
+
+  lv_obj_t *screen = lv_screen_active();
+  lv_obj_set_style_bg_color(screen, lv_color_white(), 0);
+
+  img = lv_image_create(screen);
+  lv_obj_center(img);
+
+  label = lv_label_create(screen);
+  lv_obj_align(label, LV_ALIGN_TOP_MID, 0, 10);
+}
+
+void loop()
+{
+  if (img == NULL)
+    return;
+
+  // Same source every time, the file is read from RAM
+  lv_image_set_src(img, "M:/cat.jpg");
+  lv_label_set_text_fmt(label, "Refresh %d, image from RAM", ++refreshes);
+  lv_refr_now(NULL);
+  inkplate.display();
+
+  struct memFsStats stats;
+  lv_fs_mem_get_stats(&stats);
+  Serial.printf("hits: %lu, loaded from SD: %lu, in RAM: %lu files, %lu bytes\n", (unsigned long)stats.hits,
+                (unsigned long)stats.loads, (unsigned long)stats.files, (unsigned long)stats.bytesUsed);
+
+  delay(10000);
+}
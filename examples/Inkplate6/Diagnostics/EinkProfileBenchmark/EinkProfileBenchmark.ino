@@ -0,0 +1,93 @@
+/**
+ **************************************************
+ *
+ * @file        EinkProfileBenchmark.ino
+ * @brief       Measures the size of the sketch and how long LVGL takes to render a screen of themed
+ *              widgets. Run it once as it is and once with "#define INKPLATE_EINK_PROFILE 1" in lv_conf.h
+ *              (only e-ink blend paths and the flat e-ink theme) and compare the results printed to the
+ *              Serial Monitor (115200 baud).
+ *
+ * For info on how to quickly get started with Inkplate 6 visit
+ * https://soldered.com/documentation/inkplate/6/overview/
+ *
+ * @authors     Soldered
+ * @date        November 2025
+ ***************************************************/
+
+// Next 3 lines are a precaution, you can ignore those, and the example would also work without them
+#ifndef ARDUINO_INKPLATE6V2
+#error "Wrong board selection for this example, please select Soldered Inkplate 6"
+#endif
+
+// Include the Inkplate LVGL Library
+#include <Inkplate-LVGL.h>
+
+// How many times the screen is rendered
+#define ITERATIONS 10
+
+// Create an instance of Inkplate object in grayscale mode
+Inkplate inkplate(INKPLATE_3BIT);
+
+// Fill the screen with widgets styled by the theme (buttons have shadows, sliders and switches
+// have indicators and knobs), so the theme is what is measured.
+void drawTestScreen()
+{
+  lv_obj_t *screen = lv_screen_active();
+  lv_obj_clean(screen);
+  lv_obj_set_flex_flow(screen, LV_FLEX_FLOW_ROW_WRAP);
+  lv_obj_set_style_pad_all(screen, 20, LV_PART_MAIN);
+
+  for (int i = 0; i < 8; i++)
+  {
+    lv_obj_t *btn = lv_button_create(screen);
+    lv_obj_set_size(btn, 250, 80);
+    lv_obj_t *label = lv_label_create(btn);
+    lv_label_set_text_fmt(label, "Button %d", i);
+    lv_obj_center(label);
+
+    lv_obj_t *slider = lv_slider_create(screen);
+    lv_obj_set_width(slider, 250);
+    lv_slider_set_value(slider, i * 12, LV_ANIM_OFF);
+
+    lv_obj_t *sw = lv_switch_create(screen);
+    if (i % 2)
+      lv_obj_add_state(sw, LV_STATE_CHECKED);
+  }
+
+  // Let LVGL do the layout before measuring
+  lv_obj_update_layout(screen);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  inkplate.begin();
+
+  // One line with the sketch size in flash: "sketch,<profile>,<bytes>"
+  Serial.printf("sketch,%d,%lu\n", INKPLATE_EINK_PROFILE, (unsigned long)ESP.getSketchSize());
+
+  drawTestScreen();
+
+  // One line per render: "render,<profile>,<iteration>,<time us>", then the average
+  uint64_t total = 0;
+  for (int i = 0; i < ITERATIONS; i++)
+  {
+    lv_obj_invalidate(lv_screen_active());
+
+    uint32_t start = micros();
+    lv_refr_now(NULL);
+    uint32_t renderTime = micros() - start;
+
+    total += renderTime;
+    Serial.printf("render,%d,%d,%lu\n", INKPLATE_EINK_PROFILE, i, (unsigned long)renderTime);
+  }
+  Serial.printf("average,%d,%lu\n", INKPLATE_EINK_PROFILE, (unsigned long)(total / ITERATIONS));
+
+  // Show what was rendered
+  inkplate.display();
+}
+
+void loop()
+{
+  // Empty loop
+}
@@ -0,0 +1,93 @@
+/**
+ **************************************************
+ *
+ * @file        ParallelDrawBenchmark.ino
+ * @brief       Measures how long LVGL takes to render the whole screen. Run it once as it is (one draw
+ *              unit) and once with "#define INKPLATE_PARALLEL_DRAW 1" in lv_conf.h (two draw units, one
+ *              on each core) and compare the results printed to the Serial Monitor (115200 baud).
+ *
+ * For info on how to quickly get started with Inkplate 6 visit
+ * https://soldered.com/documentation/inkplate/6/overview/
+ *
+ * @authors     Soldered
+ * @date        November 2025
+ ***************************************************/
+
+// Next 3 lines are a precaution, you can ignore those, and the example would also work without them
+#ifndef ARDUINO_INKPLATE6V2
+#error "Wrong board selection for this example, please select Soldered Inkplate 6"
+#endif
+
+// Include the Inkplate LVGL Library
+#include <Inkplate-LVGL.h>
+
+// How many times the screen is rendered
+#define ITERATIONS 10
+
+// Create an instance of Inkplate object in grayscale mode
+Inkplate inkplate(INKPLATE_3BIT);
+
+// Fill the screen with a grid of widgets. Every cell is a separate draw task, so draw units can render
+// different cells at the same time.
+void drawTestScreen()
+{
+  lv_obj_t *screen = lv_screen_active();
+  lv_obj_clean(screen);
+  lv_obj_set_flex_flow(screen, LV_FLEX_FLOW_ROW_WRAP);
+  lv_obj_set_style_pad_all(screen, 10, LV_PART_MAIN);
+
+  for (int i = 0; i < 24; i++)
+  {
+    lv_obj_t *cell = lv_obj_create(screen);
+    lv_obj_remove_flag(cell, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_size(cell, 180, 170);
+    lv_obj_set_style_radius(cell, 20, LV_PART_MAIN);
+    lv_obj_set_style_shadow_width(cell, 15, LV_PART_MAIN);
+    lv_obj_set_style_bg_grad_color(cell, lv_color_make(i * 10, i * 10, i * 10), LV_PART_MAIN);
+    lv_obj_set_style_bg_grad_dir(cell, LV_GRAD_DIR_VER, LV_PART_MAIN);
+
+    lv_obj_t *arc = lv_arc_create(cell);
+    lv_obj_set_size(arc, 90, 90);
+    lv_arc_set_value(arc, i * 4);
+    lv_obj_align(arc, LV_ALIGN_TOP_MID, 0, 0);
+
+    lv_obj_t *label = lv_label_create(cell);
+    lv_label_set_text_fmt(label, "Cell %d", i);
+    lv_obj_set_style_text_font(label, &lv_font_montserrat_24, 0);
+    lv_obj_align(label, LV_ALIGN_BOTTOM_MID, 0, 0);
+  }
+
+  // Let LVGL do the layout before measuring
+  lv_obj_update_layout(screen);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  inkplate.begin();
+
+  drawTestScreen();
+
+  // One line per render: "render,<draw units>,<iteration>,<time us>", then the average
+  uint64_t total = 0;
+  for (int i = 0; i < ITERATIONS; i++)
+  {
+    lv_obj_invalidate(lv_screen_active());
+
+    uint32_t start = micros();
+    lv_refr_now(NULL);
+    uint32_t renderTime = micros() - start;
+
+    total += renderTime;
+    Serial.printf("render,%d,%d,%lu\n", LV_DRAW_SW_DRAW_UNIT_CNT, i, (unsigned long)renderTime);
+  }
+  Serial.printf("average,%d,%lu\n", LV_DRAW_SW_DRAW_UNIT_CNT, (unsigned long)(total / ITERATIONS));
+
+  // Show what was rendered
+  inkplate.display();
+}
+
+void loop()
+{
+  // Empty loop
+}
@@ -0,0 +1,83 @@
+/**
+ **************************************************
+ *
+ * @file        ProfilerTrace.ino
+ * @brief       Records where the time goes during rendering and refreshing (LVGL stages, flush,
+ *              dithering, partial update diff, waveform phases, panel power up) and saves it as
+ *              Chrome trace JSON to the SD card (trace.json) or prints it to the Serial Monitor.
+ *              Open the file in chrome://tracing or https://ui.perfetto.dev
+ *
+ *              Set "#define INKPLATE_PROFILER 1" in lv_conf.h before uploading, otherwise the
+ *              trace is empty.
+ *
+ * For info on how to quickly get started with Inkplate 6 visit
+ * https://soldered.com/documentation/inkplate/6/overview/
+ *
+ * @authors     Soldered
+ * @date        November 2025
+ ***************************************************/
+
+// Next 3 lines are a precaution, you can ignore those, and the example would also work without them
+#ifndef ARDUINO_INKPLATE6V2
+#error "Wrong board selection for this example, please select Soldered Inkplate 6"
+#endif
+
+// Include the Inkplate LVGL Library
+#include <Inkplate-LVGL.h>
+
+// Create an instance of Inkplate object in black and white mode
+Inkplate inkplate(INKPLATE_1BIT);
+
+void setup()
+{
+  Serial.begin(115200);
+  inkplate.begin();
+
+#if !INKPLATE_PROFILER
+  Serial.println("Profiler is disabled, set INKPLATE_PROFILER to 1 in lv_conf.h");
+#endif
+
+  // Start recording
+  if (!profilerStart())
+  {
+    Serial.println("Not enough memory for the profiler");
+    return;
+  }
+
+  lv_obj_t *label = lv_label_create(lv_screen_active());
+  lv_obj_set_style_text_font(label, &lv_font_montserrat_48, 0);
+  lv_label_set_text(label, "Profiler trace");
+  lv_obj_center(label);
+
+  // Full refresh
+  lv_refr_now(NULL);
+  inkplate.display();
+
+  // Partial update of a small change
+  lv_label_set_text(label, "Profiler trace done");
+  lv_refr_now(NULL);
+  inkplate.partialUpdate();
+
+  // Stop recording before the dump
+  profilerStop();
+  Serial.printf("Recorded %lu events, %lu dropped\n", (unsigned long)profilerGetEventCount(),
+                (unsigned long)profilerGetDropped());
+
+  // Save the trace to the SD card, or print it if there is no card
+  SdFile file;
+  if (inkplate.sdCardInit() && file.open("trace.json", O_WRITE | O_CREAT | O_TRUNC))
+  {
+    profilerDump(file);
+    file.close();
+    Serial.println("Trace saved to trace.json");
+  }
+  else
+  {
+    profilerDump(Serial);
+  }
+}
+
+void loop()
+{
+  // Empty loop
+}
@@ -0,0 +1,143 @@
+/**
+ **************************************************
+ *
+ * @file        SdReadBenchmark.ino
+ * @brief       Measures how fast a 1 MB file is read from the SD card, directly with SdFile and through the
+ *              LVGL 'S:' driver, with small and large reads, from a block aligned and an unaligned offset.
+ *              Results are printed to the Serial Monitor (115200 baud) as CSV, one line per test:
+ *              sdread,<api>,<read size>,<start offset>,<bytes>,<time us>,<KB/s>
+ *
+ *              The test file (bench1mb.bin) is created in the root of the SD card if it's not there.
+ *
+ * For info on how to quickly get started with Inkplate 6 visit
+ * https://soldered.com/documentation/inkplate/6/overview/
+ *
+ * @authors     Soldered
+ * @date        November 2025
+ ***************************************************/
+
+// Next 3 lines are a precaution, you can ignore those, and the example would also work without them
+#ifndef ARDUINO_INKPLATE6V2
+#error "Wrong board selection for this example, please select Soldered Inkplate 6"
+#endif
+
+// Include the Inkplate LVGL Library
+#include <Inkplate-LVGL.h>
+
+#define FILE_NAME "bench1mb.bin"
+#define FILE_SIZE (1024UL * 1024UL)
+
+// Biggest read of the test
+#define BUFFER_SIZE 32768
+
+// Create an instance of Inkplate object
+Inkplate inkplate(INKPLATE_1BIT);
+
+uint8_t *buffer;
+
+// Write the test file if it's missing or has the wrong size
+bool createTestFile()
+{
+  SdFile file;
+  if (file.open(FILE_NAME, O_READ))
+  {
+    uint32_t size = file.fileSize();
+    file.close();
+    if (size == FILE_SIZE)
+      return true;
+  }
+
+  Serial.println("Creating " FILE_NAME "...");
+  if (!file.open(FILE_NAME, O_WRITE | O_CREAT | O_TRUNC))
+    return false;
+
+  for (uint32_t i = 0; i < BUFFER_SIZE; i++)
+    buffer[i] = i * 7;
+  for (uint32_t written = 0; written < FILE_SIZE; written += BUFFER_SIZE)
+  {
+    if (file.write(buffer, BUFFER_SIZE) != BUFFER_SIZE)
+    {
+      file.close();
+      return false;
+    }
+  }
+  file.close();
+  return true;
+}
+
+// One CSV line, KB/s = bytes / 1024 / (us / 1000000)
+void report(const char *api, uint32_t readSize, uint32_t offset, uint32_t total, uint32_t time)
+{
+  uint32_t kbps = time ? (uint64_t)total * 1000000 / 1024 / time : 0;
+  Serial.printf("sdread,%s,%lu,%lu,%lu,%lu,%lu\n", api, (unsigned long)readSize, (unsigned long)offset,
+                (unsigned long)total, (unsigned long)time, (unsigned long)kbps);
+}
+
+// Read the file with SdFile, from start to the end in reads of readSize bytes
+void benchSdFile(uint32_t readSize, uint32_t offset)
+{
+  SdFile file;
+  if (!file.open(FILE_NAME, O_READ))
+    return;
+
+  uint32_t start = micros();
+  uint32_t total = 0;
+  file.seekSet(offset);
+  int n;
+  while ((n = file.read(buffer, readSize)) > 0)
+    total += n;
+  uint32_t time = micros() - start;
+  file.close();
+
+  report("SdFile", readSize, offset, total, time);
+}
+
+// Same through the LVGL file system, as image and font decoders read it
+void benchLvgl(uint32_t readSize, uint32_t offset)
+{
+  lv_fs_file_t file;
+  if (lv_fs_open(&file, "S:/" FILE_NAME, LV_FS_MODE_RD) != LV_FS_RES_OK)
+    return;
+
+  uint32_t start = micros();
+  uint32_t total = 0;
+  uint32_t n;
+  lv_fs_seek(&file, offset, LV_FS_SEEK_SET);
+  while (lv_fs_read(&file, buffer, readSize, &n) == LV_FS_RES_OK && n > 0)
+    total += n;
+  uint32_t time = micros() - start;
+  lv_fs_close(&file);
+
+  report("lvgl", readSize, offset, total, time);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  inkplate.begin();
+
+  buffer = (uint8_t *)malloc(BUFFER_SIZE);
+  if (buffer == NULL || !inkplate.sdCardInit() || !createTestFile())
+  {
+    Serial.println("SD card or test file error!");
+    return;
+  }
+
+  const uint32_t readSizes[] = {64, 512, 4096, BUFFER_SIZE};
+  for (int i = 0; i < 4; i++)
+  {
+    // Block aligned start and a start one byte after it (every read straddles two blocks)
+    benchSdFile(readSizes[i], 0);
+    benchSdFile(readSizes[i], 1);
+    benchLvgl(readSizes[i], 0);
+    benchLvgl(readSizes[i], 1);
+  }
+
+  inkplate.sdCardSleep();
+  Serial.println("Done");
+}
+
+void loop()
+{
+  // Empty loop
+}
@@ -0,0 +1,105 @@
+/**
+ **************************************************
+ *
+ * @file        LowPowerLvglService.ino
+ * @brief       Example showing the library managed LVGL task on Inkplate 6FLICK.
+ *
+ *              Instead of a 5 ms lv_tick_inc() timer and a lv_timer_handler() loop, begin() starts
+ *              a task that runs LVGL only when an LVGL timer is due or something is invalidated.
+ *              The touchscreen is not polled either: its interrupt wakes the task up, which reads
+ *              the touch until the finger is lifted. Here a counter is updated by an LVGL timer
+ *              every 10 seconds and a button counts touches, in between the CPU is idle. Serial
+ *              prints how many times the task woke up.
+ *
+ * For info on how to quickly get started with Inkplate 6FLICK visit:
+ * https://soldered.com/documentation/inkplate/6flick/overview/
+ *
+ * @authors     Soldered
+ * @date        November 2025
+ **************************************************
+ */
+
+#ifndef ARDUINO_INKPLATE6FLICK
+#error "Wrong board selection for this example, please select Soldered Inkplate 6 FLICK"
+#endif
+
+#include <Inkplate-LVGL.h>
+
+// Inkplate in 1-bit (black & white) mode
+Inkplate inkplate(INKPLATE_1BIT);
+
+static lv_obj_t *label = nullptr;
+static lv_obj_t *buttonLabel = nullptr;
+static int counter = 0;
+static int touches = 0;
+
+// Render now and show it with a partial update, called from the service task with the LVGL lock held
+static void refresh_cb(void *data)
+{
+  lv_refr_now(NULL);
+  inkplate.partialUpdate();
+}
+
+// LVGL timer callback, it runs inside the service task with the LVGL lock held
+static void update_cb(lv_timer_t *timer)
+{
+  lv_label_set_text_fmt(label, "Updated %d times", ++counter);
+  refresh_cb(NULL);
+}
+
+// Button callback, the service task reads the touchscreen after its interrupt and calls it with the lock held
+static void button_cb(lv_event_t *e)
+{
+  lv_label_set_text_fmt(buttonLabel, "Touched %d times", ++touches);
+
+  // Refresh after the input device is read, not from inside of it
+  lv_async_call(refresh_cb, NULL);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  // Partial render mode, default memory placement, start the LVGL service (touchscreen is event driven)
+  inkplate.begin(LV_DISP_RENDER_MODE_PARTIAL, NULL, true);
+
+  // LVGL is now used by the service task, take the lock before touching it from the sketch
+  inkplate.lvglService.lock();
+
+  // Touchscreen interrupt is what wakes the service up on touch
+  if (!inkplate.touchscreen.init(true))
+  {
+    Serial.println("Touchscreen initialization failed.");
+  }
+
+  label = lv_label_create(lv_screen_active());
+  lv_obj_set_style_text_font(label, &lv_font_montserrat_48, 0);
+  lv_label_set_text(label, "LVGL service started");
+  lv_obj_align(label, LV_ALIGN_CENTER, 0, -100);
+
+  lv_obj_t *button = lv_button_create(lv_screen_active());
+  lv_obj_set_size(button, 400, 120);
+  lv_obj_align(button, LV_ALIGN_CENTER, 0, 100);
+  lv_obj_add_event_cb(button, button_cb, LV_EVENT_CLICKED, NULL);
+
+  buttonLabel = lv_label_create(button);
+  lv_obj_set_style_text_font(buttonLabel, &lv_font_montserrat_48, 0);
+  lv_label_set_text(buttonLabel, "Touch me");
+  lv_obj_center(buttonLabel);
+
+  // First full refresh
+  lv_refr_now(NULL);
+  inkplate.display();
+
+  // Every 10 seconds update the counter
+  lv_timer_create(update_cb, 10000, NULL);
+
+  inkplate.lvglService.unlock();
+}
+
+void loop()
+{
+  // Nothing to do here, LVGL task sleeps until the next timer or touch
+  Serial.printf("LVGL service woke up %lu times\n", (unsigned long)inkplate.lvglService.getWakeCount());
+  delay(10000);
+}
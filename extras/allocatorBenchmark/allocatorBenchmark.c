@@ -0,0 +1,328 @@
+/**
+ **************************************************
+ * @file        allocatorBenchmark.c
+ * @brief       Host benchmark of the LVGL tiered allocator (src/lvgl/custom_alocation_algorithm.c).
+ *              Replays an allocation trace with the tiered allocator and with the libc malloc and
+ *              prints time per operation of both.
+ *
+ *              Trace is recorded on the Inkplate by setting LV_MEM_TRACE to 1 in lv_conf.h and
+ *              saving the Serial output. Lines that are not trace lines are skipped:
+ *                  a <ptr> <size>          lv_malloc_core()
+ *                  r <ptr> <newPtr> <size> lv_realloc_core()
+ *                  f <ptr>                 lv_free_core()
+ *
+ *              Without a trace file, a synthetic LVGL-like workload is generated (many small
+ *              widget/style/event blocks, some medium draw buffers and few large images).
+ *
+ *              At the end, allocations of one refresh are timed with the frame arena and without it.
+ *
+ *              Usage: ./allocatorBenchmark [trace.txt]
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../src/system/memoryStats/MemoryStats.h"
+#include "custom_allocation_algorithm.h"
+#include "src/stdlib/lv_mem.h"
+
+#define MAX_OPS  2000000
+#define MAX_LIVE (1 << 16)
+#define REPEAT   5
+
+#define OP_ALLOC   0
+#define OP_REALLOC 1
+#define OP_FREE    2
+
+// One replayed operation, slot is index of the live block (pointer from the trace is mapped to it).
+struct op
+{
+    uint8_t type;
+    uint32_t slot;
+    uint32_t size;
+};
+
+static struct op *ops;
+static int opCount = 0;
+static void *live[MAX_LIVE];
+
+// Hash map from the pointer in the trace to the slot of the live block.
+static uint64_t mapKey[MAX_LIVE * 2];
+static uint32_t mapSlot[MAX_LIVE * 2];
+static uint8_t mapUsed[MAX_LIVE * 2];
+static uint32_t freeSlots[MAX_LIVE];
+static int freeSlotCount = 0;
+
+// LVGL functions used by lv_tlsf.c and by the frame arena.
+void lv_log_add(int level, const char *file, int line, const char *func, const char *format, ...)
+{
+    (void)level;
+    (void)file;
+    (void)line;
+    (void)func;
+    (void)format;
+}
+
+void *lv_memcpy(void *dst, const void *src, size_t len)
+{
+    return memcpy(dst, src, len);
+}
+
+void *lv_malloc(size_t size)
+{
+    return lv_malloc_core(size);
+}
+
+static uint32_t mapFind(uint64_t key, int insert)
+{
+    uint32_t i = (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 47) & (MAX_LIVE * 2 - 1);
+    while (mapUsed[i] && mapKey[i] != key)
+        i = (i + 1) & (MAX_LIVE * 2 - 1);
+
+    if (mapUsed[i])
+        return i;
+    if (!insert)
+        return UINT32_MAX;
+
+    mapUsed[i] = 1;
+    mapKey[i] = key;
+    mapSlot[i] = freeSlots[--freeSlotCount];
+    return i;
+}
+
+static void mapRemove(uint32_t i)
+{
+    freeSlots[freeSlotCount++] = mapSlot[i];
+    mapUsed[i] = 0;
+
+    // Reinsert the rest of the cluster so linear probing still finds them.
+    for (uint32_t j = (i + 1) & (MAX_LIVE * 2 - 1); mapUsed[j]; j = (j + 1) & (MAX_LIVE * 2 - 1))
+    {
+        uint64_t key = mapKey[j];
+        uint32_t slot = mapSlot[j];
+        mapUsed[j] = 0;
+        uint32_t k = (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 47) & (MAX_LIVE * 2 - 1);
+        while (mapUsed[k])
+            k = (k + 1) & (MAX_LIVE * 2 - 1);
+        mapUsed[k] = 1;
+        mapKey[k] = key;
+        mapSlot[k] = slot;
+    }
+}
+
+static void addOp(uint8_t type, uint32_t slot, uint32_t size)
+{
+    if (opCount >= MAX_OPS)
+        return;
+    ops[opCount].type = type;
+    ops[opCount].slot = slot;
+    ops[opCount].size = size;
+    opCount++;
+}
+
+static void resetSlots()
+{
+    memset(mapUsed, 0, sizeof(mapUsed));
+    freeSlotCount = 0;
+    for (int i = MAX_LIVE - 1; i >= 0; i--)
+        freeSlots[freeSlotCount++] = i;
+}
+
+static int loadTrace(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[256];
+    unsigned long long p, newP;
+    unsigned size;
+
+    if (f == NULL)
+        return 0;
+
+    resetSlots();
+    while (fgets(line, sizeof(line), f))
+    {
+        if (sscanf(line, "a %llx %u", &p, &size) == 2)
+        {
+            if (p == 0 || freeSlotCount == 0)
+                continue;
+            addOp(OP_ALLOC, mapSlot[mapFind(p, 1)], size);
+        }
+        else if (sscanf(line, "r %llx %llx %u", &p, &newP, &size) == 3)
+        {
+            uint32_t i = mapFind(p, 0);
+            if (i == UINT32_MAX || newP == 0)
+                continue;
+            uint32_t slot = mapSlot[i];
+            addOp(OP_REALLOC, slot, size);
+
+            // Slot is released and taken again (free slots are LIFO), so block keeps it under the new pointer.
+            mapRemove(i);
+            mapFind(newP, 1);
+        }
+        else if (sscanf(line, "f %llx", &p) == 1)
+        {
+            uint32_t i = mapFind(p, 0);
+            if (i == UINT32_MAX)
+                continue;
+            addOp(OP_FREE, mapSlot[i], 0);
+            mapRemove(i);
+        }
+    }
+    fclose(f);
+
+    return 1;
+}
+
+static uint32_t randomSize()
+{
+    int r = rand() % 1000;
+    if (r < 700)
+        return 8 + rand() % 120; // Objects, styles, events, list nodes.
+    if (r < 900)
+        return 128 + rand() % 900; // Draw tasks, labels, layers.
+    if (r < 995)
+        return 1024 + rand() % 16384; // Draw buffers, decoded glyphs.
+    return 64 * 1024 + rand() % (512 * 1024); // Images.
+}
+
+static void generateWorkload()
+{
+    int used[MAX_LIVE];
+    int usedCount = 0;
+
+    srand(1234);
+    resetSlots();
+    for (int i = 0; i < 1000000; i++)
+    {
+        int r = rand() % 100;
+        if ((r < 50 || usedCount == 0) && freeSlotCount > 0 && usedCount < 4096)
+        {
+            uint32_t slot = freeSlots[--freeSlotCount];
+            used[usedCount++] = slot;
+            addOp(OP_ALLOC, slot, randomSize());
+        }
+        else if (r < 60)
+        {
+            addOp(OP_REALLOC, used[rand() % usedCount], randomSize());
+        }
+        else
+        {
+            int j = rand() % usedCount;
+            addOp(OP_FREE, used[j], 0);
+            freeSlots[freeSlotCount++] = used[j];
+            used[j] = used[--usedCount];
+        }
+    }
+
+    for (int j = 0; j < usedCount; j++)
+        addOp(OP_FREE, used[j], 0);
+}
+
+static double now()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static double run(void *(*_malloc)(size_t), void *(*_realloc)(void *, size_t), void (*_free)(void *))
+{
+    double best = 0;
+
+    for (int r = 0; r < REPEAT; r++)
+    {
+        memset(live, 0, sizeof(live));
+        double start = now();
+        for (int i = 0; i < opCount; i++)
+        {
+            struct op *o = &ops[i];
+            switch (o->type)
+            {
+            case OP_ALLOC:
+                live[o->slot] = _malloc(o->size);
+                break;
+            case OP_REALLOC:
+                live[o->slot] = _realloc(live[o->slot], o->size);
+                break;
+            case OP_FREE:
+                _free(live[o->slot]);
+                live[o->slot] = NULL;
+                break;
+            }
+        }
+        double t = now() - start;
+
+        // Free blocks that were still alive at the end of the trace.
+        for (int i = 0; i < MAX_LIVE; i++)
+            _free(live[i]);
+
+        if (r == 0 || t < best)
+            best = t;
+    }
+
+    return best / opCount;
+}
+
+/**
+ * @brief       Simulates allocations of one refresh (draw tasks, a layer buffer and mask buffers) with the
+ *              frame arena and with the regular allocator.
+ */
+static double runFrames(void *(*_malloc)(size_t), int useReset)
+{
+    void *blocks[256];
+    double start = now();
+
+    for (int frame = 0; frame < 10000; frame++)
+    {
+        for (int i = 0; i < 256; i++)
+            blocks[i] = _malloc(i % 64 == 0 ? 24 * 1024 : 64 + (i * 37) % 200);
+        for (int i = 0; i < 256; i++)
+            lv_free_core(blocks[i]);
+        if (useReset)
+            lv_frame_reset();
+    }
+
+    return (now() - start) / (10000 * 256);
+}
+
+int main(int argc, char *argv[])
+{
+    ops = malloc(sizeof(struct op) * MAX_OPS);
+
+    if (argc > 1)
+    {
+        if (!loadTrace(argv[1]))
+        {
+            fprintf(stderr, "Can't open %s\n", argv[1]);
+            return 1;
+        }
+    }
+    else
+    {
+        generateWorkload();
+    }
+
+    struct memoryStats stats;
+    lv_mem_init();
+    double tiered = run(lv_malloc_core, lv_realloc_core, lv_free_core);
+    memoryStatsGet(&stats);
+    double frame = runFrames(lv_frame_malloc, 1);
+    double frameRegular = runFrames(lv_malloc_core, 0);
+    lv_mem_deinit();
+    double libc = run(malloc, realloc, free);
+
+    printf("ops,%d\n", opCount);
+    printf("tiered,%.1f ns/op\n", tiered);
+    printf("libc,%.1f ns/op\n", libc);
+    printf("peak,%u bytes\n", (unsigned)stats.peakBytes[MEMORY_TAG_LVGL]);
+    printf("frameArena,%.1f ns/op\n", frame);
+    printf("frameRegular,%.1f ns/op\n", frameRegular);
+
+    free(ops);
+    return 0;
+}
@@ -0,0 +1,49 @@
+// Host replacement for the ESP-IDF heap_caps API, every capability maps to the libc heap.
+#pragma once
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+static inline void *heap_caps_malloc(size_t size, unsigned caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+static inline void *heap_caps_realloc(void *p, size_t size, unsigned caps)
+{
+    (void)caps;
+    return realloc(p, size);
+}
+
+static inline void *heap_caps_aligned_alloc(size_t alignment, size_t size, unsigned caps)
+{
+    (void)caps;
+    return aligned_alloc(alignment, size);
+}
+
+static inline void heap_caps_free(void *p)
+{
+    free(p);
+}
+
+// Heap info is not available on the host.
+static inline size_t heap_caps_get_free_size(unsigned caps)
+{
+    (void)caps;
+    return 0;
+}
+
+static inline size_t heap_caps_get_largest_free_block(unsigned caps)
+{
+    (void)caps;
+    return 0;
+}
+
+static inline size_t heap_caps_get_minimum_free_size(unsigned caps)
+{
+    (void)caps;
+    return 0;
+}
@@ -0,0 +1,86 @@
+/**
+ **************************************************
+ * @file        profilerTrace.c
+ * @brief       Host build of the profiler (src/system/profiler). Runs a fake refresh pipeline on two
+ *              threads and writes the trace in the same Chrome trace JSON format as the Inkplate does,
+ *              so trace tools can be tested without the board.
+ *
+ *              Usage: ./profilerTrace > trace.json, then open it in chrome://tracing or ui.perfetto.dev
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "../../src/system/profiler/Profiler.h"
+
+#define FRAMES 5
+
+static void busy(long us)
+{
+    struct timespec t = {0, us * 1000};
+    nanosleep(&t, NULL);
+}
+
+// Second "core", renders half of the screen like a parallel draw unit.
+static void *drawUnit(void *_arg)
+{
+    (void)_arg;
+    for (int f = 0; f < FRAMES; f++)
+    {
+        PROFILER_BEGIN("drawUnit");
+        busy(3000);
+        PROFILER_END("drawUnit");
+        busy(20000);
+    }
+    return NULL;
+}
+
+static void writeFile(const char *_data, size_t _len, void *_user)
+{
+    fwrite(_data, 1, _len, (FILE *)_user);
+}
+
+int main()
+{
+    pthread_t thread;
+
+    if (!profilerStart())
+        return 1;
+
+    pthread_create(&thread, NULL, drawUnit, NULL);
+
+    for (int f = 0; f < FRAMES; f++)
+    {
+        PROFILER_BEGIN("lv_timer_handler");
+        PROFILER_BEGIN("flush");
+        busy(2000);
+        PROFILER_BEGIN("ditherFramebuffer");
+        busy(4000);
+        PROFILER_END("ditherFramebuffer");
+        PROFILER_END("flush");
+        PROFILER_END("lv_timer_handler");
+
+        PROFILER_BEGIN("einkOn");
+        busy(1000);
+        PROFILER_END("einkOn");
+
+        for (int p = 0; p < 3; p++)
+        {
+            PROFILER_BEGIN_ARG("waveformPhase", p);
+            busy(3000);
+            PROFILER_END_ARG("waveformPhase", p);
+        }
+        PROFILER_INSTANT("refreshDone");
+    }
+
+    pthread_join(thread, NULL);
+    profilerStop();
+
+    profilerDumpJson(writeFile, stdout);
+    fprintf(stderr, "events %u, dropped %u\n", profilerGetEventCount(), profilerGetDropped());
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+/**
+ **************************************************
+ *
+ * @file        GoldenScenes.ino
+ * @brief       Golden image test of the flush and dither paths. Renders a fixed set of LVGL scenes into the
+ *              native framebuffer of the board (1 bit and 3 bit gray, 6COLOR nibbles, Inkplate 2 planes) and
+ *              compares each one bit for bit with the golden files in golden/<BOARD>.
+ *
+ *              Runs only in the host simulator: "make golden BOARD=..." in extras/simulator. After an intended
+ *              change of the output, "make golden-update BOARD=..." rewrites the goldens.
+ *
+ * @authors     Soldered
+ * @date        November 2025
+ ***************************************************/
+
+#ifndef INKPLATE_SIMULATOR
+#error "This sketch runs only in the host simulator (extras/simulator)"
+#endif
+
+// Include the Inkplate LVGL Library
+#include <Inkplate-LVGL.h>
+
+#ifdef USE_COLOR_IMAGE
+Inkplate inkplate;
+#else
+Inkplate inkplate(INKPLATE_1BIT);
+#endif
+
+// Start every scene on a new white screen (layout of the previous scene is not kept)
+lv_obj_t *newScene()
+{
+  lv_obj_t *old = lv_screen_active();
+  lv_obj_t *screen = lv_obj_create(NULL);
+  lv_screen_load(screen);
+  lv_obj_delete(old);
+  lv_obj_set_style_bg_color(screen, lv_color_white(), LV_PART_MAIN);
+  lv_obj_set_style_pad_all(screen, 4, LV_PART_MAIN);
+  return screen;
+}
+
+// Paragraphs in several fonts and text colors (anti-aliased edges go through every gray level)
+void textScene()
+{
+  lv_obj_t *screen = newScene();
+  lv_obj_set_flex_flow(screen, LV_FLEX_FLOW_COLUMN);
+
+  const lv_font_t *fonts[] = {&lv_font_montserrat_10, &lv_font_montserrat_14, &lv_font_montserrat_24,
+                              &lv_font_montserrat_48};
+  const uint32_t colors[] = {0x000000, 0x404040, 0xC00000, 0x0000C0};
+  for (int i = 0; i < 4; i++)
+  {
+    lv_obj_t *label = lv_label_create(screen);
+    lv_obj_set_width(label, lv_pct(100));
+    lv_label_set_text(label, "The quick brown fox jumps over the lazy dog 0123456789");
+    lv_obj_set_style_text_font(label, fonts[i], 0);
+    lv_obj_set_style_text_color(label, lv_color_hex(colors[i]), 0);
+  }
+}
+
+// Themed widgets: borders, shadows, rounded corners and indicators
+void widgetScene()
+{
+  lv_obj_t *screen = newScene();
+  lv_obj_set_flex_flow(screen, LV_FLEX_FLOW_ROW_WRAP);
+
+  for (int i = 0; i < 3; i++)
+  {
+    lv_obj_t *btn = lv_button_create(screen);
+    lv_obj_t *label = lv_label_create(btn);
+    lv_label_set_text_fmt(label, "Button %d", i);
+
+    lv_obj_t *slider = lv_slider_create(screen);
+    lv_obj_set_width(slider, lv_pct(40));
+    lv_slider_set_value(slider, 30 * i + 10, LV_ANIM_OFF);
+
+    lv_obj_t *sw = lv_switch_create(screen);
+    if (i % 2)
+      lv_obj_add_state(sw, LV_STATE_CHECKED);
+
+    lv_obj_t *cb = lv_checkbox_create(screen);
+    lv_checkbox_set_text(cb, "Option");
+    if (i != 1)
+      lv_obj_add_state(cb, LV_STATE_CHECKED);
+  }
+
+  lv_obj_t *arc = lv_arc_create(screen);
+  lv_obj_set_size(arc, 80, 80);
+  lv_arc_set_value(arc, 65);
+}
+
+// Flat shades and gradients, every gray level (or palette color) and the colors between them
+void shadeScene()
+{
+  lv_obj_t *screen = newScene();
+  int32_t w = lv_display_get_horizontal_resolution(NULL) - 8;
+  int32_t h = lv_display_get_vertical_resolution(NULL) - 8;
+
+  const uint32_t colors[] = {0x000000, 0x242424, 0x494949, 0x6D6D6D, 0x929292, 0xB6B6B6, 0xDBDBDB, 0xFFFFFF,
+                             0x00FF00, 0x0000FF, 0xFF0000, 0xFFFF00, 0xFF8000, 0x8040C0};
+  for (int i = 0; i < 14; i++)
+  {
+    lv_obj_t *bar = lv_obj_create(screen);
+    lv_obj_remove_style_all(bar);
+    lv_obj_set_pos(bar, i * w / 14, 0);
+    lv_obj_set_size(bar, w / 14 + 1, h / 3);
+    lv_obj_set_style_bg_opa(bar, LV_OPA_COVER, 0);
+    lv_obj_set_style_bg_color(bar, lv_color_hex(colors[i]), 0);
+  }
+
+  lv_obj_t *gray = lv_obj_create(screen);
+  lv_obj_remove_style_all(gray);
+  lv_obj_set_pos(gray, 0, h / 3);
+  lv_obj_set_size(gray, w, h / 3);
+  lv_obj_set_style_bg_opa(gray, LV_OPA_COVER, 0);
+  lv_obj_set_style_bg_color(gray, lv_color_black(), 0);
+  lv_obj_set_style_bg_grad_color(gray, lv_color_white(), 0);
+  lv_obj_set_style_bg_grad_dir(gray, LV_GRAD_DIR_HOR, 0);
+
+  lv_obj_t *color = lv_obj_create(screen);
+  lv_obj_remove_style_all(color);
+  lv_obj_set_pos(color, 0, 2 * h / 3);
+  lv_obj_set_size(color, w, h - 2 * h / 3);
+  lv_obj_set_style_bg_opa(color, LV_OPA_COVER, 0);
+  lv_obj_set_style_bg_color(color, lv_color_hex(0x2060FF), 0);
+  lv_obj_set_style_bg_grad_color(color, lv_color_hex(0xFFA020), 0);
+  lv_obj_set_style_bg_grad_dir(color, LV_GRAD_DIR_VER, 0);
+}
+
+// Render the scene into the framebuffer and compare it with its golden
+void checkScene(void (*scene)(), const char *name, bool dither)
+{
+  scene();
+  inkplate.enableDithering(dither);
+  lv_obj_invalidate(lv_screen_active());
+  lv_refr_now(NULL);
+  inkplate.simCheckGolden(name);
+}
+
+void checkAllScenes()
+{
+  checkScene(textScene, "text", false);
+  checkScene(widgetScene, "widgets", false);
+  checkScene(shadeScene, "shades", false);
+  checkScene(shadeScene, "shades-dither", true);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  inkplate.begin();
+
+  checkAllScenes();
+#ifndef USE_COLOR_IMAGE
+  inkplate.selectDisplayMode(INKPLATE_3BIT);
+  checkAllScenes();
+#endif
+}
+
+void loop()
+{
+}
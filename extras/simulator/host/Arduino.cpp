@@ -0,0 +1,58 @@
+// Host replacement for the Arduino core: Serial and the simulated clock.
+#include "Arduino.h"
+#include "Wire.h"
+#include "esp_timer.h"
+
+HardwareSerial Serial;
+TwoWire Wire;
+
+static uint64_t simMicros = 0;
+
+uint64_t simGetMicros()
+{
+    return simMicros;
+}
+
+void simAdvanceMicros(uint64_t _us)
+{
+    simMicros += _us;
+}
+
+uint32_t millis()
+{
+    return (uint32_t)(simMicros / 1000);
+}
+
+uint32_t micros()
+{
+    return (uint32_t)simMicros;
+}
+
+void delay(uint32_t _ms)
+{
+    simMicros += (uint64_t)_ms * 1000;
+}
+
+void delayMicroseconds(uint32_t _us)
+{
+    simMicros += _us;
+}
+
+// Fixed seed, every run of the simulator is the same.
+static uint32_t randomState = 1;
+
+long random(long _max)
+{
+    randomState = randomState * 1103515245 + 12345;
+    return _max > 0 ? (long)((randomState >> 1) % (uint32_t)_max) : 0;
+}
+
+long random(long _min, long _max)
+{
+    return _max > _min ? _min + random(_max - _min) : _min;
+}
+
+extern "C" int64_t esp_timer_get_time(void)
+{
+    return (int64_t)simMicros;
+}
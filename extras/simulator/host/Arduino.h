@@ -0,0 +1,109 @@
+// Host replacement for the Arduino core. Time is simulated: delay() and the mock EPD driver move the clock forward
+// instead of sleeping, so runs are fast and repeatable.
+#pragma once
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <type_traits>
+
+#include "Print.h"
+#include "esp_heap_caps.h"
+
+#define IRAM_ATTR
+#define PROGMEM
+
+#define HIGH 1
+#define LOW  0
+
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+// Binary constants used by the library (Arduino binary.h has all of them).
+#define B00000000 0b00000000
+#define B01010101 0b01010101
+#define B10101010 0b10101010
+#define B11111111 0b11111111
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t _ms);
+void delayMicroseconds(uint32_t _us);
+long random(long _max);
+long random(long _min, long _max);
+
+// Sketch entry points, called by the simulator.
+void setup();
+void loop();
+
+// Simulated clock, advanced by delay() and by the mock EPD driver.
+uint64_t simGetMicros();
+void simAdvanceMicros(uint64_t _us);
+
+static inline void pinMode(uint8_t _pin, uint8_t _mode)
+{
+    (void)_pin;
+    (void)_mode;
+}
+
+static inline void digitalWrite(uint8_t _pin, uint8_t _val)
+{
+    (void)_pin;
+    (void)_val;
+}
+
+static inline int digitalRead(uint8_t _pin)
+{
+    (void)_pin;
+    return LOW;
+}
+
+template <class T, class U> static inline typename std::common_type<T, U>::type min(T _a, U _b)
+{
+    return _a < _b ? _a : _b;
+}
+
+template <class T, class U> static inline typename std::common_type<T, U>::type max(T _a, U _b)
+{
+    return _a > _b ? _a : _b;
+}
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+/**
+ * @brief       Serial port, printed to stdout.
+ */
+class HardwareSerial : public Print
+{
+  public:
+    void begin(unsigned long _baud)
+    {
+        (void)_baud;
+    }
+    operator bool()
+    {
+        return true;
+    }
+    int available()
+    {
+        return 0;
+    }
+    int read()
+    {
+        return -1;
+    }
+    using Print::write;
+    size_t write(uint8_t _c) override
+    {
+        return fputc(_c, stdout) == EOF ? 0 : 1;
+    }
+    size_t write(const uint8_t *_buffer, size_t _size) override
+    {
+        return fwrite(_buffer, 1, _size, stdout);
+    }
+};
+
+extern HardwareSerial Serial;
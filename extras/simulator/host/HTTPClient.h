@@ -0,0 +1,14 @@
+// Host replacement, the simulator has no network. Only the types used in NetworkController.h.
+#pragma once
+#include "WiFi.h"
+
+typedef enum
+{
+    HTTPC_DISABLE_FOLLOW_REDIRECTS,
+    HTTPC_STRICT_FOLLOW_REDIRECTS,
+    HTTPC_FORCE_FOLLOW_REDIRECTS
+} followRedirects_t;
+
+class HTTPClient
+{
+};
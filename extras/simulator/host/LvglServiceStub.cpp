@@ -0,0 +1,48 @@
+// The simulator has no RTOS, the LVGL service never starts. Sketches that use it fall back to their own loop.
+#include "Inkplate-LVGL.h"
+
+bool LvglService::begin(lv_display_t *_disp, UBaseType_t _priority, BaseType_t _core)
+{
+    (void)_disp;
+    (void)_priority;
+    (void)_core;
+    Serial.println("Simulator: LVGL service is not supported");
+    return false;
+}
+
+void LvglService::end()
+{
+}
+
+bool LvglService::isRunning()
+{
+    return false;
+}
+
+bool LvglService::lock(uint32_t _timeoutMs)
+{
+    (void)_timeoutMs;
+    return true;
+}
+
+void LvglService::unlock()
+{
+}
+
+void LvglService::wake()
+{
+}
+
+void LvglService::wakeFromISR()
+{
+}
+
+void LvglService::setEventDriven(lv_indev_t *_indev)
+{
+    (void)_indev;
+}
+
+uint32_t LvglService::getWakeCount()
+{
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Host replacement for the Arduino Print class, enough for Serial, SdFile and profilerDump().
+#pragma once
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+class Print
+{
+  public:
+    virtual ~Print()
+    {
+    }
+    virtual size_t write(uint8_t _c) = 0;
+    virtual size_t write(const uint8_t *_buffer, size_t _size)
+    {
+        size_t n = 0;
+        while (_size--)
+            n += write(*_buffer++);
+        return n;
+    }
+
+    size_t write(const char *_str)
+    {
+        return write((const uint8_t *)_str, strlen(_str));
+    }
+
+    size_t printf(const char *_format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char buf[512];
+        va_list args;
+        va_start(args, _format);
+        int len = vsnprintf(buf, sizeof(buf), _format, args);
+        va_end(args);
+        if (len < 0)
+            return 0;
+        if (len >= (int)sizeof(buf))
+            len = sizeof(buf) - 1;
+        return write((const uint8_t *)buf, len);
+    }
+
+    size_t print(const char *_str)
+    {
+        return write(_str);
+    }
+    size_t print(char _c)
+    {
+        return write((uint8_t)_c);
+    }
+    size_t print(long _n)
+    {
+        return printf("%ld", _n);
+    }
+    size_t print(int _n)
+    {
+        return print((long)_n);
+    }
+    size_t print(unsigned long _n)
+    {
+        return printf("%lu", _n);
+    }
+    size_t print(unsigned int _n)
+    {
+        return print((unsigned long)_n);
+    }
+    size_t print(double _n, int _digits = 2)
+    {
+        return printf("%.*f", _digits, _n);
+    }
+
+    size_t println()
+    {
+        return write("\n");
+    }
+    template <typename T> size_t println(T _value)
+    {
+        size_t n = print(_value);
+        return n + println();
+    }
+};
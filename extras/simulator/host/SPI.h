@@ -0,0 +1,25 @@
+// Host replacement for the Arduino SPI library.
+#pragma once
+#include <stdint.h>
+
+#define VSPI 3
+#define HSPI 2
+
+class SPIClass
+{
+  public:
+    SPIClass(uint8_t _bus = HSPI)
+    {
+        (void)_bus;
+    }
+    void begin(int8_t _sck = -1, int8_t _miso = -1, int8_t _mosi = -1, int8_t _ss = -1)
+    {
+        (void)_sck;
+        (void)_miso;
+        (void)_mosi;
+        (void)_ss;
+    }
+    void end()
+    {
+    }
+};
@@ -0,0 +1,264 @@
+// Host replacement for the SdFat library, SdFile on top of stdio.
+#include "SdFat.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+const char *simSdRoot = "sd";
+
+bool SdFile::open(const char *_path, oflag_t _flags)
+{
+    char full[512];
+    close();
+
+    snprintf(full, sizeof(full), "%s/%s", simSdRoot, _path[0] == '/' ? _path + 1 : _path);
+    snprintf(_sdPath, sizeof(_sdPath), "%s", _path);
+
+    struct stat st;
+    if (stat(full, &st) == 0 && S_ISDIR(st.st_mode))
+    {
+        _dir = opendir(full);
+        return _dir != NULL;
+    }
+
+    int fd = ::open(full, _flags, 0644);
+    if (fd < 0)
+        return false;
+
+    const char *mode = "r";
+    if ((_flags & O_ACCMODE) == O_RDWR)
+        mode = (_flags & O_APPEND) ? "a+" : "r+";
+    else if ((_flags & O_ACCMODE) == O_WRONLY)
+        mode = (_flags & O_APPEND) ? "a" : "w";
+
+    _file = fdopen(fd, mode);
+    if (_file == NULL)
+    {
+        ::close(fd);
+        return false;
+    }
+    return true;
+}
+
+bool SdFile::close()
+{
+    if (_dir != NULL)
+    {
+        closedir(_dir);
+        _dir = NULL;
+        free(_entries);
+        _entries = NULL;
+        _entryCount = 0;
+        _entryPos = 0;
+        return true;
+    }
+    if (_file == NULL)
+        return false;
+    fclose(_file);
+    _file = NULL;
+    return true;
+}
+
+bool SdFile::openNext(SdFile *_dirFile, oflag_t _flags)
+{
+    struct dirent *e;
+    if (isOpen() || _dirFile->_dir == NULL)
+        return false;
+
+    while ((e = readdir(_dirFile->_dir)) != NULL)
+    {
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0)
+            continue;
+        char path[1024];
+        size_t len = strlen(_dirFile->_sdPath);
+        snprintf(path, sizeof(path), "%s%s%s", _dirFile->_sdPath, len && _dirFile->_sdPath[len - 1] == '/' ? "" : "/",
+                 e->d_name);
+        return open(path, _flags);
+    }
+    return false;
+}
+
+bool SdFile::getName(char *_name, size_t _size)
+{
+    const char *slash = strrchr(_sdPath, '/');
+    snprintf(_name, _size, "%s", slash != NULL ? slash + 1 : _sdPath);
+    return isOpen();
+}
+
+// Long name parts (13 characters each) followed by the short entry, for every file of the directory. Sizes and
+// times are filled in, same as on the card they change without the listing changing.
+bool SdFile::makeEntries()
+{
+    char full[1024];
+    snprintf(full, sizeof(full), "%s/%s", simSdRoot, _sdPath);
+    DIR *d = opendir(full);
+    if (d == NULL)
+        return false;
+
+    struct dirent *e;
+    uint32_t size = 0;
+    while ((e = readdir(d)) != NULL)
+    {
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0)
+            continue;
+
+        size_t len = strlen(e->d_name);
+        uint32_t parts = (len + 12) / 13;
+        if (_entryCount + parts + 1 > size)
+        {
+            size = (_entryCount + parts + 1) * 2;
+            _entries = (dir_t *)realloc(_entries, size * sizeof(dir_t));
+        }
+
+        for (uint32_t i = parts; i > 0; i--)
+        {
+            uint8_t *b = (uint8_t *)&_entries[_entryCount++];
+            memset(b, 0, sizeof(dir_t));
+            b[0] = (uint8_t)(i | (i == parts ? 0x40 : 0));
+            b[11] = DIR_ATT_LONG_NAME;
+            memcpy(b + 14, e->d_name + (i - 1) * 13, len - (i - 1) * 13 < 13 ? len - (i - 1) * 13 : 13);
+        }
+
+        char path[1280];
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", full, e->d_name);
+        dir_t *entry = &_entries[_entryCount++];
+        memset(entry, 0, sizeof(dir_t));
+        memset(entry->name, ' ', sizeof(entry->name));
+        memcpy(entry->name, e->d_name, len < sizeof(entry->name) ? len : sizeof(entry->name));
+        if (stat(path, &st) == 0)
+        {
+            struct tm *t = localtime(&st.st_mtime);
+            entry->attributes = S_ISDIR(st.st_mode) ? DIR_ATT_DIRECTORY : DIR_ATT_ARCHIVE;
+            entry->fileSize = S_ISDIR(st.st_mode) ? 0 : (uint32_t)st.st_size;
+            entry->lastWriteDate = ((t->tm_year - 80) << 9) | ((t->tm_mon + 1) << 5) | t->tm_mday;
+            entry->lastWriteTime = (t->tm_hour << 11) | (t->tm_min << 5) | (t->tm_sec / 2);
+        }
+    }
+    closedir(d);
+    return true;
+}
+
+bool SdFile::remove()
+{
+    char full[1024];
+    snprintf(full, sizeof(full), "%s/%s", simSdRoot, _sdPath);
+    close();
+    return ::remove(full) == 0;
+}
+
+int SdFile::read(void *_buffer, size_t _len)
+{
+    if (_dir != NULL)
+    {
+        // Whole entries only, the end of the directory reads as a free entry.
+        if (_entryPos == 0 && _entries == NULL && !makeEntries())
+            return -1;
+        if (_len < sizeof(dir_t))
+            return 0;
+        if (_entryPos < _entryCount)
+            memcpy(_buffer, &_entries[_entryPos++], sizeof(dir_t));
+        else
+            memset(_buffer, 0, sizeof(dir_t));
+        return sizeof(dir_t);
+    }
+    if (_file == NULL)
+        return -1;
+    size_t n = fread(_buffer, 1, _len, _file);
+    return ferror(_file) ? -1 : (int)n;
+}
+
+int SdFile::read()
+{
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+void SdFile::rewind()
+{
+    if (_dir != NULL)
+    {
+        rewinddir(_dir);
+        free(_entries);
+        _entries = NULL;
+        _entryCount = 0;
+        _entryPos = 0;
+    }
+    else
+    {
+        seekSet(0);
+    }
+}
+
+bool SdFile::seekSet(uint32_t _pos)
+{
+    return _file != NULL && fseek(_file, _pos, SEEK_SET) == 0;
+}
+
+bool SdFile::seekCur(int32_t _offset)
+{
+    return _file != NULL && fseek(_file, _offset, SEEK_CUR) == 0;
+}
+
+bool SdFile::seekEnd(int32_t _offset)
+{
+    return _file != NULL && fseek(_file, _offset, SEEK_END) == 0;
+}
+
+uint32_t SdFile::curPosition()
+{
+    return _file != NULL ? (uint32_t)ftell(_file) : 0;
+}
+
+uint32_t SdFile::fileSize()
+{
+    if (_file == NULL)
+        return 0;
+    long pos = ftell(_file);
+    fseek(_file, 0, SEEK_END);
+    long size = ftell(_file);
+    fseek(_file, pos, SEEK_SET);
+    return (uint32_t)size;
+}
+
+uint32_t SdFile::firstCluster()
+{
+    return fileSize() || _dir != NULL ? 2 : 0;
+}
+
+// A directory is one cluster.
+bool SdFile::clusterRun(uint32_t *_cluster, uint32_t *_count)
+{
+    uint32_t clusters = _dir != NULL ? 1 : (fileSize() + 4095) / 4096;
+    if (!isOpen() || *_cluster < 2 || *_cluster >= 2 + clusters)
+        return false;
+    *_count = 2 + clusters - *_cluster;
+    *_cluster = 0;
+    return true;
+}
+
+// Fails if the cluster is not the one of the position, like a wrong map would break the real file.
+bool SdFile::seekSetCluster(uint32_t _pos, uint32_t _cluster)
+{
+    if (_pos && _cluster != 2 + (_pos - 1) / 4096)
+        return false;
+    return seekSet(_pos);
+}
+
+FatVolume *SdFile::volume()
+{
+    static FatVolume vol;
+    return &vol;
+}
+
+size_t SdFile::write(uint8_t _c)
+{
+    return write(&_c, 1);
+}
+
+size_t SdFile::write(const uint8_t *_buffer, size_t _size)
+{
+    return _file != NULL ? fwrite(_buffer, 1, _size, _file) : 0;
+}
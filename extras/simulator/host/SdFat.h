@@ -0,0 +1,110 @@
+// Host replacement for the SdFat library. Files are opened in the directory the simulator uses as the SD card
+// (--sd), so the library's LVGL 'S:' driver runs unchanged.
+#pragma once
+#include <dirent.h>
+#include <string.h>
+#include <fcntl.h>
+#include <stdio.h>
+
+#include "Print.h"
+
+typedef int oflag_t;
+
+#ifndef O_READ
+#define O_READ  O_RDONLY
+#define O_WRITE O_WRONLY
+#endif
+
+// Directory used as the root of the SD card.
+extern const char *simSdRoot;
+
+// Raw FAT directory entry. Reading a directory returns the long name parts and the short entry of each host file.
+typedef struct
+{
+    uint8_t name[11];
+    uint8_t attributes;
+    uint8_t reservedNT;
+    uint8_t creationTimeTenths;
+    uint16_t creationTime;
+    uint16_t creationDate;
+    uint16_t lastAccessDate;
+    uint16_t firstClusterHigh;
+    uint16_t lastWriteTime;
+    uint16_t lastWriteDate;
+    uint16_t firstClusterLow;
+    uint32_t fileSize;
+} __attribute__((packed)) dir_t;
+
+const uint8_t DIR_NAME_DELETED = 0XE5;
+const uint8_t DIR_NAME_FREE = 0X00;
+const uint8_t DIR_ATT_DIRECTORY = 0X10;
+const uint8_t DIR_ATT_ARCHIVE = 0X20;
+const uint8_t DIR_ATT_LONG_NAME = 0X0F;
+const uint8_t DIR_ATT_LONG_NAME_MASK = 0X3F;
+
+static inline uint8_t DIR_IS_LONG_NAME(const dir_t *dir)
+{
+    return (dir->attributes & DIR_ATT_LONG_NAME_MASK) == DIR_ATT_LONG_NAME;
+}
+
+// Clusters of the host files are 4 KB and always contiguous, starting at cluster 2.
+class FatVolume
+{
+  public:
+    uint8_t clusterSizeShift() const
+    {
+        return 3;
+    }
+};
+
+class SdFile : public Print
+{
+  public:
+    ~SdFile()
+    {
+        close();
+    }
+    bool open(const char *_path, oflag_t _flags = O_READ);
+    bool close();
+    bool isOpen()
+    {
+        return _file != NULL || _dir != NULL;
+    }
+    bool isDir()
+    {
+        return _dir != NULL;
+    }
+    bool isRoot()
+    {
+        return _dir != NULL && _sdPath[strspn(_sdPath, "/")] == '\0';
+    }
+    bool openNext(SdFile *_dirFile, oflag_t _flags = O_READ);
+    bool getName(char *_name, size_t _size);
+    bool remove();
+    int read(void *_buffer, size_t _len);
+    int read();
+    void rewind();
+    bool seekSet(uint32_t _pos);
+    bool seekCur(int32_t _offset);
+    bool seekEnd(int32_t _offset = 0);
+    uint32_t curPosition();
+    uint32_t fileSize();
+    uint32_t firstCluster();
+    bool clusterRun(uint32_t *_cluster, uint32_t *_count);
+    bool seekSetCluster(uint32_t _pos, uint32_t _cluster);
+    FatVolume *volume();
+
+    using Print::write;
+    size_t write(uint8_t _c) override;
+    size_t write(const uint8_t *_buffer, size_t _size) override;
+
+  private:
+    FILE *_file = NULL;
+    DIR *_dir = NULL;
+    char _sdPath[512] = ""; // Path on the SD card.
+    dir_t *_entries = NULL; // Raw entries of the directory, made on the first read().
+    uint32_t _entryCount = 0;
+    uint32_t _entryPos = 0;
+
+    bool makeEntries();
+};
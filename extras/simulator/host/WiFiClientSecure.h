@@ -0,0 +1,7 @@
+// Host replacement, the simulator has no network. Only the types used in NetworkController.h.
+#pragma once
+#include "WiFi.h"
+
+class WiFiClientSecure : public WiFiClient
+{
+};
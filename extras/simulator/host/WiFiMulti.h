@@ -0,0 +1,6 @@
+// Host replacement, the simulator has no network. Only the types used in NetworkController.h.
+#pragma once
+
+class WiFiMulti
+{
+};
@@ -0,0 +1,43 @@
+// Host replacement for the Arduino Wire library, there is nothing on the bus.
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+class TwoWire
+{
+  public:
+    bool begin()
+    {
+        return true;
+    }
+    void beginTransmission(uint8_t _address)
+    {
+        (void)_address;
+    }
+    size_t write(uint8_t _data)
+    {
+        (void)_data;
+        return 1;
+    }
+    uint8_t endTransmission(bool _stop = true)
+    {
+        (void)_stop;
+        return 2; // NACK on address
+    }
+    uint8_t requestFrom(uint8_t _address, uint8_t _len)
+    {
+        (void)_address;
+        (void)_len;
+        return 0;
+    }
+    int available()
+    {
+        return 0;
+    }
+    int read()
+    {
+        return -1;
+    }
+};
+
+extern TwoWire Wire;
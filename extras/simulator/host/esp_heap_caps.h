@@ -0,0 +1,70 @@
+// Host replacement for the ESP-IDF heap_caps API, every capability maps to the libc heap.
+#pragma once
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+// Free heap reported to the library (ESP32 with 4 MB of PSRAM after boot), placement decisions depend on it.
+#ifndef SIM_FREE_INTERNAL
+#define SIM_FREE_INTERNAL 200000
+#endif
+#ifndef SIM_FREE_PSRAM
+#define SIM_FREE_PSRAM 4000000
+#endif
+
+static inline void *heap_caps_malloc(size_t size, unsigned caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+static inline void *heap_caps_calloc(size_t n, size_t size, unsigned caps)
+{
+    (void)caps;
+    return calloc(n, size);
+}
+
+static inline void *heap_caps_realloc(void *p, size_t size, unsigned caps)
+{
+    (void)caps;
+    return realloc(p, size);
+}
+
+static inline void *heap_caps_aligned_alloc(size_t alignment, size_t size, unsigned caps)
+{
+    (void)caps;
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+static inline void heap_caps_free(void *p)
+{
+    free(p);
+}
+
+static inline size_t heap_caps_get_free_size(unsigned caps)
+{
+    return (caps & MALLOC_CAP_SPIRAM) ? SIM_FREE_PSRAM : SIM_FREE_INTERNAL;
+}
+
+static inline size_t heap_caps_get_largest_free_block(unsigned caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+
+static inline size_t heap_caps_get_minimum_free_size(unsigned caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+
+static inline size_t heap_caps_get_total_size(unsigned caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+
+static inline void *ps_malloc(size_t size)
+{
+    return malloc(size);
+}
@@ -0,0 +1,14 @@
+// Host replacement for the ESP-IDF esp_timer API, returns the simulated clock.
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,12 @@
+// Host replacement for the FreeRTOS types used in the library headers.
+#pragma once
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define portMAX_DELAY   0xFFFFFFFF
+#define pdTRUE          1
+#define pdFALSE         0
+#define pdMS_TO_TICKS(x) (x)
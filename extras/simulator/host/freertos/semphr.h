@@ -0,0 +1,5 @@
+// Host replacement for the FreeRTOS semaphore types.
+#pragma once
+#include "FreeRTOS.h"
+
+typedef void *SemaphoreHandle_t;
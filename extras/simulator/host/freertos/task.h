@@ -0,0 +1,5 @@
+// Host replacement for the FreeRTOS task types.
+#pragma once
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
@@ -0,0 +1,2 @@
+// Host replacement, GPIO registers are only used by the board drivers the simulator replaces.
+#pragma once
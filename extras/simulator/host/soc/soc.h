@@ -0,0 +1,5 @@
+// Host replacement for the ESP32 memory map, host heap never falls into the PSRAM range.
+#pragma once
+
+#define SOC_EXTRAM_DATA_LOW  0x3F800000
+#define SOC_EXTRAM_DATA_HIGH 0x3FC00000
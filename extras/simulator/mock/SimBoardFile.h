@@ -0,0 +1,26 @@
+/**
+ **************************************************
+ *
+ * @file        SimBoardFile.h
+ * @brief       Board file of the host simulator, used instead of the board file of the selected board.
+ *
+ *
+ * @copyright   GNU General Public License v3.0
+ * @authors     Soldered
+ ***************************************************/
+
+// Header guard.
+#ifndef __SIM_BOARD_FILE_H__
+#define __SIM_BOARD_FILE_H__
+
+// Include the mock EPD driver.
+#include "SimDriver.h"
+
+// Wrapper for different Inkplate boards.
+class InkplateBoardClass : public EPDDriver
+{
+  public:
+    InkplateBoardClass() {};
+};
+
+#endif
@@ -0,0 +1,764 @@
+/**
+ **************************************************
+ * @file        SimDriver.cpp
+ * @brief       Mock EPD driver of the host simulator. Framebuffer handling mirrors the real board drivers, panel
+ *              hardware (PMIC, I2S, SPI controller) is replaced with an emulated panel and the simulated clock.
+ *
+ * @note        Emulated panel of the waveform boards is a linear model: every frame moves a driven pixel by
+ *              SIM_PANEL_STEP towards black or white. It shows what the waveform does (ghosting, partial updates,
+ *              gray levels), not the exact optical response of the panel.
+ *
+ * @copyright   GNU General Public License v3.0
+ * @authors     Soldered
+ ***************************************************/
+
+// Library header first, it selects the board features (USES_WAVEFORM_ENGINE) before SimDriver.h is included.
+#include "Inkplate-LVGL.h"
+
+#include <sys/stat.h>
+
+// Time needed to clock one line into the panel.
+#define SIM_LINE_US ((E_INK_WIDTH / 4 + SIM_BUS_BYTES_PER_US - 1) / SIM_BUS_BYTES_PER_US)
+
+const char *simOutputDir = NULL;
+EPDDriver *simDriver = NULL;
+
+/**
+ * @brief       initDriver allocates framebuffers of the selected display mode and the emulated panel. Waveform
+ *              boards start the real waveform engine with the board waveforms.
+ *
+ * @param       Inkplate _inkplatePtr
+ *              A pointer to the created Inkplate instance.
+ *
+ * @return      1 if initialization is successful, 0 if failed or already initialized
+ */
+int EPDDriver::initDriver(Inkplate *_inkplatePtr)
+{
+    if (_beginDone == 1)
+        return 0;
+
+    _inkplate = _inkplatePtr;
+    simDriver = this;
+
+#ifdef USES_WAVEFORM_ENGINE
+    // Engine allocates its own line buffer, lines are taken from it in sendLine().
+    const uint8_t defaultWaveform[8][9] = WAVEFORM3BIT;
+    setWaveform(defaultWaveform);
+    setWaveformTable(WAVEFORM_TABLE_1BIT, &waveformTable1Bit);
+    setWaveformTable(WAVEFORM_TABLE_3BIT, &waveformTable3Bit);
+    setWaveformTable(WAVEFORM_TABLE_PARTIAL, &waveformTablePartial);
+    if (!beginWaveformEngine(NULL, E_INK_WIDTH, E_INK_HEIGHT, SIM_WAVEFORM_FLAGS))
+        return 0;
+
+    dither.begin(_inkplatePtr);
+
+    if (!initializeFramebuffers())
+        return 0;
+
+    // Panel starts white.
+    _simPanel = (uint8_t *)malloc(E_INK_WIDTH * E_INK_HEIGHT);
+    if (_simPanel == NULL)
+        return 0;
+    memset(_simPanel, 255, E_INK_WIDTH * E_INK_HEIGHT);
+#else
+#ifdef ARDUINO_INKPLATE2
+    // B&W plane followed by the red plane.
+    const int _size = E_INK_WIDTH * E_INK_HEIGHT / 4;
+#else
+    const int _size = E_INK_WIDTH * E_INK_HEIGHT / 2;
+#endif
+    DMemory4Bit = (uint8_t *)trackedMalloc(MEMORY_TAG_FRAMEBUFFER, _size, MALLOC_CAP_SPIRAM);
+    _simPanel = (uint8_t *)malloc(_size);
+    if (DMemory4Bit == NULL || _simPanel == NULL)
+        return 0;
+
+    dither.begin(_paletteIdeal, _paletteIndex, paletteSize, _inkplatePtr);
+
+    clearDisplay();
+    memcpy(_simPanel, DMemory4Bit, _size);
+
+#ifdef ARDUINO_INKPLATE2
+    _inkplate->setRotation(1);
+#endif
+#endif
+
+    _beginDone = 1;
+    return 1;
+}
+
+/**
+ * @brief       clearDisplay clears the framebuffer of the current display mode, the panel is not changed
+ *              until display() is called.
+ */
+void EPDDriver::clearDisplay()
+{
+#if defined(ARDUINO_INKPLATE2)
+    memset(DMemory4Bit, 0xFF, E_INK_WIDTH * E_INK_HEIGHT / 4);
+#elif defined(ARDUINO_INKPLATECOLOR)
+    memset(DMemory4Bit, INKPLATE_WHITE | (INKPLATE_WHITE << 4), E_INK_WIDTH * E_INK_HEIGHT / 2);
+#else
+    if (!hasFramebuffers())
+        return;
+    if (_displayMode == 0)
+        memset(_partial, 0, E_INK_WIDTH * E_INK_HEIGHT / 8);
+    else if (_displayMode == 1)
+        memset(DMemory4Bit, 255, E_INK_WIDTH * E_INK_HEIGHT / 2);
+#endif
+}
+
+/**
+ * @brief       sdCardInit "mounts" the simulated SD card, a host directory (simSdRoot).
+ *
+ * @return      1 if the directory exists, 0 if it doesn't
+ */
+int16_t EPDDriver::sdCardInit()
+{
+    struct stat _st;
+    return (stat(simSdRoot, &_st) == 0 && S_ISDIR(_st.st_mode)) ? 1 : 0;
+}
+
+/**
+ * @brief       sdCardSleep does nothing, there is no card supply to turn off.
+ */
+void EPDDriver::sdCardSleep()
+{
+}
+
+/**
+ * @brief       readBattery returns the fixed voltage of a charged Li-Ion battery.
+ *
+ * @return      3.7 V
+ */
+double EPDDriver::readBattery()
+{
+    return 3.7;
+}
+
+#ifdef USES_WAVEFORM_ENGINE
+
+/**
+ * @brief       Sets the display mode, framebuffers of the old mode are freed and the buffers of the new mode are
+ *              allocated (same as the real driver).
+ *
+ * @param       uint8_t displayMode
+ *              INKPLATE_1BIT or INKPLATE_3BIT.
+ *
+ * @return      true if the framebuffers of the mode are allocated, false if the previous mode is kept.
+ */
+bool EPDDriver::selectDisplayMode(uint8_t displayMode)
+{
+    if (!_beginDone)
+    {
+        _displayMode = displayMode;
+        return true;
+    }
+    if (displayMode == _displayMode && hasFramebuffers())
+        return true;
+
+    uint8_t oldMode = _displayMode;
+    releaseFramebuffers(oldMode);
+    _displayMode = displayMode;
+    if (initializeFramebuffers())
+        return true;
+
+    _displayMode = oldMode;
+    initializeFramebuffers();
+    return false;
+}
+
+uint8_t EPDDriver::getDisplayMode()
+{
+    return _displayMode;
+}
+
+/**
+ * @brief       display sends the framebuffer of the current mode to the emulated panel.
+ *
+ * @param       bool _leaveOn
+ *              If set to 1, panel power supply is left on after the update.
+ */
+void EPDDriver::display(bool _leaveOn)
+{
+    if (!hasFramebuffers())
+        return;
+    if (_displayMode == 0)
+        display1b(_leaveOn);
+    else if (_displayMode == 1)
+        display3b(_leaveOn);
+}
+
+void EPDDriver::display3b(bool leaveOn)
+{
+    refreshStart();
+    if (!einkOn())
+        return;
+
+    runWaveform(WAVEFORM_TABLE_3BIT, DMemory4Bit);
+
+    if (!leaveOn)
+        einkOff();
+    refreshDone("gray", WAVEFORM_TABLE_3BIT);
+}
+
+void EPDDriver::display1b(bool leaveOn)
+{
+    memcpy(DMemoryNew, _partial, E_INK_WIDTH * E_INK_HEIGHT / 8);
+
+    refreshStart();
+    if (!einkOn())
+        return;
+
+    runWaveform(WAVEFORM_TABLE_1BIT, DMemoryNew);
+
+    if (!leaveOn)
+        einkOff();
+    refreshDone("full", WAVEFORM_TABLE_1BIT);
+
+    _blockPartial = 0;
+}
+
+/**
+ * @brief       partialUpdate updates only the changed pixels, same rules as the real driver (full update when
+ *              partial updates are blocked or the full update threshold is reached).
+ *
+ * @param       bool _forced
+ *              Force the partial update even if it's blocked.
+ *
+ * @param       bool leaveOn
+ *              If set to 1, panel power supply is left on after the update.
+ *
+ * @return      Number of pixels changed from black to white, leaving blur
+ */
+uint32_t EPDDriver::partialUpdate(bool _forced, bool leaveOn)
+{
+    if (!hasFramebuffers())
+        return 0;
+    if (getDisplayMode() == 1)
+        return 0;
+
+    if (_blockPartial == 1 && !_forced)
+    {
+        display1b(leaveOn);
+        return 0;
+    }
+
+    if (_partialUpdateCounter >= _partialUpdateLimiter && _partialUpdateLimiter != 0)
+    {
+        display1b(leaveOn);
+        _partialUpdateCounter = 0;
+        return 0;
+    }
+
+    if (_pBuffer == NULL)
+    {
+        _pBuffer = (uint8_t *)trackedMalloc(MEMORY_TAG_FRAMEBUFFER, E_INK_WIDTH * E_INK_HEIGHT / 4, MALLOC_CAP_SPIRAM);
+        if (_pBuffer == NULL)
+        {
+            display1b(leaveOn);
+            return 0;
+        }
+    }
+
+    uint32_t changeCount = calculatePartial(DMemoryNew, _partial, _pBuffer);
+
+    refreshStart();
+    if (!einkOn())
+        return 0;
+
+    runWaveform(WAVEFORM_TABLE_PARTIAL, _pBuffer);
+
+    if (!leaveOn)
+        einkOff();
+    refreshDone("partial", WAVEFORM_TABLE_PARTIAL);
+
+    memcpy(DMemoryNew, _partial, E_INK_WIDTH * E_INK_HEIGHT / 8);
+
+    if (_partialUpdateLimiter != 0)
+        _partialUpdateCounter++;
+
+    return changeCount;
+}
+
+/**
+ * @brief   Set the number of partial updates afterwhich full screen update is performed.
+ *
+ * @param   uint16_t _numberOfPartialUpdates
+ *          Number of allowed partial updates afterwhich full update is performed.
+ *          0 = disabled, no automatic full update will be performed.
+ */
+void EPDDriver::setFullUpdateThreshold(uint16_t _numberOfPartialUpdates)
+{
+    _partialUpdateLimiter = _numberOfPartialUpdates;
+
+    if (_numberOfPartialUpdates != 0)
+        _blockPartial = 1;
+}
+
+/**
+ * @brief       readTemperature returns the fixed room temperature.
+ *
+ * @return      25 °C
+ */
+int8_t EPDDriver::readTemperature()
+{
+    return 25;
+}
+
+/**
+ * @brief       einkOn turns on the emulated panel supply, takes SIM_EINK_ON_US of the simulated time.
+ *
+ * @return      Always 1
+ */
+int EPDDriver::einkOn()
+{
+    if (_panelState == 1)
+        return 1;
+
+    simAdvanceMicros(SIM_EINK_ON_US);
+    _simStats.einkOns++;
+    _panelState = 1;
+    return 1;
+}
+
+/**
+ * @brief       einkOff turns off the emulated panel supply, takes SIM_EINK_OFF_US of the simulated time.
+ */
+void EPDDriver::einkOff()
+{
+    if (_panelState == 0)
+        return;
+
+    simAdvanceMicros(SIM_EINK_OFF_US);
+    _panelState = 0;
+}
+
+/**
+ * @brief       clean drives every pixel with the same pattern, same as the real driver.
+ *
+ * @param       uint8_t c
+ *              0 - white, 1 - black, 2 - discharge, 3 - skip.
+ *
+ * @param       uint8_t rep
+ *              Number of repetitions
+ */
+void EPDDriver::clean(uint8_t c, uint8_t rep)
+{
+    refreshStart();
+    einkOn();
+    const struct waveformPhase _phase[] = {{WAVEFORM_SOURCE_CLEAN, c, rep, WAVEFORM_FRAME_DELAY}};
+    const struct waveformTable _table = WAVEFORM_TABLE(_phase, 0);
+    runWaveform(&_table, NULL);
+    refreshDone("clean", -1);
+}
+
+/**
+ * @brief       initializeFramebuffers allocates memory used by the current display mode.
+ *
+ * @return      returns 0 if allocation failed, 1 if it succeeded
+ */
+uint8_t EPDDriver::initializeFramebuffers()
+{
+    if (_displayMode == 0)
+    {
+        DMemoryNew =
+            (uint8_t *)trackedMalloc(MEMORY_TAG_FRAMEBUFFER, E_INK_WIDTH * E_INK_HEIGHT / 8, MALLOC_CAP_SPIRAM);
+        _partial = (uint8_t *)trackedMalloc(MEMORY_TAG_FRAMEBUFFER, E_INK_WIDTH * E_INK_HEIGHT / 8, MALLOC_CAP_SPIRAM);
+        if (DMemoryNew == NULL || _partial == NULL)
+        {
+            releaseFramebuffers(0);
+            return 0;
+        }
+        memset(DMemoryNew, 0, E_INK_WIDTH * E_INK_HEIGHT / 8);
+        memset(_partial, 0, E_INK_WIDTH * E_INK_HEIGHT / 8);
+        _blockPartial = 1;
+    }
+    else
+    {
+        DMemory4Bit =
+            (uint8_t *)trackedMalloc(MEMORY_TAG_FRAMEBUFFER, E_INK_WIDTH * E_INK_HEIGHT / 2, MALLOC_CAP_SPIRAM);
+        if (DMemory4Bit == NULL)
+            return 0;
+        memset(DMemory4Bit, 255, E_INK_WIDTH * E_INK_HEIGHT / 2);
+    }
+
+    return 1;
+}
+
+/**
+ * @brief       releaseFramebuffers frees memory used by the display mode.
+ *
+ * @param       uint8_t _mode
+ *              Display mode whose buffers are freed (0 - 1 bit, 1 - 3 bit).
+ */
+void EPDDriver::releaseFramebuffers(uint8_t _mode)
+{
+    if (_mode == 0)
+    {
+        trackedFree(MEMORY_TAG_FRAMEBUFFER, DMemoryNew, E_INK_WIDTH * E_INK_HEIGHT / 8);
+        trackedFree(MEMORY_TAG_FRAMEBUFFER, _partial, E_INK_WIDTH * E_INK_HEIGHT / 8);
+        trackedFree(MEMORY_TAG_FRAMEBUFFER, _pBuffer, E_INK_WIDTH * E_INK_HEIGHT / 4);
+        DMemoryNew = NULL;
+        _partial = NULL;
+        _pBuffer = NULL;
+    }
+    else
+    {
+        trackedFree(MEMORY_TAG_FRAMEBUFFER, DMemory4Bit, E_INK_WIDTH * E_INK_HEIGHT / 2);
+        DMemory4Bit = NULL;
+    }
+}
+
+/**
+ * @brief       vscan_start moves the gate drivers to the first row, takes as long as on the real boards.
+ */
+void EPDDriver::vscan_start()
+{
+    simAdvanceMicros(SIM_VSCAN_START_US);
+    _simLine = 0;
+}
+
+/**
+ * @brief       vscan_end ends the row, nothing to emulate.
+ */
+void EPDDriver::vscan_end()
+{
+}
+
+/**
+ * @brief       sendLine drives the current row of the emulated panel with the line built by the engine.
+ */
+void EPDDriver::sendLine()
+{
+    driveRow(_waveformLine, 0);
+}
+
+/**
+ * @brief       sendCleanLine drives the current row of the emulated panel with one of the clean patterns.
+ *
+ * @param       uint8_t _clean
+ *              0 - white, 1 - black, 2 - discharge, 3 - skip.
+ */
+void EPDDriver::sendCleanLine(uint8_t _clean)
+{
+    driveRow(NULL, _clean);
+}
+
+/**
+ * @brief       driveRow decodes one line of EPD data (2 bits per pixel, sent from the last pixel to the first one)
+ *              and moves every driven pixel of the row by SIM_PANEL_STEP.
+ *
+ * @param       volatile uint8_t *_line
+ *              Line of the EPD data, NULL for the clean line.
+ *
+ * @param       uint8_t _clean
+ *              Clean pattern used if there is no line.
+ */
+void EPDDriver::driveRow(volatile uint8_t *_line, uint8_t _clean)
+{
+    static const uint8_t _cleanData[4] = {0xAA, 0x55, 0x00, 0xFF};
+    const int _lineBytes = E_INK_WIDTH / 4;
+    const uint8_t _swizzle = (SIM_WAVEFORM_FLAGS & WAVEFORM_FLAG_I2S_SWIZZLE) ? 2 : 0;
+
+    if (_simLine == 0)
+        _simStats.frames++;
+    _simStats.lines++;
+    simAdvanceMicros(SIM_LINE_US);
+
+    if (_simLine >= E_INK_HEIGHT)
+        return;
+    int _row = (SIM_WAVEFORM_FLAGS & WAVEFORM_FLAG_BOTTOM_UP) ? (E_INK_HEIGHT - 1 - _simLine) : _simLine;
+    _simLine++;
+
+    uint8_t *_pixels = _simPanel + (_row * E_INK_WIDTH);
+    for (int j = 0; j < _lineBytes; j++)
+    {
+        uint8_t _data = _line ? _line[j ^ _swizzle] : _cleanData[_clean & 0x03];
+        uint8_t *_p = _pixels + (_lineBytes - 1 - j) * 4;
+        for (int k = 0; k < 4; k++)
+        {
+            uint8_t _code = (_data >> (k * 2)) & 0x03;
+            if (_code == 1)
+                _p[k] = _p[k] > SIM_PANEL_STEP ? _p[k] - SIM_PANEL_STEP : 0;
+            else if (_code == 2)
+                _p[k] = _p[k] < 255 - SIM_PANEL_STEP ? _p[k] + SIM_PANEL_STEP : 255;
+        }
+    }
+}
+
+#else
+
+/**
+ * @brief       display sends the framebuffer to the emulated panel. Controller of the panel refreshes it on its
+ *              own, takes SIM_COLOR_REFRESH_US of the simulated time.
+ *
+ * @param       bool _leaveOn
+ *              Not used, panel goes to deep sleep after each refresh.
+ */
+void EPDDriver::display(bool _leaveOn)
+{
+    refreshStart();
+#ifdef ARDUINO_INKPLATE2
+    memcpy(_simPanel, DMemory4Bit, E_INK_WIDTH * E_INK_HEIGHT / 4);
+#else
+    memcpy(_simPanel, DMemory4Bit, E_INK_WIDTH * E_INK_HEIGHT / 2);
+#endif
+    _simStats.einkOns++;
+    simAdvanceMicros(SIM_COLOR_REFRESH_US);
+    refreshDone("color", -1);
+}
+
+/**
+ * @brief       clean sends an all white image to the emulated panel, framebuffer is not changed.
+ */
+void EPDDriver::clean()
+{
+    refreshStart();
+#ifdef ARDUINO_INKPLATE2
+    memset(_simPanel, 0xFF, E_INK_WIDTH * E_INK_HEIGHT / 8);
+    memset(_simPanel + (E_INK_WIDTH * E_INK_HEIGHT / 8), 0xFF, E_INK_WIDTH * E_INK_HEIGHT / 8);
+#else
+    memset(_simPanel, INKPLATE_WHITE | (INKPLATE_WHITE << 4), E_INK_WIDTH * E_INK_HEIGHT / 2);
+#endif
+    _simStats.einkOns++;
+    simAdvanceMicros(SIM_COLOR_REFRESH_US);
+    refreshDone("clean", -1);
+}
+
+#endif
+
+/**
+ * @brief       simGetStats gets the counters of the emulated panel.
+ *
+ * @return      Pointer to the counters, valid as long as the driver.
+ */
+const struct simStats *EPDDriver::simGetStats()
+{
+    return &_simStats;
+}
+
+/**
+ * @brief       refreshStart remembers the counters and the time at the start of a refresh.
+ */
+void EPDDriver::refreshStart()
+{
+    _simRefreshStart = _simStats;
+    _simRefreshStartUs = simGetMicros();
+}
+
+/**
+ * @brief       refreshDone prints the CSV report of the refresh (and of each phase of its waveform table) and
+ *              saves the snapshots if the output directory is set.
+ *
+ * @param       const char *_kind
+ *              Refresh type, used in the report and in the names of the snapshots.
+ *
+ * @param       int _table
+ *              Waveform table of the refresh (WAVEFORM_TABLE_xxx), -1 if there is none.
+ */
+void EPDDriver::refreshDone(const char *_kind, int _table)
+{
+    uint64_t _us = simGetMicros() - _simRefreshStartUs;
+    _simStats.refreshes++;
+    _simStats.panelUs += _us;
+
+    int _phases = 0;
+#ifdef USES_WAVEFORM_ENGINE
+    const struct waveformTable *_t = _table >= 0 ? getWaveformTable(_table) : NULL;
+    _phases = _t != NULL ? _t->phaseCount : getPhaseCount();
+#endif
+
+    Serial.printf("sim,refresh,%lu,%s,%d,%lu,%lu,%llu\n", (unsigned long)_simStats.refreshes, _kind, _phases,
+                  (unsigned long)(_simStats.frames - _simRefreshStart.frames),
+                  (unsigned long)(_simStats.lines - _simRefreshStart.lines), (unsigned long long)_us);
+
+#ifdef USES_WAVEFORM_ENGINE
+    for (int p = 0; p < _phases && p < WAVEFORM_MAX_PHASES; p++)
+    {
+        // Clean has a one phase table that is not registered in the engine.
+        int _source = _t != NULL ? _t->phases[p].source : WAVEFORM_SOURCE_CLEAN;
+        int _param = _t != NULL ? _t->phases[p].param : -1;
+        int _repeat = _t != NULL ? _t->phases[p].repeat : -1;
+        Serial.printf("sim,phase,%lu,%d,%d,%d,%d,%lu\n", (unsigned long)_simStats.refreshes, p, _source, _param,
+                      _repeat, (unsigned long)getPhaseTime(p));
+    }
+#endif
+
+    if (simOutputDir == NULL)
+        return;
+
+    char _path[256];
+    snprintf(_path, sizeof(_path), "%s/%04lu-%s-fb.%s", simOutputDir, (unsigned long)_simStats.refreshes, _kind,
+#ifdef USE_COLOR_IMAGE
+             "ppm");
+#else
+             "pgm");
+#endif
+    simSaveFramebuffer(_path);
+    snprintf(_path, sizeof(_path), "%s/%04lu-%s-panel.%s", simOutputDir, (unsigned long)_simStats.refreshes, _kind,
+#ifdef USE_COLOR_IMAGE
+             "ppm");
+#else
+             "pgm");
+#endif
+    simSavePanel(_path);
+}
+
+/**
+ * @brief       simFramebuffer returns the framebuffer of the current mode, as the flush callback writes it.
+ *
+ * @param       uint32_t *_size
+ *              Size of the framebuffer in bytes, set if not NULL.
+ *
+ * @return      Pointer to the framebuffer (1 bit, 4 bit gray, color nibbles or the two planes of Inkplate 2).
+ */
+const uint8_t *EPDDriver::simFramebuffer(uint32_t *_size)
+{
+#if defined(ARDUINO_INKPLATE2)
+    uint32_t _bytes = E_INK_WIDTH * E_INK_HEIGHT / 4;
+    const uint8_t *_fb = DMemory4Bit;
+#elif defined(ARDUINO_INKPLATECOLOR)
+    uint32_t _bytes = E_INK_WIDTH * E_INK_HEIGHT / 2;
+    const uint8_t *_fb = DMemory4Bit;
+#else
+    uint32_t _bytes = E_INK_WIDTH * E_INK_HEIGHT / (_displayMode == 0 ? 8 : 2);
+    const uint8_t *_fb = _displayMode == 0 ? _partial : DMemory4Bit;
+#endif
+    if (_size != NULL)
+        *_size = _bytes;
+    return _fb;
+}
+
+/**
+ * @brief       simPixelBits returns the bits of one pixel in a framebuffer of the current mode.
+ *
+ * @param       const uint8_t *_fb
+ *              Framebuffer in the format of the current mode (simFramebuffer()).
+ * @param       int i
+ *              Pixel index in the native orientation (y * E_INK_WIDTH + x).
+ *
+ * @return      1 bit mode: 1 - black. 3 bit mode and 6COLOR: the nibble. Inkplate 2: B&W bit | red bit << 1.
+ */
+uint8_t EPDDriver::simPixelBits(const uint8_t *_fb, int i)
+{
+#if defined(ARDUINO_INKPLATE2)
+    uint8_t _mask = 0x80 >> (i & 7);
+    return ((_fb[i >> 3] & _mask) ? 1 : 0) | ((_fb[E_INK_WIDTH * E_INK_HEIGHT / 8 + (i >> 3)] & _mask) ? 2 : 0);
+#elif defined(ARDUINO_INKPLATECOLOR)
+    return (i & 1) ? (_fb[i >> 1] & 0x0F) : (_fb[i >> 1] >> 4);
+#else
+    if (_displayMode == 0)
+        return (_fb[i >> 3] & pixelMaskLUT[i & 7]) ? 1 : 0;
+    return (i & 1) ? (_fb[i >> 1] & 0x0F) : (_fb[i >> 1] >> 4);
+#endif
+}
+
+/**
+ * @brief       simPixelRGB returns the color of one pixel in a framebuffer of the current mode.
+ *
+ * @param       const uint8_t *_fb
+ *              Framebuffer in the format of the current mode (simFramebuffer()).
+ * @param       int i
+ *              Pixel index in the native orientation (y * E_INK_WIDTH + x).
+ * @param       uint8_t *_rgb
+ *              Red, green and blue of the pixel (all three the same on the grayscale boards).
+ */
+void EPDDriver::simPixelRGB(const uint8_t *_fb, int i, uint8_t *_rgb)
+{
+    uint8_t _bits = simPixelBits(_fb, i);
+
+#if defined(ARDUINO_INKPLATE2)
+    // B&W plane (bit 1 - white) and the red plane (bit 0 - red).
+    uint16_t _c = !(_bits & 2) ? 0xF800 : ((_bits & 1) ? 0xFFFF : 0x0000);
+#elif defined(ARDUINO_INKPLATECOLOR)
+    uint16_t _c = _paletteIdeal[_bits < paletteSize ? _bits : 1];
+#else
+    uint8_t _gray = _displayMode == 0 ? (_bits ? 0 : 255) : (_bits & 0x07) * 255 / 7;
+    _rgb[0] = _rgb[1] = _rgb[2] = _gray;
+    return;
+#endif
+
+#ifdef USE_COLOR_IMAGE
+    _rgb[0] = _RED(_c);
+    _rgb[1] = _GREEN(_c);
+    _rgb[2] = _BLUE(_c);
+#endif
+}
+
+/**
+ * @brief       simSaveFramebuffer saves the framebuffer of the current mode in its native orientation, as a PGM
+ *              (1 bit and 3 bit modes) or a PPM (color boards) image.
+ *
+ * @param       const char *_path
+ *              Path of the image on the host.
+ *
+ * @return      True if saved, false if the file can't be written
+ */
+bool EPDDriver::simSaveFramebuffer(const char *_path)
+{
+    FILE *f = fopen(_path, "wb");
+    if (f == NULL)
+        return false;
+
+    const uint8_t *_fb = simFramebuffer(NULL);
+#ifdef USE_COLOR_IMAGE
+    fprintf(f, "P6\n%d %d\n255\n", E_INK_WIDTH, E_INK_HEIGHT);
+#else
+    fprintf(f, "P5\n%d %d\n255\n", E_INK_WIDTH, E_INK_HEIGHT);
+#endif
+    for (int i = 0; i < E_INK_WIDTH * E_INK_HEIGHT; i++)
+    {
+        uint8_t _rgb[3];
+        simPixelRGB(_fb, i, _rgb);
+#ifdef USE_COLOR_IMAGE
+        fwrite(_rgb, 1, 3, f);
+#else
+        fputc(_rgb[0], f);
+#endif
+    }
+
+    return fclose(f) == 0;
+}
+
+/**
+ * @brief       simSavePanel saves what the emulated panel shows, as seen by the user (color boards are rotated
+ *              into the orientation of the LVGL display).
+ *
+ * @param       const char *_path
+ *              Path of the image on the host.
+ *
+ * @return      True if saved, false if the file can't be written
+ */
+bool EPDDriver::simSavePanel(const char *_path)
+{
+    FILE *f = fopen(_path, "wb");
+    if (f == NULL)
+        return false;
+
+#if defined(ARDUINO_INKPLATE2)
+    // Panel is mounted rotated, view(x, y) is framebuffer(y, E_INK_HEIGHT - 1 - x).
+    fprintf(f, "P6\n%d %d\n255\n", E_INK_HEIGHT, E_INK_WIDTH);
+    for (int y = 0; y < E_INK_WIDTH; y++)
+    {
+        for (int x = 0; x < E_INK_HEIGHT; x++)
+        {
+            uint8_t _rgb[3];
+            simPixelRGB(_simPanel, (E_INK_HEIGHT - 1 - x) * E_INK_WIDTH + y, _rgb);
+            fwrite(_rgb, 1, 3, f);
+        }
+    }
+#elif defined(ARDUINO_INKPLATECOLOR)
+    // Panel is mounted upside down, framebuffer is stored rotated by 180°.
+    fprintf(f, "P6\n%d %d\n255\n", E_INK_WIDTH, E_INK_HEIGHT);
+    for (int i = E_INK_WIDTH * E_INK_HEIGHT - 1; i >= 0; i--)
+    {
+        uint8_t _rgb[3];
+        simPixelRGB(_simPanel, i, _rgb);
+        fwrite(_rgb, 1, 3, f);
+    }
+#else
+    fprintf(f, "P5\n%d %d\n255\n", E_INK_WIDTH, E_INK_HEIGHT);
+    fwrite(_simPanel, 1, E_INK_WIDTH * E_INK_HEIGHT, f);
+#endif
+
+    return fclose(f) == 0;
+}
@@ -0,0 +1,221 @@
+/**
+ **************************************************
+ * @file        SimDriver.h
+ * @brief       Mock EPD driver of the host simulator. It has the interface and the framebuffer formats of the
+ *              driver of the selected board, and the waveform boards run the real waveform engine, but lines go
+ *              into an emulated panel instead of the hardware. Every refresh is reported on stdout and saved as
+ *              PGM/PPM snapshots, time is counted on the simulated clock.
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#ifndef __SIM_DRIVER_H__
+#define __SIM_DRIVER_H__
+
+#include "Arduino.h"
+#include "SdFat.h"
+#include "Wire.h"
+
+// Panel size and colors come from the board pins.h, waveform tables from the board waveforms.h.
+#if defined(ARDUINO_INKPLATE10V2)
+#define INKPLATE_BOARD_NAME "Inkplate 10"
+#include "boards/Inkplate10/pins.h"
+#include "boards/Inkplate10/waveforms.h"
+#define SIM_WAVEFORM_FLAGS WAVEFORM_FLAG_BOTTOM_UP
+#elif defined(ARDUINO_INKPLATE6V2)
+#define INKPLATE_BOARD_NAME "Inkplate 6"
+#include "boards/Inkplate6/pins.h"
+#include "boards/Inkplate6/waveforms.h"
+#define SIM_WAVEFORM_FLAGS (WAVEFORM_FLAG_BOTTOM_UP | WAVEFORM_FLAG_I2S_SWIZZLE | WAVEFORM_FLAG_CLEAN_LINES)
+#elif defined(ARDUINO_INKPLATE6FLICK)
+#define INKPLATE_BOARD_NAME "Inkplate 6FLICK"
+#include "boards/Inkplate6FLICK/pins.h"
+#include "boards/Inkplate6FLICK/waveforms.h"
+#define SIM_WAVEFORM_FLAGS (WAVEFORM_FLAG_BOTTOM_UP | WAVEFORM_FLAG_I2S_SWIZZLE | WAVEFORM_FLAG_CLEAN_LINES)
+#elif defined(ARDUINO_INKPLATE5V2)
+#define INKPLATE_BOARD_NAME "Inkplate 5V2"
+#include "boards/Inkplate5V2/pins.h"
+#include "boards/Inkplate5V2/waveforms.h"
+#define SIM_WAVEFORM_FLAGS (WAVEFORM_FLAG_I2S_SWIZZLE | WAVEFORM_FLAG_CLEAN_LINES)
+#elif defined(ARDUINO_INKPLATECOLOR)
+#define INKPLATE_BOARD_NAME "Inkplate 6COLOR"
+#include "boards/Inkplate6COLOR/pins.h"
+#elif defined(ARDUINO_INKPLATE2)
+#define INKPLATE_BOARD_NAME "Inkplate 2"
+#include "boards/Inkplate2/pins.h"
+#endif
+
+#include "graphics/GraphicsDefs.h"
+#include "system/defines.h"
+
+#ifdef USE_COLOR_IMAGE
+#include "graphics/ditheringColor/ditherAlgorithm.h"
+#else
+#include "graphics/ditheringGrayscale/ditherAlgorithm.h"
+#endif
+
+// Panel timing model, all in microseconds of the simulated clock.
+#ifndef SIM_BUS_BYTES_PER_US
+#define SIM_BUS_BYTES_PER_US 10 // 8 bit panel data bus clocked at 10 MHz.
+#endif
+#ifndef SIM_VSCAN_START_US
+#define SIM_VSCAN_START_US 71 // Sum of the delays in vscan_start() of the boards.
+#endif
+#ifndef SIM_EINK_ON_US
+#define SIM_EINK_ON_US 10000 // PMIC power up until power good.
+#endif
+#ifndef SIM_EINK_OFF_US
+#define SIM_EINK_OFF_US 10000
+#endif
+#ifndef SIM_COLOR_REFRESH_US
+#ifdef ARDUINO_INKPLATE2
+#define SIM_COLOR_REFRESH_US 15000000 // Rough refresh time of the panel (controller is busy).
+#else
+#define SIM_COLOR_REFRESH_US 12000000
+#endif
+#endif
+
+// Emulated pixel moves by this much (0 black - 255 white) in every frame it's driven.
+#ifndef SIM_PANEL_STEP
+#define SIM_PANEL_STEP 64
+#endif
+
+/**
+ * @brief       What the mock panel has done since begin().
+ */
+struct simStats
+{
+    uint32_t refreshes;
+    uint32_t frames;   // Frames sent by the waveform engine (vscan_start() followed by at least one line).
+    uint32_t lines;    // Lines sent, data and clean ones.
+    uint32_t einkOns;  // Panel power ups.
+    uint64_t panelUs;  // Simulated time spent in refreshes (power up/down, lines, frame delays, controller busy).
+};
+
+class Inkplate;
+class EPDDriver;
+
+// Directory for the snapshots saved after each refresh (NULL - don't save them), set by the simulator.
+extern const char *simOutputDir;
+
+// Driver of the sketch, set by initDriver().
+extern EPDDriver *simDriver;
+
+// Golden images (SimGolden.cpp): directory of the board goldens (NULL - not checked), rewrite them instead of
+// comparing, checks done and how many of them failed.
+extern const char *simGoldenDir;
+extern bool simGoldenUpdate;
+extern uint32_t simGoldenChecks;
+extern uint32_t simGoldenFailures;
+
+class EPDDriver
+#ifdef USES_WAVEFORM_ENGINE
+    : public WaveformEngine
+#endif
+{
+  public:
+    void writePixelInternal(int16_t x, int16_t y, uint16_t color);
+    int initDriver(Inkplate *_inkplatePtr);
+
+    void display(bool _leaveOn = 0);
+    void clearDisplay();
+
+    int16_t sdCardInit();
+    void sdCardSleep();
+    double readBattery();
+
+#ifdef USES_WAVEFORM_ENGINE
+    bool selectDisplayMode(uint8_t displayMode);
+    uint8_t getDisplayMode();
+    bool hasFramebuffers()
+    {
+        return _displayMode == 0 ? (DMemoryNew != NULL && _partial != NULL) : DMemory4Bit != NULL;
+    }
+    uint32_t partialUpdate(bool _forced = false, bool leaveOn = false);
+    void setFullUpdateThreshold(uint16_t _numberOfPartialUpdates);
+    int8_t readTemperature();
+    int einkOn();
+    void einkOff();
+    void clean(uint8_t c, uint8_t rep);
+#else
+    void clean();
+#endif
+
+    // Simulator only.
+    const struct simStats *simGetStats();
+    bool simSaveFramebuffer(const char *_path);
+    bool simSavePanel(const char *_path);
+    bool simCheckGolden(const char *_name);
+    const uint8_t *simFramebuffer(uint32_t *_size);
+    uint8_t simPixelBits(const uint8_t *_fb, int i);
+    void simPixelRGB(const uint8_t *_fb, int i, uint8_t *_rgb);
+
+    DitherAlgorithm dither;
+
+    uint8_t _beginDone = 0;
+    uint8_t _displayMode = 0;
+
+#ifdef ARDUINO_INKPLATE6FLICK
+    lv_indev_t *touchIndev = NULL;
+#endif
+
+    uint8_t *DMemory4Bit = NULL;
+#ifdef USES_WAVEFORM_ENGINE
+    uint8_t *DMemoryNew = NULL;
+    uint8_t *_partial = NULL;
+    uint8_t *_pBuffer = NULL;
+    uint16_t _partialUpdateLimiter = 10;
+    uint16_t _partialUpdateCounter = 0;
+    uint8_t _blockPartial = 1;
+#endif
+
+  private:
+    void refreshStart();
+    void refreshDone(const char *_kind, int _table);
+
+#ifdef USES_WAVEFORM_ENGINE
+    uint8_t initializeFramebuffers();
+    void releaseFramebuffers(uint8_t _mode);
+    void display1b(bool _leaveOn);
+    void display3b(bool _leaveOn);
+    void vscan_start();
+    void vscan_end();
+    void sendLine();
+    void sendCleanLine(uint8_t _clean);
+    void driveRow(volatile uint8_t *_line, uint8_t _clean);
+
+    uint8_t _panelState = 0;
+    int _simLine = 0; // Line of the current frame, 0 right after vscan_start().
+#else
+    // Color palette of the board, same as in the real driver.
+#ifdef ARDUINO_INKPLATE2
+    uint16_t _paletteIdeal[3] = {0xFFFF, 0x0000, 0xF800};
+    uint8_t _paletteIndex[3] = {0, 1, 2};
+    int8_t paletteSize = 3;
+#else
+    uint16_t _paletteIdeal[7] = {0x0000, 0xFFFF, 0x07E0, 0x001F, 0xF800, 0xFFE0, 0xFBE0};
+    uint8_t _paletteIndex[7] = {0, 1, 2, 3, 4, 5, 6};
+    int8_t paletteSize = 7;
+#endif
+#endif
+
+    // Emulated panel. Waveform boards: one byte per pixel (0 black - 255 white) moved by every frame. Color
+    // boards: copy of the framebuffer sent by the last display(), the controller draws it as it is.
+    uint8_t *_simPanel = NULL;
+    struct simStats _simStats = {0, 0, 0, 0, 0};
+    struct simStats _simRefreshStart = {0, 0, 0, 0, 0};
+    uint64_t _simRefreshStartUs = 0;
+    Inkplate *_inkplate;
+};
+
+#endif
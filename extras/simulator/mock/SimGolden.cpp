@@ -0,0 +1,224 @@
+/**
+ **************************************************
+ * @file        SimGolden.cpp
+ * @brief       Golden image check of the host simulator. Framebuffer of the current mode (as the flush callback
+ *              and dithering wrote it) is compared bit for bit with a checked in golden file, differences are
+ *              saved as images.
+ *
+ * @note        Golden files are PackBits compressed copies of the native framebuffer (1 bit, 4 bit gray, color
+ *              nibbles or the two planes of Inkplate 2), <golden dir>/<scene>-<mode>.golden.
+ *
+ * @copyright   GNU General Public License v3.0
+ * @authors     Soldered
+ ***************************************************/
+
+// Library header first, it selects the board features (USES_WAVEFORM_ENGINE) before SimDriver.h is included.
+#include "Inkplate-LVGL.h"
+
+const char *simGoldenDir = NULL;
+bool simGoldenUpdate = false;
+uint32_t simGoldenChecks = 0;
+uint32_t simGoldenFailures = 0;
+
+/**
+ * @brief       packBits compresses a buffer (header byte n >= 0: n + 1 literal bytes follow, n < 0: next byte
+ *              repeats 1 - n times).
+ *
+ * @param       const uint8_t *_in
+ *              Data to compress.
+ * @param       uint32_t _size
+ *              Size of the data.
+ * @param       FILE *f
+ *              Where the compressed data is written.
+ */
+static void packBits(const uint8_t *_in, uint32_t _size, FILE *f)
+{
+    uint32_t i = 0;
+    while (i < _size)
+    {
+        uint32_t _run = 1;
+        while (i + _run < _size && _run < 128 && _in[i + _run] == _in[i])
+            _run++;
+
+        if (_run > 1)
+        {
+            fputc((uint8_t)(1 - (int)_run), f);
+            fputc(_in[i], f);
+            i += _run;
+            continue;
+        }
+
+        // Literal block ends where a run of at least 2 starts.
+        uint32_t _start = i;
+        while (i < _size && i - _start < 128 && !(i + 1 < _size && _in[i] == _in[i + 1]))
+            i++;
+        fputc((uint8_t)(i - _start - 1), f);
+        fwrite(_in + _start, 1, i - _start, f);
+    }
+}
+
+/**
+ * @brief       unpackBits decompresses a golden file.
+ *
+ * @param       FILE *f
+ *              Golden file.
+ * @param       uint8_t *_out
+ *              Decompressed data.
+ * @param       uint32_t _size
+ *              Expected size of the data.
+ *
+ * @return      True if the file has exactly _size bytes of data.
+ */
+static bool unpackBits(FILE *f, uint8_t *_out, uint32_t _size)
+{
+    uint32_t _n = 0;
+    int _header;
+
+    while ((_header = fgetc(f)) != EOF)
+    {
+        int8_t _h = (int8_t)_header;
+        if (_h >= 0)
+        {
+            if (_n + _h + 1 > _size || fread(_out + _n, 1, _h + 1, f) != (size_t)(_h + 1))
+                return false;
+            _n += _h + 1;
+        }
+        else if (_h != -128)
+        {
+            int _c = fgetc(f);
+            if (_c == EOF || _n + 1 - _h > _size)
+                return false;
+            memset(_out + _n, _c, 1 - _h);
+            _n += 1 - _h;
+        }
+    }
+
+    return _n == _size;
+}
+
+/**
+ * @brief       saveImage saves a framebuffer of the current mode in its native orientation as a PPM image. With a
+ *              reference, pixels that differ from it are magenta and the rest is faded.
+ *
+ * @param       EPDDriver *_drv
+ *              Driver, knows the framebuffer format.
+ * @param       const char *_path
+ *              Path of the image on the host.
+ * @param       const uint8_t *_fb
+ *              Framebuffer.
+ * @param       const uint8_t *_ref
+ *              Reference framebuffer or NULL.
+ *
+ * @return      Number of pixels different from the reference.
+ */
+static uint32_t saveImage(EPDDriver *_drv, const char *_path, const uint8_t *_fb, const uint8_t *_ref)
+{
+    FILE *f = fopen(_path, "wb");
+    uint32_t _diff = 0;
+
+    if (f != NULL)
+        fprintf(f, "P6\n%d %d\n255\n", E_INK_WIDTH, E_INK_HEIGHT);
+
+    for (int i = 0; i < E_INK_WIDTH * E_INK_HEIGHT; i++)
+    {
+        uint8_t _rgb[3];
+        _drv->simPixelRGB(_fb, i, _rgb);
+        if (_ref != NULL)
+        {
+            if (_drv->simPixelBits(_fb, i) != _drv->simPixelBits(_ref, i))
+            {
+                _rgb[0] = 255;
+                _rgb[1] = 0;
+                _rgb[2] = 255;
+                _diff++;
+            }
+            else
+            {
+                for (int c = 0; c < 3; c++)
+                    _rgb[c] = 192 + _rgb[c] / 4;
+            }
+        }
+        if (f != NULL)
+            fwrite(_rgb, 1, 3, f);
+    }
+
+    if (f != NULL)
+        fclose(f);
+    return _diff;
+}
+
+/**
+ * @brief       simCheckGolden compares the framebuffer of the current mode with its golden file and prints the
+ *              result as "golden,<board>,<scene>-<mode>,<ok|fail|missing|updated>,<different pixels>". If it
+ *              differs and the simulator has an output directory, <scene>-<mode>-golden.ppm, -actual.ppm and
+ *              -diff.ppm are saved there. With simGoldenUpdate the golden file is rewritten instead.
+ *
+ * @param       const char *_name
+ *              Name of the scene.
+ *
+ * @return      True if the framebuffer matches (or the golden was updated, or golden check is off), false if not.
+ */
+bool EPDDriver::simCheckGolden(const char *_name)
+{
+    if (simGoldenDir == NULL)
+        return true;
+
+    uint32_t _size;
+    const uint8_t *_fb = simFramebuffer(&_size);
+#if defined(ARDUINO_INKPLATE2)
+    const char *_mode = "2plane";
+#elif defined(ARDUINO_INKPLATECOLOR)
+    const char *_mode = "7color";
+#else
+    const char *_mode = _displayMode == 0 ? "1bit" : "3bit";
+#endif
+
+    char _path[256];
+    snprintf(_path, sizeof(_path), "%s/%s-%s.golden", simGoldenDir, _name, _mode);
+    simGoldenChecks++;
+
+    if (simGoldenUpdate)
+    {
+        FILE *f = fopen(_path, "wb");
+        if (f != NULL)
+        {
+            packBits(_fb, _size, f);
+            fclose(f);
+        }
+        Serial.printf("golden,%s,%s-%s,%s,0\n", INKPLATE_BOARD_NAME, _name, _mode, f != NULL ? "updated" : "missing");
+        return f != NULL;
+    }
+
+    uint8_t *_golden = (uint8_t *)malloc(_size);
+    FILE *f = fopen(_path, "rb");
+    bool _loaded = _golden != NULL && f != NULL && unpackBits(f, _golden, _size);
+    if (f != NULL)
+        fclose(f);
+
+    uint32_t _diff = 0;
+    if (_loaded && memcmp(_golden, _fb, _size) != 0)
+    {
+        if (simOutputDir != NULL)
+        {
+            snprintf(_path, sizeof(_path), "%s/%s-%s-golden.ppm", simOutputDir, _name, _mode);
+            saveImage(this, _path, _golden, NULL);
+            snprintf(_path, sizeof(_path), "%s/%s-%s-actual.ppm", simOutputDir, _name, _mode);
+            saveImage(this, _path, _fb, NULL);
+            snprintf(_path, sizeof(_path), "%s/%s-%s-diff.ppm", simOutputDir, _name, _mode);
+        }
+        // Unused bits of a byte can differ too, count at least one pixel.
+        _diff = saveImage(this, simOutputDir != NULL ? _path : "/dev/null", _fb, _golden);
+        _diff = _diff ? _diff : 1;
+    }
+    free(_golden);
+
+    const char *_result = !_loaded ? "missing" : (_diff ? "fail" : "ok");
+    Serial.printf("golden,%s,%s-%s,%s,%lu\n", INKPLATE_BOARD_NAME, _name, _mode, _result, (unsigned long)_diff);
+
+    if (!_loaded || _diff)
+    {
+        simGoldenFailures++;
+        return false;
+    }
+    return true;
+}
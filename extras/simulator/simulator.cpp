@@ -0,0 +1,71 @@
+// Host simulator of the Inkplate LVGL library. Runs an Arduino sketch (setup() and loop()) against the mock EPD
+// driver of the selected board, reports every refresh as CSV on stdout and saves PGM/PPM snapshots of the
+// framebuffer and the emulated panel. With -g, simCheckGolden() calls of the sketch compare the framebuffer with the
+// golden files of the board and the exit code is the result.
+//
+// Usage: ./build/<BOARD>/simulator [-o output_dir] [-s sd_root] [-n loops] [-g golden_dir [-u]]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "Inkplate-LVGL.h"
+
+static void usage(const char *_name)
+{
+    fprintf(stderr, "Usage: %s [-o output_dir] [-s sd_root] [-n loops] [-g golden_dir [-u]]\n", _name);
+    fprintf(stderr, "  -o   Save snapshots of each refresh into this directory (created if missing)\n");
+    fprintf(stderr, "  -s   Host directory used as the SD card (default: %s)\n", simSdRoot);
+    fprintf(stderr, "  -n   Number of loop() calls after setup() (default: 1)\n");
+    fprintf(stderr, "  -g   Compare framebuffers with the golden files in this directory (diff images go to -o)\n");
+    fprintf(stderr, "  -u   Rewrite the golden files instead of comparing\n");
+}
+
+int main(int argc, char **argv)
+{
+    long loops = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "-o") == 0)
+            simOutputDir = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-s") == 0)
+            simSdRoot = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-n") == 0)
+            loops = strtol(argv[++i], NULL, 10);
+        else if (i + 1 < argc && strcmp(argv[i], "-g") == 0)
+            simGoldenDir = argv[++i];
+        else if (strcmp(argv[i], "-u") == 0)
+            simGoldenUpdate = true;
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (simOutputDir != NULL)
+        mkdir(simOutputDir, 0755);
+
+    printf("sim,board,%s,%d,%d\n", INKPLATE_BOARD_NAME, E_INK_WIDTH, E_INK_HEIGHT);
+
+    setup();
+    for (long i = 0; i < loops; i++)
+        loop();
+
+    if (simDriver != NULL)
+    {
+        const struct simStats *_stats = simDriver->simGetStats();
+        printf("sim,total,%lu,%lu,%lu,%lu,%llu,%llu\n", (unsigned long)_stats->refreshes,
+               (unsigned long)_stats->frames, (unsigned long)_stats->lines, (unsigned long)_stats->einkOns,
+               (unsigned long long)_stats->panelUs, (unsigned long long)simGetMicros());
+    }
+
+    if (simGoldenDir != NULL)
+    {
+        printf("golden,total,%lu,%lu\n", (unsigned long)simGoldenChecks, (unsigned long)simGoldenFailures);
+        return simGoldenFailures ? 2 : 0;
+    }
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ **************************************************
+ *
+ * @file        RefreshSchedulerFull.ino
+ * @brief       Checks the refresh scheduler when LVGL renders in LV_DISPLAY_RENDER_MODE_FULL (no invalidated
+ *              areas are reported in that mode, every flush is the whole screen): the panel is refreshed, small
+ *              changes get a partial update and full updates done by partialUpdate() are counted as full.
+ *
+ *              Runs only in the host simulator: "make test BOARD=..." in extras/simulator. Prints one
+ *              "test,<name>,ok" or "test,<name>,fail" line per check.
+ *
+ * @authors     Soldered
+ * @date        November 2025
+ ***************************************************/
+
+#ifndef INKPLATE_SIMULATOR
+#error "This sketch runs only in the host simulator (extras/simulator)"
+#endif
+
+// Include the Inkplate LVGL Library
+#include <Inkplate-LVGL.h>
+
+#ifdef USE_COLOR_IMAGE
+Inkplate inkplate;
+#else
+Inkplate inkplate(INKPLATE_1BIT);
+#endif
+
+// Run LVGL for _ms milliseconds of simulated time
+void runLvgl(uint32_t _ms)
+{
+  for (uint32_t t = 0; t < _ms; t += 10)
+  {
+    lv_tick_inc(10);
+    delay(10);
+    lv_timer_handler();
+  }
+}
+
+void check(const char *_name, bool _ok)
+{
+  Serial.printf("test,%s,%s\n", _name, _ok ? "ok" : "fail");
+}
+
+uint32_t schedulerRefreshes()
+{
+  return inkplate.refreshScheduler.getRefreshCount(REFRESH_PARTIAL) +
+         inkplate.refreshScheduler.getRefreshCount(REFRESH_FULL) +
+         inkplate.refreshScheduler.getRefreshCount(REFRESH_CLEAN);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  inkplate.begin(LV_DISPLAY_RENDER_MODE_FULL);
+  check("scheduler-begin", inkplate.refreshScheduler.begin(&inkplate));
+
+  lv_obj_t *label = lv_label_create(lv_screen_active());
+  lv_label_set_text(label, "Refresh scheduler");
+  lv_obj_center(label);
+
+  // First frame, LVGL draws it and the scheduler refreshes the panel after the debounce time.
+  runLvgl(1000);
+  uint32_t first = schedulerRefreshes();
+  uint32_t panelFirst = simDriver->simGetStats()->refreshes;
+  check("full-mode-first-frame", first == 1 && panelFirst != 0);
+
+  // Nothing has changed, no refresh.
+  runLvgl(1000);
+  check("full-mode-idle", schedulerRefreshes() == first);
+
+  // Change of a label is a new refresh. Changed pixels come from the framebuffer, a small change is a partial one
+  // on boards that have it.
+  lv_label_set_text(label, "Changed");
+  runLvgl(1000);
+#ifdef USES_WAVEFORM_ENGINE
+  uint8_t small = REFRESH_PARTIAL;
+#else
+  uint8_t small = REFRESH_FULL;
+#endif
+  check("full-mode-change", schedulerRefreshes() == first + 1 && inkplate.refreshScheduler.getLastRefresh() == small);
+
+#ifdef USES_WAVEFORM_ENGINE
+  // Partial updates the driver turns into full ones (blocked after setFullUpdateThreshold(), then its limiter) are
+  // reported as full and reset the ghosting.
+  inkplate.setFullUpdateThreshold(1);
+  uint32_t full = inkplate.refreshScheduler.getRefreshCount(REFRESH_FULL);
+
+  lv_label_set_text(label, "Blocked");
+  runLvgl(1000);
+  check("fallback-blocked", inkplate.refreshScheduler.getLastRefresh() == REFRESH_FULL &&
+                                inkplate.refreshScheduler.getRefreshCount(REFRESH_FULL) == full + 1 &&
+                                inkplate.refreshScheduler.getGhosting() == 0);
+
+  lv_label_set_text(label, "Partial");
+  runLvgl(1000);
+  check("fallback-partial", inkplate.refreshScheduler.getLastRefresh() == REFRESH_PARTIAL);
+
+  lv_label_set_text(label, "Limiter");
+  runLvgl(1000);
+  check("fallback-limiter", inkplate.refreshScheduler.getLastRefresh() == REFRESH_FULL &&
+                                inkplate.refreshScheduler.getRefreshCount(REFRESH_FULL) == full + 2 &&
+                                inkplate.refreshScheduler.getGhosting() == 0);
+#endif
+}
+
+void loop()
+{
+}
@@ -27,11 +27,19 @@
 #ifndef ARDUINO_INKPLATE2
 #include "lvgl/FS_driver_implementation.h"
 #endif
+#include "lvgl/MemFS_driver_implementation.h"
 #include "boardSelect.h"
 #include "graphics/GraphicsDefs.h"
 #include "system/InkplateBoards.h"
 #include "system/NetworkController/NetworkController.h"
 #include "system/defines.h"
+#include "system/einkTheme/EinkTheme.h"
+#include "system/lvglService/LvglService.h"
+#include "system/memoryPlacement/MemoryPlacement.h"
+#include "system/memoryStats/MemoryStats.h"
+#include "system/pipelineBenchmark/PipelineBenchmark.h"
+#include "system/profiler/Profiler.h"
+#include "system/refreshScheduler/RefreshScheduler.h"
 
 
 void display_flush_callback(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map);
@@ -44,12 +52,25 @@ class Inkplate : public InkplateBoardClass, public NetworkController
 #else
     Inkplate();
 #endif
-    void begin(lv_display_render_mode_t renderMode = LV_DISP_RENDER_MODE_FULL);
+    void begin(lv_display_render_mode_t renderMode = LV_DISP_RENDER_MODE_FULL,
+               const struct memoryPlacement *placement = NULL, bool startLvglService = false);
     void drawPixel(int16_t x, int16_t y, uint16_t color);
     void setRotation(uint8_t r);
     void enableDithering(bool state);
     uint8_t getRotation();
+    uint16_t getPartialRows();
+    bool isRenderBufferInternal();
+    struct memoryStats getMemoryStats();
+    struct memoryBudget getMemoryBudget();
+    void printMemoryStats(Print &out = Serial);
+#ifndef ARDUINO_INKPLATE2
+    bool saveMemoryStats(const char *path);
+    bool saveFramebuffer(const char *path);
+    bool loadFramebuffer(const char *path);
+#endif
     lv_display_t *disp;
+    LvglService lvglService;
+    RefreshScheduler refreshScheduler;
     bool ditherEnabled = false;
     lv_display_render_mode_t _renderMode;
 
@@ -57,11 +78,18 @@ class Inkplate : public InkplateBoardClass, public NetworkController
   protected:
   private:
     uint8_t _rotation = 0;
-    uint8_t _width = 0;
-    uint8_t _height = 0;
+    uint16_t _width = 0;
+    uint16_t _height = 0;
     uint8_t _beginDone = 0;
     uint8_t _mode;
+    struct memoryPlacement _placement = MEMORY_PLACEMENT_DEFAULT;
+    uint16_t _partialRows = 0;
+    bool _renderBuffersInternal = false;
     void writePixel(int16_t x, int16_t y, uint16_t color);
     void initLVGL(lv_display_render_mode_t renderMode);
+    void initRenderBuffers(lv_display_render_mode_t renderMode);
+    uint16_t pickPartialRows(uint32_t _rowSize);
+    bool allocRenderBuffers(uint32_t _size, uint32_t _caps, lv_color_t **_buf1, lv_color_t **_buf2);
+    uint8_t *nativeFramebuffer(uint32_t *_size);
 };
 #endif
\ No newline at end of file
@@ -18,6 +18,7 @@
  ***************************************************/
 
 #include "Inkplate-LVGL.h"
+#include "soc/soc.h"
 
 #ifndef USE_COLOR_IMAGE
 Inkplate::Inkplate(uint8_t mode)
@@ -37,9 +38,21 @@ Inkplate::Inkplate()
  * @param       lv_display_render_mode_t renderMode - sets what render mode will be used to draw inside the framebuffer
  *              options: LV_DISP_RENDER_MODE_FULL (default), LV_DISP_RENDER_MODE_DIRECT, LV_DISP_RENDER_MODE_PARTIAL
  *
+ * @param       const struct memoryPlacement *placement - which buffers must be in internal RAM and which may go
+ *              to PSRAM, MEMORY_PLACEMENT_DEFAULT is used if NULL
+ *
+ * @param       bool startLvglService - start the library managed LVGL task (lvglService), it owns the LVGL tick
+ *              and runs lv_timer_handler(). Use lvglService.lock()/unlock() around LVGL calls from the sketch.
+ *              If the task can't be started, a warning is printed and lvglService.isRunning() stays false, the
+ *              sketch has to call lv_timer_handler() then.
+ *
+ * @note        With INKPLATE_PARALLEL_DRAW set in lv_conf.h, lv_init() starts two draw unit tasks (one per core)
+ *              and lv_timer_handler() takes the LVGL lock by itself.
+ *
  * @note        If the begin function was already called, skip the initialization
  */
-void Inkplate::begin(lv_display_render_mode_t renderMode)
+void Inkplate::begin(lv_display_render_mode_t renderMode, const struct memoryPlacement *placement,
+                     bool startLvglService)
 {
     // Check if the initializaton of the library already done.
     // In the case of already initialized library, return form the begin() funtion to
@@ -51,19 +64,48 @@ void Inkplate::begin(lv_display_render_mode_t renderMode)
 
     _renderMode = renderMode;
 
+    if (placement != NULL)
+        _placement = *placement;
+
     initLVGL(renderMode);
 
-    // Init low level driver for EPD.
-    initDriver(this);
+    // Tell the driver where its hot tables must be before it allocates them.
+    dither.setMemoryCaps(memoryPlacementCaps(_placement.ditherRows));
+#ifdef USES_WAVEFORM_ENGINE
+    _waveformCaps = memoryPlacementCaps(_placement.luts);
+#endif
 
-// Forward the display mode to the EPD driver
+// Forward the display mode to the EPD driver before its init, so only framebuffers of this mode are allocated
 #ifndef USE_COLOR_IMAGE
     selectDisplayMode(_mode);
 #endif
 
+    // Init low level driver for EPD. It needs the LVGL display (touchscreen input device), so it comes after
+    // LVGL.
+    initDriver(this);
+
+    // Render buffers are sized from the internal RAM the driver left free (LUTs, DMA lines, framebuffers).
+    initRenderBuffers(renderMode);
+
     // Clean frame buffers.
     clearDisplay();
 
+    if (startLvglService)
+    {
+        if (lvglService.begin(disp))
+        {
+#ifdef ARDUINO_INKPLATE6FLICK
+            // Touchscreen interrupt wakes up the service, no need to poll it every LV_DEF_REFR_PERIOD.
+            lvglService.setEventDriven(touchIndev);
+#endif
+        }
+        else
+        {
+            // The sketch can still drive LVGL itself, same as with startLvglService = false.
+            Serial.println("WARNING: Failed to start LVGL service, call lv_timer_handler() from loop()");
+        }
+    }
+
     // Block multiple inits.
     _beginDone = 1;
 }
@@ -120,6 +162,11 @@ void Inkplate::initLVGL(lv_display_render_mode_t renderMode)
     // Init the lvgl library itself
     lv_init();
 
+#if INKPLATE_PARALLEL_DRAW
+    // Draw unit threads are started by lv_init(), one on each core.
+    Serial.printf("LVGL draw units: %d\n", LV_DRAW_SW_DRAW_UNIT_CNT);
+#endif
+
 // Define display resolution
 #ifndef ARDUINO_INKPLATE2
     uint32_t screen_width = E_INK_WIDTH;
@@ -128,23 +175,6 @@ void Inkplate::initLVGL(lv_display_render_mode_t renderMode)
     uint32_t screen_width = E_INK_HEIGHT;
     uint32_t screen_height = E_INK_WIDTH;
 #endif
-    uint32_t buffer_size;
-    lv_color_t *buf_1;
-    lv_color_t *buf_2;
-
-    if (renderMode == LV_DISPLAY_RENDER_MODE_PARTIAL)
-    {
-#define PARTIAL_ROWS 16
-        buf_1 = (lv_color_t *)heap_caps_malloc(screen_width * PARTIAL_ROWS * (LV_COLOR_DEPTH / 8), MALLOC_CAP_8BIT);
-        buf_2 = (lv_color_t *)heap_caps_malloc(screen_width * PARTIAL_ROWS * (LV_COLOR_DEPTH / 8), MALLOC_CAP_8BIT);
-        buffer_size = screen_width * PARTIAL_ROWS * (LV_COLOR_DEPTH / 8);
-    }
-    else
-    {
-        buf_1 = (lv_color_t *)heap_caps_malloc(screen_width * screen_height * (LV_COLOR_DEPTH / 8), MALLOC_CAP_8BIT);
-        buf_2 = (lv_color_t *)heap_caps_malloc(screen_width * screen_height * (LV_COLOR_DEPTH / 8), MALLOC_CAP_8BIT);
-        buffer_size = screen_width * screen_height * (LV_COLOR_DEPTH / 8);
-    }
 
     // Create a display driver instance
     disp = lv_display_create(screen_width, screen_height);
@@ -163,9 +193,12 @@ void Inkplate::initLVGL(lv_display_render_mode_t renderMode)
     lv_display_set_color_format(disp, LV_COLOR_FORMAT_L8);
 #endif
 
-
-    // Attach the buffer
-    lv_display_set_buffers(disp, buf_1, buf_2, buffer_size, renderMode);
+#if INKPLATE_EINK_PROFILE
+    // Flat theme, no shadows, gradients or transitions
+    lv_theme_t *theme = einkThemeInit(disp);
+    if (theme != NULL)
+        lv_display_set_theme(disp, theme);
+#endif
 
     // Store this Inkplate instance
     lv_display_set_user_data(disp, this);
@@ -177,11 +210,373 @@ void Inkplate::initLVGL(lv_display_render_mode_t renderMode)
 #ifndef ARDUINO_INKPLATE2
     lv_fs_init_sd();
 #endif
+    lv_fs_init_mem();
 
     Serial.println("LVGL initialization complete");
 }
 
+/**
+ * @brief       initRenderBuffers allocates the LVGL render buffers and attaches them to the display.
+ *
+ * @param       lv_display_render_mode_t renderMode
+ *              LVGL render mode passed to begin().
+ *
+ * @note        Called after initDriver(), so the partial buffer height is picked from the internal RAM that is
+ *              really left free once the driver has allocated its framebuffers, LUTs and DMA lines.
+ */
+void Inkplate::initRenderBuffers(lv_display_render_mode_t renderMode)
+{
+    if (disp == NULL)
+        return;
+
+// Define display resolution
+#ifndef ARDUINO_INKPLATE2
+    uint32_t screen_width = E_INK_WIDTH;
+    uint32_t screen_height = E_INK_HEIGHT;
+#else
+    uint32_t screen_width = E_INK_HEIGHT;
+    uint32_t screen_height = E_INK_WIDTH;
+#endif
+    uint32_t row_size = screen_width * (LV_COLOR_DEPTH / 8);
+    uint32_t buffer_size;
+    uint32_t caps = memoryPlacementCaps(_placement.renderBuffers);
+    lv_color_t *buf_1 = NULL;
+    lv_color_t *buf_2 = NULL;
+
+    if (renderMode == LV_DISPLAY_RENDER_MODE_PARTIAL)
+    {
+        _partialRows = _placement.partialRows != 0 ? _placement.partialRows : pickPartialRows(row_size);
+
+        // Rows picked automatically are only an estimate (heap can be fragmented), go smaller until both fit.
+        while (!allocRenderBuffers(row_size * _partialRows, caps, &buf_1, &buf_2) && _placement.partialRows == 0 &&
+               _partialRows > MEMORY_PLACEMENT_MIN_ROWS)
+        {
+            _partialRows = max(_partialRows / 2, MEMORY_PLACEMENT_MIN_ROWS);
+        }
+    }
+    else
+    {
+        // Full screen buffers rarely fit into internal RAM, let the heap decide unless PSRAM is requested.
+        if (_placement.renderBuffers == MEMORY_PLACE_INTERNAL)
+            caps = memoryPlacementCaps(MEMORY_PLACE_ANY);
+
+        _partialRows = screen_height;
+        allocRenderBuffers(row_size * _partialRows, caps, &buf_1, &buf_2);
+    }
+
+    // Rendering from PSRAM is slow, but still better than no display at all.
+    if (buf_1 == NULL && _placement.renderBuffers != MEMORY_PLACE_PSRAM)
+    {
+        Serial.println("WARNING: Render buffers don't fit into internal RAM, using PSRAM");
+        allocRenderBuffers(row_size * _partialRows, MALLOC_CAP_SPIRAM, &buf_1, &buf_2);
+    }
+
+    if (buf_1 == NULL)
+    {
+        Serial.println("ERROR: Failed to allocate LVGL render buffers!");
+        return;
+    }
+
+    buffer_size = row_size * _partialRows;
+    _renderBuffersInternal = !((uintptr_t)buf_1 >= SOC_EXTRAM_DATA_LOW && (uintptr_t)buf_1 < SOC_EXTRAM_DATA_HIGH);
+    Serial.printf("Render buffers: 2 x %lu bytes (%u rows) in %s\n", (unsigned long)buffer_size, _partialRows,
+                  _renderBuffersInternal ? "internal RAM" : "PSRAM");
+
+    // Attach the buffer
+    lv_display_set_buffers(disp, buf_1, buf_2, buffer_size, renderMode);
+}
+
 void Inkplate::enableDithering(bool state)
 {
     ditherEnabled = state;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief       getPartialRows returns height of the LVGL render buffers picked by begin().
+ *
+ * @return      Rows of each render buffer (screen height in LV_DISP_RENDER_MODE_FULL and _DIRECT).
+ *
+ * @note        Use isRenderBufferInternal() to check if they ended up in internal RAM.
+ */
+uint16_t Inkplate::getPartialRows()
+{
+    return _partialRows;
+}
+
+/**
+ * @brief       isRenderBufferInternal tells where begin() placed the LVGL render buffers.
+ *
+ * @return      true if render buffers are in internal RAM, false if they are in PSRAM.
+ */
+bool Inkplate::isRenderBufferInternal()
+{
+    return _renderBuffersInternal;
+}
+
+/**
+ * @brief       pickPartialRows finds the largest partial render buffer height for which both render buffers fit
+ *              into internal RAM, leaving internalReserve bytes free.
+ *
+ * @param       uint32_t _rowSize
+ *              Size of one render buffer row in bytes.
+ *
+ * @return      Rows of each render buffer, between MEMORY_PLACEMENT_MIN_ROWS and maxPartialRows.
+ */
+uint16_t Inkplate::pickPartialRows(uint32_t _rowSize)
+{
+    if (_placement.renderBuffers == MEMORY_PLACE_PSRAM)
+        return _placement.maxPartialRows;
+
+    uint32_t freeInternal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    uint32_t largestInternal = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+
+    // Two buffers, each has to fit into a single free block.
+    uint32_t available = 0;
+    if (freeInternal > _placement.internalReserve)
+        available = (freeInternal - _placement.internalReserve) / 2;
+    if (available > largestInternal)
+        available = largestInternal;
+
+    uint32_t rows = available / _rowSize;
+    if (rows > _placement.maxPartialRows)
+        rows = _placement.maxPartialRows;
+    if (rows < MEMORY_PLACEMENT_MIN_ROWS)
+        rows = MEMORY_PLACEMENT_MIN_ROWS;
+
+    return rows;
+}
+
+/**
+ * @brief       allocRenderBuffers allocates both LVGL render buffers.
+ *
+ * @param       uint32_t _size
+ *              Size of each buffer in bytes.
+ * @param       uint32_t _caps
+ *              Memory capabilities (MALLOC_CAP_xxx).
+ * @param       lv_color_t **_buf1
+ *              First buffer, NULL if allocation failed.
+ * @param       lv_color_t **_buf2
+ *              Second buffer, NULL if allocation failed.
+ *
+ * @return      true if both buffers are allocated, false otherwise (nothing stays allocated).
+ */
+bool Inkplate::allocRenderBuffers(uint32_t _size, uint32_t _caps, lv_color_t **_buf1, lv_color_t **_buf2)
+{
+    *_buf1 = (lv_color_t *)trackedMalloc(MEMORY_TAG_DRAW_BUFFER, _size, _caps);
+    *_buf2 = (lv_color_t *)trackedMalloc(MEMORY_TAG_DRAW_BUFFER, _size, _caps);
+    if (*_buf1 != NULL && *_buf2 != NULL)
+        return true;
+
+    trackedFree(MEMORY_TAG_DRAW_BUFFER, *_buf1, _size);
+    trackedFree(MEMORY_TAG_DRAW_BUFFER, *_buf2, _size);
+    *_buf1 = NULL;
+    *_buf2 = NULL;
+    return false;
+}
+
+/**
+ * @brief       getMemoryStats returns the snapshot of the memory usage of the library (LVGL allocator,
+ *              draw buffers, framebuffers, driver buffers, dithering and downloads) and of the whole heap.
+ *
+ * @return      struct memoryStats with the current values
+ *
+ * @note        allocRate is calculated since the previous call of this function.
+ */
+struct memoryStats Inkplate::getMemoryStats()
+{
+    struct memoryStats stats;
+    lv_mem_monitor_t mon;
+
+    memoryStatsGet(&stats);
+
+    lv_mem_monitor(&mon);
+    stats.lvglTotal = mon.total_size;
+    stats.lvglFree = mon.free_size;
+    stats.lvglLargestFree = mon.free_biggest_size;
+    stats.lvglFragmentation = mon.frag_pct;
+
+    return stats;
+}
+
+/**
+ * @brief       getMemoryBudget returns how much memory the display stack (framebuffers of the current display
+ *              mode, draw buffers, driver buffers and LVGL heap) holds and how much is still free.
+ *
+ * @return      struct memoryBudget with the current values
+ *
+ * @note        Framebuffers are allocated only for the current display mode, so this changes after
+ *              selectDisplayMode(). Size image caches against largestFreePsram.
+ */
+struct memoryBudget Inkplate::getMemoryBudget()
+{
+    struct memoryBudget budget;
+    memoryStatsBudget(&budget);
+    return budget;
+}
+
+/**
+ * @brief       printMemoryStats prints the memory usage as CSV lines ("tag,name,live,peak,blocks,allocs"
+ *              for every tag, "hist,name,bin counts..." for the size histograms and "heap,..." lines).
+ *
+ * @param       Print &out
+ *              Where to print the stats, Serial by default (SdFile can also be used)
+ */
+void Inkplate::printMemoryStats(Print &out)
+{
+    struct memoryStats stats = getMemoryStats();
+    const uint32_t limits[MEMORY_HISTOGRAM_BINS] = MEMORY_HISTOGRAM_LIMITS;
+
+    out.printf("uptime,%lu\n", (unsigned long)stats.uptime);
+    for (int i = 0; i < MEMORY_TAG_COUNT; i++)
+    {
+        out.printf("tag,%s,%lu,%lu,%lu,%lu\n", memoryStatsTagName(i), (unsigned long)stats.liveBytes[i],
+                   (unsigned long)stats.peakBytes[i], (unsigned long)stats.liveBlocks[i],
+                   (unsigned long)stats.allocCount[i]);
+    }
+
+    out.print("histBins");
+    for (int j = 0; j < MEMORY_HISTOGRAM_BINS - 1; j++)
+        out.printf(",%lu", (unsigned long)limits[j]);
+    out.print(",max\n");
+    for (int i = 0; i < MEMORY_TAG_COUNT; i++)
+    {
+        out.printf("hist,%s", memoryStatsTagName(i));
+        for (int j = 0; j < MEMORY_HISTOGRAM_BINS; j++)
+            out.printf(",%lu", (unsigned long)stats.histogram[i][j]);
+        out.print("\n");
+    }
+
+    out.printf("allocRate,%.1f\n", stats.allocRate);
+    out.printf("heap,psram,%lu,%lu,%lu\n", (unsigned long)stats.freePsram, (unsigned long)stats.largestFreePsram,
+               (unsigned long)stats.minFreePsram);
+    out.printf("heap,internal,%lu,%lu,%lu\n", (unsigned long)stats.freeInternal,
+               (unsigned long)stats.largestFreeInternal, (unsigned long)stats.minFreeInternal);
+    out.printf("heap,lvgl,%lu,%lu,%lu,%u\n", (unsigned long)stats.lvglTotal, (unsigned long)stats.lvglFree,
+               (unsigned long)stats.lvglLargestFree, stats.lvglFragmentation);
+}
+
+#ifndef ARDUINO_INKPLATE2
+/**
+ * @brief       saveMemoryStats appends the memory usage (same format as printMemoryStats()) to the file
+ *              on the SD card. SD card must be initialized with sdCardInit() first.
+ *
+ * @param       const char *path
+ *              Path of the file on the SD card
+ *
+ * @return      true if successful, false if the file can't be opened
+ */
+bool Inkplate::saveMemoryStats(const char *path)
+{
+    SdFile file;
+    if (!file.open(path, O_WRITE | O_CREAT | O_APPEND))
+        return false;
+
+    printMemoryStats(file);
+    file.close();
+
+    return true;
+}
+
+// Header of a framebuffer file, the framebuffer follows it as it is in memory.
+#define FRAMEBUFFER_FILE_MAGIC 0x42465049 // "IPFB"
+
+struct framebufferFileHeader
+{
+    uint32_t magic;
+    uint16_t width; // E_INK_WIDTH and E_INK_HEIGHT of the board.
+    uint16_t height;
+    uint8_t mode; // Display mode of the framebuffer.
+    uint8_t reserved[3];
+    uint32_t size; // Bytes of the framebuffer.
+};
+
+/**
+ * @brief       nativeFramebuffer returns the framebuffer of the current display mode in its native packed format
+ *              (1 bit _partial or 4 bit DMemory4Bit, color nibbles on Inkplate 6COLOR).
+ *
+ * @param       uint32_t *_size
+ *              Size of the framebuffer in bytes.
+ *
+ * @return      Pointer to the framebuffer.
+ */
+uint8_t *Inkplate::nativeFramebuffer(uint32_t *_size)
+{
+#ifdef USE_COLOR_IMAGE
+    *_size = E_INK_WIDTH * E_INK_HEIGHT / 2;
+    return DMemory4Bit;
+#else
+    *_size = E_INK_WIDTH * E_INK_HEIGHT / (_displayMode == INKPLATE_1BIT ? 8 : 2);
+    return _displayMode == INKPLATE_1BIT ? _partial : DMemory4Bit;
+#endif
+}
+
+/**
+ * @brief       saveFramebuffer writes the framebuffer of the current display mode to the SD card as it is in
+ *              memory (no conversion), through the buffered 'S:' LVGL driver. SD card must be initialized with
+ *              sdCardInit() first.
+ *
+ * @param       const char *path
+ *              Path of the file on the SD card
+ *
+ * @return      true if successful, false if the file can't be written
+ */
+bool Inkplate::saveFramebuffer(const char *path)
+{
+    PROFILER_SCOPE("saveFramebuffer");
+    char lvPath[256];
+    lv_fs_file_t file;
+    uint32_t written;
+    struct framebufferFileHeader header = {FRAMEBUFFER_FILE_MAGIC, E_INK_WIDTH, E_INK_HEIGHT, _displayMode};
+    uint8_t *fb = nativeFramebuffer(&header.size);
+
+    snprintf(lvPath, sizeof(lvPath), "S:%s", path);
+    if (fb == NULL || lv_fs_open(&file, lvPath, LV_FS_MODE_WR) != LV_FS_RES_OK)
+        return false;
+
+    bool ok = lv_fs_write(&file, &header, sizeof(header), &written) == LV_FS_RES_OK && written == sizeof(header) &&
+              lv_fs_write(&file, fb, header.size, &written) == LV_FS_RES_OK && written == header.size;
+    ok &= lv_fs_close(&file) == LV_FS_RES_OK;
+    return ok;
+}
+
+/**
+ * @brief       loadFramebuffer reads a framebuffer saved with saveFramebuffer() back into the framebuffer of the
+ *              current display mode. Call display() (or partialUpdate()) to show it. LVGL draws over it on its next
+ *              refresh: the whole screen in LV_DISPLAY_RENDER_MODE_FULL, only the invalidated areas in the other
+ *              render modes.
+ *
+ * @param       const char *path
+ *              Path of the file on the SD card
+ *
+ * @return      true if successful, false if the file can't be read, is truncated or was saved on another board or
+ *              in another display mode (framebuffer is not changed then, only a read error in the middle of the
+ *              framebuffer leaves it partly loaded)
+ */
+bool Inkplate::loadFramebuffer(const char *path)
+{
+    PROFILER_SCOPE("loadFramebuffer");
+    char lvPath[256];
+    lv_fs_file_t file;
+    uint32_t read;
+    struct framebufferFileHeader header;
+    uint32_t size;
+    uint8_t *fb = nativeFramebuffer(&size);
+
+    snprintf(lvPath, sizeof(lvPath), "S:%s", path);
+    if (fb == NULL || lv_fs_open(&file, lvPath, LV_FS_MODE_RD) != LV_FS_RES_OK)
+        return false;
+
+    uint32_t fileSize = 0;
+    bool ok = lv_fs_seek(&file, 0, LV_FS_SEEK_END) == LV_FS_RES_OK && lv_fs_tell(&file, &fileSize) == LV_FS_RES_OK &&
+              lv_fs_seek(&file, 0, LV_FS_SEEK_SET) == LV_FS_RES_OK;
+
+    ok = ok && lv_fs_read(&file, &header, sizeof(header), &read) == LV_FS_RES_OK && read == sizeof(header) &&
+         header.magic == FRAMEBUFFER_FILE_MAGIC && header.width == E_INK_WIDTH && header.height == E_INK_HEIGHT &&
+         header.mode == _displayMode && header.size == size && fileSize == sizeof(header) + size;
+
+    // Framebuffer is read in one piece, bigger than the read-ahead cache it goes from the card straight into it.
+    ok = ok && lv_fs_read(&file, fb, size, &read) == LV_FS_RES_OK && read == size;
+    lv_fs_close(&file);
+    return ok;
+}
+#endif
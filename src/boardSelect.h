@@ -16,26 +16,41 @@
 #include <Arduino.h>
 
 #ifdef ARDUINO_INKPLATE10V2
-#include "boards/Inkplate10/Inkplate10BoardFile.h"
+#define USES_WAVEFORM_ENGINE
 #elif defined(ARDUINO_INKPLATE6V2)
 #define USES_I2S
-#include "boards/Inkplate6/Inkplate6BoardFile.h"
+#define USES_WAVEFORM_ENGINE
 #elif defined(ARDUINO_INKPLATE6FLICK)
 #define USES_I2S
+#define USES_WAVEFORM_ENGINE
 #define MULTIPLE_DISPLAY_MODES
-#include "boards/Inkplate6FLICK/Inkplate6FLICKBoardFile.h"
 #elif defined(ARDUINO_INKPLATE5V2)
 #define USES_I2S
+#define USES_WAVEFORM_ENGINE
 #define MULTIPLE_DISPLAY_MODES
-#include "boards/Inkplate5V2/Inkplate5V2BoardFile.h"
 #elif defined(ARDUINO_INKPLATECOLOR)
 #define USE_COLOR_IMAGE
-#include "boards/Inkplate6COLOR/Inkplate6COLORBoardFile.h"
 #elif defined(ARDUINO_INKPLATE2)
 #define USE_COLOR_IMAGE
-#include "boards/Inkplate2/Inkplate2BoardFile.h"
 #else
 #error "Board not selected!"
 #endif
 
+// Board file of the selected board, the host simulator (extras/simulator) brings its own with the mock EPD driver.
+#ifdef INKPLATE_SIMULATOR
+#include "SimBoardFile.h"
+#elif defined(ARDUINO_INKPLATE10V2)
+#include "boards/Inkplate10/Inkplate10BoardFile.h"
+#elif defined(ARDUINO_INKPLATE6V2)
+#include "boards/Inkplate6/Inkplate6BoardFile.h"
+#elif defined(ARDUINO_INKPLATE6FLICK)
+#include "boards/Inkplate6FLICK/Inkplate6FLICKBoardFile.h"
+#elif defined(ARDUINO_INKPLATE5V2)
+#include "boards/Inkplate5V2/Inkplate5V2BoardFile.h"
+#elif defined(ARDUINO_INKPLATECOLOR)
+#include "boards/Inkplate6COLOR/Inkplate6COLORBoardFile.h"
+#elif defined(ARDUINO_INKPLATE2)
+#include "boards/Inkplate2/Inkplate2BoardFile.h"
+#endif
+
 #endif
\ No newline at end of file
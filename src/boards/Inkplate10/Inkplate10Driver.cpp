@@ -7,179 +7,6 @@
 SPIClass spi2(2);
 SdFat sd(&spi2);
 
-/**
- *
- * @brief       writePixelInternal funtion sets pixel data for (x, y) pixel position
- *
- * @param       int16_t x0
- *              default position for x, will be changed depending on rotation
- * @param       int16_t y0
- *              default position for y, will be changed depending on rotation
- * @param       uint16_t color
- *              pixel color, in 3bit mode have values in range 0-7
- *
- * @note        If x0 or y0 are out of inkplate screen borders, function will
- * exit.
- */
-void EPDDriver::writePixelInternal(int16_t x, int16_t y, uint16_t color)
-{
-    int16_t x0 = x;
-    int16_t y0 = y;
-    if (x0 > E_INK_WIDTH - 1 || y0 > E_INK_HEIGHT - 1 || x0 < 0 || y0 < 0)
-        return;
-
-    // set x, y depending on selected rotation
-    switch (_inkplate->getRotation())
-    {
-    case 1: // 90 degree left
-        _swap_int16_t(x0, y0);
-        x0 = E_INK_HEIGHT - x0 - 1;
-        break;
-    case 2: // 180 degree, or upside down
-        x0 = E_INK_WIDTH - x0 - 1;
-        y0 = E_INK_HEIGHT - y0 - 1;
-        break;
-    case 3: // 90 degree right
-        _swap_int16_t(x0, y0);
-        y0 = E_INK_WIDTH - y0 - 1;
-        break;
-    }
-
-    // If the 1 bit mode is used, pixels are packed 1 bit = 1 pixel in frame buffer
-    if (getDisplayMode() == 0)
-    {
-        // Divide by 8 to find a byte.
-        int x = x0 >> 3;
-
-        // Get the remainder of the division to find a exact bit in the byte that needs to be modified.
-        int x_sub = x0 & 7;
-
-        // Save the currnet state of the byte in the frame buffer.
-        uint8_t temp = *(_partial + (E_INK_WIDTH / 8) * y0 + x);
-
-        // Modify the pixel. First clear the pixel by writing zero then write the 1 if the pixel is set.
-        *(_partial + (E_INK_WIDTH / 8) * y0 + x) = (~pixelMaskLUT[x_sub] & temp) | (color ? pixelMaskLUT[x_sub] : 0);
-    }
-    else
-    {
-        // If 3 bit mode is used, constrain the color value (only 8 possible colors are available).
-        color &= 7;
-
-        // Divide by two to find a byte
-        int x = x0 >> 1;
-
-        //  Get the remainder of the division to find if the lower or upper 4 bits are needed.
-        int x_sub = x0 & 1;
-
-        // Store the current value of the byte.
-        uint8_t temp;
-        temp = *(DMemory4Bit + (E_INK_WIDTH / 2) * y0 + x);
-
-        // Modify the specific pixel by writing all zeros into lower or upper 4 bits and set the needed color.
-        *(DMemory4Bit + (E_INK_WIDTH / 2) * y0 + x) = (pixelMaskGLUT[x_sub] & temp) | (x_sub ? color : color << 4);
-    }
-}
-
-/**
- * @brief       display_flush_callback function is called whenever there is a change made on the current
- *              LVGL screen. The data is downscaled to 3 bit or 1 bit grayscale depending on the current display mode
- *              and stored in the EPD buffer for rendering
- *
- * @param       lv_display_t *disp
- *              A pointer to the created LVGL display instance
- *
- * @param       lv_area_t *area
- *              A pointer to the area of the display which has changed
- *
- * @param       uint8_t px_map
- *              An array of pixel values in L8 format
- *
- */
-void IRAM_ATTR display_flush_callback(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
-{
-    Inkplate *self = static_cast<Inkplate *>(lv_display_get_user_data(disp));
-
-    int32_t w = lv_area_get_width(area);
-    int32_t h = lv_area_get_height(area);
-
-    if (w <= 0 || h <= 0 || px_map == nullptr || area->x1 < 0 || area->y1 < 0 || area->x2 >= E_INK_WIDTH ||
-        area->y2 >= E_INK_HEIGHT)
-    {
-        lv_display_flush_ready(disp);
-        return;
-    }
-
-    bool is3bit = (self->getDisplayMode() == INKPLATE_3BIT);
-
-    if (self->ditherEnabled && self->_renderMode == LV_DISP_RENDER_MODE_FULL)
-    {
-        self->dither.ditherFramebuffer(px_map, E_INK_WIDTH, E_INK_HEIGHT, is3bit);
-    }
-    else
-    {
-        uint8_t *buffer1b = self->_partial;
-        uint8_t *buffer3b = self->DMemory4Bit;
-
-        const int width_bytes_1b = E_INK_WIDTH / 8;
-        const int width_bytes_3b = E_INK_WIDTH / 2;
-
-        // Preload LUTs to local for faster access
-        const uint8_t *maskLUT = pixelMaskLUT;
-        const uint8_t *maskGLUT = pixelMaskGLUT;
-
-        for (int32_t y = 0; y < h; y++)
-        {
-            int32_t screen_y = area->y1 + y;
-            const uint8_t *src_row = px_map + (y * w);
-
-            if (is3bit)
-            {
-                uint8_t *dst_row = buffer3b + (width_bytes_3b * screen_y);
-
-                for (int32_t x = 0; x < w; x++)
-                {
-                    int32_t screen_x = area->x1 + x;
-                    if (screen_x >= E_INK_WIDTH)
-                        break;
-
-                    uint8_t gray3 = src_row[x] >> 5;
-                    int x_byte = screen_x / 2;
-                    int x_sub = screen_x % 2;
-
-                    uint8_t temp = dst_row[x_byte];
-                    uint8_t newv = (maskGLUT[x_sub] & temp) | (x_sub ? gray3 : (gray3 << 4));
-
-                    dst_row[x_byte] = newv;
-                }
-            }
-            else
-            {
-                uint8_t *dst_row = buffer1b + (width_bytes_1b * screen_y);
-
-                for (int32_t x = 0; x < w; x++)
-                {
-                    int32_t screen_x = area->x1 + x;
-                    if (screen_x >= E_INK_WIDTH)
-                        break;
-
-                    uint8_t gray = src_row[x];
-                    uint8_t bit = (gray < 128) ? 1 : 0;
-
-                    int x_byte = screen_x / 8;
-                    int x_sub = screen_x % 8;
-
-                    uint8_t temp = dst_row[x_byte];
-                    // Preserve other bits using original mask logic
-                    dst_row[x_byte] = (~maskLUT[x_sub] & temp) | (bit ? maskLUT[x_sub] : 0);
-                }
-            }
-        }
-    }
-
-
-    lv_display_flush_ready(disp);
-}
-
 
 /**
  * @brief       begin function initialize Inkplate object with predefined
@@ -205,6 +32,11 @@ int EPDDriver::initDriver(Inkplate *_inkplatePtr)
     // Initialize the all GPIOs
     gpioInit();
 
+    // Select the waveforms for each refresh type
+    setWaveformTable(WAVEFORM_TABLE_1BIT, &waveformTable1Bit);
+    setWaveformTable(WAVEFORM_TABLE_3BIT, &waveformTable3Bit);
+    setWaveformTable(WAVEFORM_TABLE_PARTIAL, &waveformTablePartial);
+
     // Check waveform ID in EEPROM
     checkWaveformID();
 
@@ -214,8 +46,12 @@ int EPDDriver::initDriver(Inkplate *_inkplatePtr)
         return 0;
     }
 
-    // Calculate color LUTs to optimize drawing to the screen
-    calculateLUTs();
+    // Init the waveform engine. Line is sent using GPIO, so engine needs it's own line buffer.
+    if (!beginWaveformEngine(NULL, E_INK_WIDTH, E_INK_HEIGHT, WAVEFORM_FLAG_BOTTOM_UP))
+    {
+        Serial.println("Failed to initialize waveform engine!");
+        return 0;
+    }
 
     dither.begin(_inkplatePtr);
 
@@ -224,27 +60,6 @@ int EPDDriver::initDriver(Inkplate *_inkplatePtr)
 }
 
 
-/**
- * @brief       Calculates the values of the lookup table to
- *              speed up rendering
- */
-void EPDDriver::calculateLUTs()
-{
-    for (int j = 0; j < 9; ++j)
-    {
-        for (uint32_t i = 0; i < 256; ++i)
-        {
-            uint8_t z = (waveform3Bit[i & 0x07][j] << 2) | (waveform3Bit[(i >> 4) & 0x07][j]);
-            GLUT[j * 256 + i] = ((z & B00000011) << 4) | (((z & B00001100) >> 2) << 18) |
-                                (((z & B00010000) >> 4) << 23) | (((z & B11100000) >> 5) << 25);
-            z = ((waveform3Bit[i & 0x07][j] << 2) | (waveform3Bit[(i >> 4) & 0x07][j])) << 4;
-            GLUT2[j * 256 + i] = ((z & B00000011) << 4) | (((z & B00001100) >> 2) << 18) |
-                                 (((z & B00010000) >> 4) << 23) | (((z & B11100000) >> 5) << 25);
-        }
-    }
-}
-
-
 /**
  * @brief       vscan_start starts writing new frame and skips first two lines
  * that are invisible on screen
@@ -291,10 +106,38 @@ void EPDDriver::vscan_end()
  * @param       uint8_t
  *              if set to 1, it will be set to grayscale mode
  *              if set to 0, set to BW mode
+ *
+ * @return      true if the framebuffers of the mode are allocated, false if there is not enough memory (the
+ *              previous mode is kept then)
+ *
+ * @note        After begin(), framebuffers of the previous mode are freed and the buffers of the new mode are
+ *              allocated and cleared.
  */
-void EPDDriver::selectDisplayMode(uint8_t displayMode)
+bool EPDDriver::selectDisplayMode(uint8_t displayMode)
 {
+    // Before initDriver() only save the mode, framebuffers are allocated there.
+    if (!_beginDone)
+    {
+        _displayMode = displayMode;
+        return true;
+    }
+
+    // Same mode needs nothing, unless an earlier failure left it without framebuffers.
+    if (displayMode == _displayMode && hasFramebuffers())
+        return true;
+
+    // Free the old buffers first, so both modes never have to fit into PSRAM at the same time.
+    uint8_t oldMode = _displayMode;
+    releaseFramebuffers(oldMode);
     _displayMode = displayMode;
+    if (initializeFramebuffers())
+        return true;
+
+    // Not enough memory, go back to the previous mode. If even its buffers can't be allocated again, drawing and
+    // display() do nothing until a mode is selected successfully.
+    _displayMode = oldMode;
+    initializeFramebuffers();
+    return false;
 }
 
 /**
@@ -305,6 +148,9 @@ void EPDDriver::selectDisplayMode(uint8_t displayMode)
  */
 void EPDDriver::clearDisplay()
 {
+    if (!hasFramebuffers())
+        return;
+
     // Clear 1 bit per pixel display buffer
     if (_inkplate->getDisplayMode() == 0)
     {
@@ -325,6 +171,9 @@ void EPDDriver::clearDisplay()
  */
 void EPDDriver::display(bool _leaveOn)
 {
+    if (!hasFramebuffers())
+        return;
+
     if (_inkplate->getDisplayMode() == 0)
     {
         display1b(_leaveOn);
@@ -347,50 +196,9 @@ void IRAM_ATTR EPDDriver::display3b(bool leaveOn)
 {
     if (!einkOn())
         return;
-    clean(1, 1);
-    clean(0, 10);
-    clean(2, 1);
-    clean(1, 10);
-    clean(2, 1);
-    clean(0, 10);
-    clean(2, 1);
-    clean(1, 10);
-
-    for (int k = 0; k < 9; k++)
-    {
-        uint8_t *dp = DMemory4Bit + (E_INK_HEIGHT * E_INK_WIDTH / 2);
 
-        vscan_start();
-        for (int i = 0; i < E_INK_HEIGHT; i++)
-        {
-            uint32_t t = GLUT2[k * 256 + (*(--dp))];
-            t |= GLUT[k * 256 + (*(--dp))];
-            hscan_start(t);
-            t = GLUT2[k * 256 + (*(--dp))];
-            t |= GLUT[k * 256 + (*(--dp))];
-            GPIO.out_w1ts = t | CL;
-            GPIO.out_w1tc = DATA | CL;
-
-            for (int j = 0; j < ((E_INK_WIDTH / 8) - 1); j++)
-            {
-                t = GLUT2[k * 256 + (*(--dp))];
-                t |= GLUT[k * 256 + (*(--dp))];
-                GPIO.out_w1ts = t | CL;
-                GPIO.out_w1tc = DATA | CL;
-                t = GLUT2[k * 256 + (*(--dp))];
-                t |= GLUT[k * 256 + (*(--dp))];
-                GPIO.out_w1ts = t | CL;
-                GPIO.out_w1tc = DATA | CL;
-            }
-
-            GPIO.out_w1ts = CL;
-            GPIO.out_w1tc = DATA | CL;
-            vscan_end();
-        }
-        delayMicroseconds(230);
-    }
-    clean(3, 1);
-    vscan_start();
+    // Clear sequence, grayscale waveform and discharge, as described in waveforms.h.
+    runWaveform(WAVEFORM_TABLE_3BIT, DMemory4Bit);
 
     if (!leaveOn)
         einkOff();
@@ -409,59 +217,12 @@ void EPDDriver::display1b(bool _leaveOn)
 {
     memcpy(DMemoryNew, _partial, E_INK_WIDTH * E_INK_HEIGHT / 8);
 
-    uint32_t _pos;
-    uint8_t data;
-    uint8_t dram;
-    uint8_t _repeat;
-
     if (!einkOn())
         return;
 
-    clean(0, 1);
-    clean(1, 10);
-    clean(2, 1);
-    clean(0, 10);
-    clean(2, 1);
-    clean(1, 10);
-    clean(2, 1);
-    clean(0, 10);
-    _repeat = 5;
-
-    for (int k = 0; k < _repeat; k++)
-    {
-        _pos = (E_INK_HEIGHT * E_INK_WIDTH / 8) - 1;
-        vscan_start();
-        for (int i = 0; i < E_INK_HEIGHT; i++)
-        {
-            dram = (*(DMemoryNew + _pos));
-            data = LUTB[(dram >> 4) & 0x0F];
-            hscan_start(pinLUT[data]);
-            data = LUTB[dram & 0x0F];
-            GPIO.out_w1ts = pinLUT[data] | CL;
-            GPIO.out_w1tc = DATA | CL;
-            _pos--;
-            for (int j = 0; j < ((E_INK_WIDTH / 8) - 1); j++)
-            {
-                dram = (*(DMemoryNew + _pos));
-                data = LUTB[(dram >> 4) & 0x0F];
-                GPIO.out_w1ts = pinLUT[data] | CL;
-                GPIO.out_w1tc = DATA | CL;
-                data = LUTB[dram & 0x0F];
-                GPIO.out_w1ts = pinLUT[data] | CL;
-                GPIO.out_w1tc = DATA | CL;
-                _pos--;
-            }
-            GPIO.out_w1ts = CL;
-            GPIO.out_w1tc = DATA | CL;
-            vscan_end();
-        }
-        delayMicroseconds(230);
-    }
+    // Clear sequence, black and white waveform and discharge, as described in waveforms.h.
+    runWaveform(WAVEFORM_TABLE_1BIT, DMemoryNew);
 
-    clean(2, 2);
-    clean(3, 1);
-
-    vscan_start();
     if (!_leaveOn)
         einkOff();
     _blockPartial = 0;
@@ -486,6 +247,9 @@ void EPDDriver::display1b(bool _leaveOn)
  */
 uint32_t EPDDriver::partialUpdate(bool _forced, bool leaveOn)
 {
+    if (!hasFramebuffers())
+        return 0;
+
     if (getDisplayMode() == 1)
         return 0;
     if (_blockPartial == 1 && !_forced)
@@ -506,70 +270,24 @@ uint32_t EPDDriver::partialUpdate(bool _forced, bool leaveOn)
         return 0;
     }
 
-    uint32_t _pos = (E_INK_WIDTH * E_INK_HEIGHT / 8) - 1;
-    uint32_t _send;
-    uint8_t data = 0;
-    uint8_t diffw, diffb;
-    uint32_t n = (E_INK_WIDTH * E_INK_HEIGHT / 4) - 1;
-    uint8_t _repeat;
-
-    uint32_t changeCount = 0;
-
-    for (int i = 0; i < E_INK_HEIGHT; ++i)
+    // Buffer for the pixel to EPD conversion is only needed for partial updates, allocate it on the first one.
+    if (_pBuffer == NULL)
     {
-        for (int j = 0; j < E_INK_WIDTH / 8; ++j)
+        _pBuffer = (uint8_t *)trackedMalloc(MEMORY_TAG_FRAMEBUFFER, E_INK_WIDTH * E_INK_HEIGHT / 4, MALLOC_CAP_SPIRAM);
+        if (_pBuffer == NULL)
         {
-            diffw = *(DMemoryNew + _pos) & ~*(_partial + _pos);
-            diffb = ~*(DMemoryNew + _pos) & *(_partial + _pos);
-            if (diffw) // count pixels turning from black to white as these are visible blur
-            {
-                for (int bv = 1; bv < 256; bv <<= 1)
-                {
-                    if (diffw & bv)
-                        ++changeCount;
-                }
-            }
-            _pos--;
-            *(_pBuffer + n) = LUTW[diffw >> 4] & (LUTB[diffb >> 4]);
-            n--;
-            *(_pBuffer + n) = LUTW[diffw & 0x0F] & (LUTB[diffb & 0x0F]);
-            n--;
+            display1b(leaveOn);
+            return 0;
         }
     }
 
+    uint32_t changeCount = calculatePartial(DMemoryNew, _partial, _pBuffer);
+
     if (!einkOn())
         return 0;
 
-
-    _repeat = 5;
-
-    for (int k = 0; k < _repeat; ++k)
-    {
-        vscan_start();
-        n = (E_INK_WIDTH * E_INK_HEIGHT / 4) - 1;
-        for (int i = 0; i < E_INK_HEIGHT; ++i)
-        {
-            data = *(_pBuffer + n);
-            _send = pinLUT[data];
-            hscan_start(_send);
-            n--;
-            for (int j = 0; j < ((E_INK_WIDTH / 4) - 1); ++j)
-            {
-                data = *(_pBuffer + n);
-                _send = pinLUT[data];
-                GPIO.out_w1ts = _send | CL;
-                GPIO.out_w1tc = DATA | CL;
-                n--;
-            }
-            GPIO.out_w1ts = _send | CL;
-            GPIO.out_w1tc = DATA | CL;
-            vscan_end();
-        }
-        delayMicroseconds(230);
-    }
-    clean(2, 2);
-    clean(3, 1);
-    vscan_start();
+    // Changed pixels only and discharge, as described in waveforms.h.
+    runWaveform(WAVEFORM_TABLE_PARTIAL, _pBuffer);
 
     if (!leaveOn)
         einkOff();
@@ -613,6 +331,8 @@ void EPDDriver::setFullUpdateThreshold(uint16_t _numberOfPartialUpdates)
  */
 int EPDDriver::einkOn()
 {
+    PROFILER_SCOPE("einkOn");
+
     if (getPanelState() == 1)
         return 1;
     WAKEUP_SET;
@@ -802,38 +522,26 @@ void EPDDriver::pinsZstate()
 void EPDDriver::clean(uint8_t c, uint8_t rep)
 {
     einkOn();
-    uint8_t data = 0;
-    if (c == 0)
-        data = B10101010;
-    else if (c == 1)
-        data = B01010101;
-    else if (c == 2)
-        data = B00000000;
-    else if (c == 3)
-        data = B11111111;
-
-    uint32_t _send = pinLUT[data];
-    for (int k = 0; k < rep; ++k)
+
+    const struct waveformPhase _phase[] = {{WAVEFORM_SOURCE_CLEAN, c, rep, WAVEFORM_FRAME_DELAY}};
+    const struct waveformTable _table = WAVEFORM_TABLE(_phase, 0);
+    runWaveform(&_table, NULL);
+}
+
+/**
+ * @brief       sendLine sends one line of the EPD data from the line buffer
+ *              to the panel using GPIO.
+ */
+void IRAM_ATTR EPDDriver::sendLine()
+{
+    hscan_start(pinLUT[_waveformLine[0]]);
+    for (int j = 1; j < (E_INK_WIDTH / 4); ++j)
     {
-        vscan_start();
-        for (int i = 0; i < E_INK_HEIGHT; ++i)
-        {
-            hscan_start(_send);
-            GPIO.out_w1ts = (_send) | CL;
-            GPIO.out_w1tc = CL;
-            for (int j = 0; j < ((E_INK_WIDTH / 8) - 1); ++j)
-            {
-                GPIO.out_w1ts = CL;
-                GPIO.out_w1tc = CL;
-                GPIO.out_w1ts = CL;
-                GPIO.out_w1tc = CL;
-            }
-            GPIO.out_w1ts = CL;
-            GPIO.out_w1tc = CL;
-            vscan_end();
-        }
-        delayMicroseconds(230);
+        GPIO.out_w1ts = pinLUT[_waveformLine[j]] | CL;
+        GPIO.out_w1tc = DATA | CL;
     }
+    GPIO.out_w1ts = CL;
+    GPIO.out_w1tc = DATA | CL;
 }
 
 /**
@@ -939,33 +647,71 @@ void EPDDriver::gpioInit()
 }
 
 /**
- * @brief       initializeFramebuffers allocates memory to be used
- *              by specific display modes of the display
+ * @brief       initializeFramebuffers allocates memory used by the current display mode. 1 bit mode uses
+ *              DMemoryNew and _partial (_pBuffer is allocated on the first partial update), 3 bit mode uses
+ *              only DMemory4Bit. Buffers of the other mode are not allocated.
  *
  * @return      returns 0 if allocation failed, 1 if it succeeded
  */
 uint8_t EPDDriver::initializeFramebuffers()
 {
-    // Initialize all the framebuffers
-    DMemoryNew = (uint8_t *)ps_malloc(E_INK_WIDTH * E_INK_HEIGHT / 8);
-    _partial = (uint8_t *)ps_malloc(E_INK_WIDTH * E_INK_HEIGHT / 8);
-    _pBuffer = (uint8_t *)ps_malloc(E_INK_WIDTH * E_INK_HEIGHT / 4);
-    DMemory4Bit = (uint8_t *)ps_malloc(E_INK_WIDTH * E_INK_HEIGHT / 2);
-    GLUT = (uint32_t *)malloc(256 * 9 * sizeof(uint32_t));
-    GLUT2 = (uint32_t *)malloc(256 * 9 * sizeof(uint32_t));
-    if (DMemoryNew == NULL || _partial == NULL || _pBuffer == NULL || DMemory4Bit == NULL || GLUT == NULL ||
-        GLUT2 == NULL)
+    if (_displayMode == 0)
     {
-        return 0;
+        // Framebuffer with the image currently on the panel and the buffer that is being drawn to.
+        DMemoryNew =
+            (uint8_t *)trackedMalloc(MEMORY_TAG_FRAMEBUFFER, E_INK_WIDTH * E_INK_HEIGHT / 8, MALLOC_CAP_SPIRAM);
+        _partial = (uint8_t *)trackedMalloc(MEMORY_TAG_FRAMEBUFFER, E_INK_WIDTH * E_INK_HEIGHT / 8, MALLOC_CAP_SPIRAM);
+        if (DMemoryNew == NULL || _partial == NULL)
+        {
+            releaseFramebuffers(0);
+            return 0;
+        }
+
+        // Set all the framebuffers to White at start
+        memset(DMemoryNew, 0, E_INK_WIDTH * E_INK_HEIGHT / 8);
+        memset(_partial, 0, E_INK_WIDTH * E_INK_HEIGHT / 8);
+
+        // Content of DMemoryNew is not on the panel, first update must be a full one.
+        _blockPartial = 1;
     }
-    // Set all the framebuffers to White at start
-    memset(DMemoryNew, 0, E_INK_WIDTH * E_INK_HEIGHT / 8);
-    memset(_partial, 0, E_INK_WIDTH * E_INK_HEIGHT / 8);
-    memset(_pBuffer, 0, E_INK_WIDTH * E_INK_HEIGHT / 4);
-    memset(DMemory4Bit, 255, E_INK_WIDTH * E_INK_HEIGHT / 2);
+    else
+    {
+        // 3 bit memory buffer.
+        DMemory4Bit =
+            (uint8_t *)trackedMalloc(MEMORY_TAG_FRAMEBUFFER, E_INK_WIDTH * E_INK_HEIGHT / 2, MALLOC_CAP_SPIRAM);
+        if (DMemory4Bit == NULL)
+            return 0;
+
+        memset(DMemory4Bit, 255, E_INK_WIDTH * E_INK_HEIGHT / 2);
+    }
+
     return 1;
 }
 
+/**
+ * @brief       releaseFramebuffers frees memory used by the display mode.
+ *
+ * @param       uint8_t _mode
+ *              Display mode whose buffers are freed (0 - 1 bit, 1 - 3 bit).
+ */
+void EPDDriver::releaseFramebuffers(uint8_t _mode)
+{
+    if (_mode == 0)
+    {
+        trackedFree(MEMORY_TAG_FRAMEBUFFER, DMemoryNew, E_INK_WIDTH * E_INK_HEIGHT / 8);
+        trackedFree(MEMORY_TAG_FRAMEBUFFER, _partial, E_INK_WIDTH * E_INK_HEIGHT / 8);
+        trackedFree(MEMORY_TAG_FRAMEBUFFER, _pBuffer, E_INK_WIDTH * E_INK_HEIGHT / 4);
+        DMemoryNew = NULL;
+        _partial = NULL;
+        _pBuffer = NULL;
+    }
+    else
+    {
+        trackedFree(MEMORY_TAG_FRAMEBUFFER, DMemory4Bit, E_INK_WIDTH * E_INK_HEIGHT / 2);
+        DMemory4Bit = NULL;
+    }
+}
+
 /**
  * @brief       sdCardInit initializes sd card trough SPI
  *
@@ -1177,11 +923,11 @@ void EPDDriver::checkWaveformID()
                                          {0, 0, 2, 1, 1, 2, 2, 1, 0}, {0, 1, 2, 2, 1, 2, 2, 1, 0},
                                          {0, 0, 2, 1, 2, 2, 2, 1, 0}, {0, 2, 2, 2, 2, 2, 2, 1, 0},
                                          {0, 0, 0, 0, 0, 2, 1, 2, 0}, {0, 0, 0, 2, 2, 2, 2, 2, 0}};
-        memcpy(waveform3Bit, defaultWaveform, sizeof(waveform3Bit));
+        setWaveform(defaultWaveform);
     }
     else
     {
-        memcpy(waveform3Bit, waveformEEPROM.waveform, sizeof(waveform3Bit));
+        setWaveform(waveformEEPROM.waveform);
     }
 }
 #endif
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #ifdef ARDUINO_INKPLATE10V2
 
+#include "../../system/waveformEngine/WaveformEngine.h"
+
 #define WAVEFORM3BIT                                                                                                   \
     {{0, 0, 0, 0, 0, 0, 0, 1, 0}, {0, 0, 0, 2, 2, 2, 1, 1, 0}, {0, 0, 2, 1, 1, 2, 2, 1, 0},                            \
      {0, 1, 2, 2, 1, 2, 2, 1, 0}, {0, 0, 2, 1, 2, 2, 2, 1, 0}, {0, 2, 2, 2, 2, 2, 2, 1, 0},                            \
@@ -15,5 +17,56 @@
 #define E_INK_HEIGHT 825
 #endif
 
+// Delay between two frames [us].
+#define WAVEFORM_FRAME_DELAY 230
+
+// Clear sequence used before full refresh in 1 bit mode (white, black, white, black).
+#define WAVEFORM_CLEAR_SEQUENCE_1BIT                                                                                   \
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_WHITE, 1, WAVEFORM_FRAME_DELAY},                                            \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_BLACK, 10, WAVEFORM_FRAME_DELAY},                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, WAVEFORM_FRAME_DELAY},                                    \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_WHITE, 10, WAVEFORM_FRAME_DELAY},                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, WAVEFORM_FRAME_DELAY},                                    \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_BLACK, 10, WAVEFORM_FRAME_DELAY},                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, WAVEFORM_FRAME_DELAY},                                    \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_WHITE, 10, WAVEFORM_FRAME_DELAY}
+
+// Clear sequence used before full refresh in 3 bit mode (black, white, black, white).
+#define WAVEFORM_CLEAR_SEQUENCE_3BIT                                                                                   \
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_BLACK, 1, WAVEFORM_FRAME_DELAY},                                            \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_WHITE, 10, WAVEFORM_FRAME_DELAY},                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, WAVEFORM_FRAME_DELAY},                                    \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_BLACK, 10, WAVEFORM_FRAME_DELAY},                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, WAVEFORM_FRAME_DELAY},                                    \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_WHITE, 10, WAVEFORM_FRAME_DELAY},                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, WAVEFORM_FRAME_DELAY},                                    \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_BLACK, 10, WAVEFORM_FRAME_DELAY}
+
+// Full refresh in 1 bit mode: only black pixels, then discharge.
+const struct waveformPhase waveform1BitPhases[] = {
+    WAVEFORM_CLEAR_SEQUENCE_1BIT,
+    {WAVEFORM_SOURCE_1BIT, WAVEFORM_LUT_BLACK, 5, WAVEFORM_FRAME_DELAY},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 2, WAVEFORM_FRAME_DELAY},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_SKIP, 1, WAVEFORM_FRAME_DELAY},
+};
+
+// Full refresh in 3 bit mode: 9 phases of the grayscale waveform, then set panel drivers into HiZ state.
+const struct waveformPhase waveform3BitPhases[] = {
+    WAVEFORM_CLEAR_SEQUENCE_3BIT,
+    {WAVEFORM_SOURCE_3BIT, 0, 9, WAVEFORM_FRAME_DELAY},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_SKIP, 1, WAVEFORM_FRAME_DELAY},
+};
+
+// Partial update: changed pixels only, then discharge.
+const struct waveformPhase waveformPartialPhases[] = {
+    {WAVEFORM_SOURCE_PARTIAL, 0, 5, WAVEFORM_FRAME_DELAY},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 2, WAVEFORM_FRAME_DELAY},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_SKIP, 1, WAVEFORM_FRAME_DELAY},
+};
+
+const struct waveformTable waveformTable1Bit = WAVEFORM_TABLE(waveform1BitPhases, 1);
+const struct waveformTable waveformTable3Bit = WAVEFORM_TABLE(waveform3BitPhases, 1);
+const struct waveformTable waveformTablePartial = WAVEFORM_TABLE(waveformPartialPhases, 1);
+
 #endif
 #endif
\ No newline at end of file
@@ -40,7 +40,7 @@ class EPDDriver
     double readBattery();
 
     uint8_t _beginDone = 0;
-    uint8_t _displayMode;
+    uint8_t _displayMode = 0;
 
     DitherAlgorithm dither;
 
@@ -0,0 +1,132 @@
+/**
+ **************************************************
+ *
+ * @file        Inkplate2Framebuffer.cpp
+ * @brief       Pixel writes and the LVGL flush callback of the Inkplate 2. Nothing here touches the
+ *              hardware, so the host simulator (extras/simulator) builds it with its mock EPD driver.
+ *
+ * @copyright   GNU General Public License v3.0
+ * @authors     Soldered
+ ***************************************************/
+
+#ifdef ARDUINO_INKPLATE2
+#include "Inkplate-LVGL.h"
+
+void EPDDriver::writePixelInternal(int16_t x0, int16_t y0, uint16_t color)
+{
+    if (x0 > E_INK_HEIGHT - 1 || y0 > E_INK_WIDTH - 1 || x0 < 0 || y0 < 0)
+        return;
+    if (color > 2)
+        return;
+    _swap_int16_t(x0, y0);
+    y0 = E_INK_HEIGHT - y0 - 1;
+
+    // Find the specific byte in the frame buffer that needs to be modified.
+    // Also find the bit in the byte that needs modification.
+    int _x = x0 / 8;
+    int _xSub = x0 % 8;
+
+    int _position = E_INK_WIDTH / 8 * y0 + _x;
+
+    // Clear both black and red frame buffer.
+    *(DMemory4Bit + _position) |= (pixelMaskLUT[7 - _xSub]);
+    *(DMemory4Bit + (E_INK_WIDTH * E_INK_HEIGHT / 8) + _position) |= (pixelMaskLUT[7 - _xSub]);
+
+    // To optimize writing pixels into EPD, framebuffer is split in half, where first half is for B&W pixels and other
+    // half is for red pixels only
+    if (color < 2)
+    {
+        *(DMemory4Bit + _position) &= ~(color << (7 - _xSub));
+    }
+    else
+    {
+        *(DMemory4Bit + (E_INK_WIDTH * E_INK_HEIGHT / 8) + _position) &= ~(pixelMaskLUT[7 - _xSub]);
+    }
+}
+
+
+/**
+ * @brief       display_flush_callback function is called whenever there is a change made on the current
+ *              LVGL screen. The data is downscaled to a White-Black-Red color palette from RGB565
+ *              and stored in the EPD buffer for rendering
+ *
+ * @param       lv_display_t *disp
+ *              A pointer to the created LVGL display instance
+ *
+ * @param       lv_area_t *area
+ *              A pointer to the area of the display which has changed
+ *
+ * @param       uint8_t px_map
+ *              An array of pixel values in L8 format
+ *
+ */
+void IRAM_ATTR display_flush_callback(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    PROFILER_SCOPE("flush");
+
+    Inkplate *self = (Inkplate *)lv_display_get_user_data(disp);
+
+    int32_t w = lv_area_get_width(area);
+    int32_t h = lv_area_get_height(area);
+
+    if (self->ditherEnabled && self->_renderMode == LV_DISP_RENDER_MODE_FULL)
+    {
+        self->dither.ditherFramebuffer(px_map, E_INK_HEIGHT, E_INK_WIDTH);
+    }
+    else
+    {
+        const uint8_t *src8 = px_map;
+
+        for (int32_t y = 0; y < h; y++)
+        {
+            const uint8_t *src_row = src8 + (y * w * 2); // 2 bytes per pixel
+
+            for (int32_t x = 0; x < w; x++)
+            {
+                // Read 16-bit pixel (RGB565)
+                uint16_t px = src_row[x * 2] | (src_row[x * 2 + 1] << 8);
+
+                // Extract raw channel bits
+                uint8_t r5 = (px >> 11) & 0x1F;
+                uint8_t g6 = (px >> 5) & 0x3F;
+                uint8_t b5 = px & 0x1F;
+
+                // Cheap summed brightness
+                uint16_t bright = r5 + g6 + b5;
+
+                uint8_t color;
+
+                // Black (very low brightness)
+                if (bright < 20)
+                {
+                    color = 1; // BLACK
+                }
+                // Red (strong R, weak G/B)
+                else if (r5 > 20 && g6 < 16 && b5 < 16)
+                {
+                    color = 2; // RED
+                }
+                // White (all channels fairly high)
+                else if (r5 > 20 && g6 > 20 && b5 > 20)
+                {
+                    color = 0; // WHITE
+                }
+                // Otherwise classify into nearest
+                else
+                {
+                    // Slightly warm → red
+                    if (r5 > g6 && r5 > b5)
+                        color = 1;
+                    // Otherwise → white
+                    else
+                        color = 2;
+                }
+
+                self->writePixelInternal(area->x1 + x, area->y1 + y, color);
+            }
+        }
+    }
+    lv_display_flush_ready(disp);
+}
+
+#endif
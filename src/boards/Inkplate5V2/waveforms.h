@@ -2,6 +2,8 @@
 #ifndef __WAVEFROMS_INKPLATE_5V2_H__
 #define __WAVEFROMS_INKPLATE_5V2_H__
 
+#include "../../system/waveformEngine/WaveformEngine.h"
+
 #define WAVEFORM3BIT                                                                                                   \
     {{0, 0, 1, 1, 2, 1, 1, 1, 0}, {1, 1, 2, 2, 1, 2, 1, 1, 0}, {0, 1, 2, 2, 1, 1, 2, 1, 0},                            \
      {0, 0, 1, 1, 1, 1, 1, 2, 0}, {1, 2, 1, 2, 1, 1, 1, 2, 0}, {0, 1, 1, 1, 2, 0, 1, 2, 0},                            \
@@ -14,5 +16,44 @@
 #define E_INK_HEIGHT 720
 #endif
 
+// Delay between two frames [us].
+#define WAVEFORM_FRAME_DELAY 230
+
+// Clear sequence used before every full refresh (white, black, white, black).
+#define WAVEFORM_CLEAR_SEQUENCE                                                                                        \
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_WHITE, 1, WAVEFORM_FRAME_DELAY},                                            \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_BLACK, 11, WAVEFORM_FRAME_DELAY},                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, WAVEFORM_FRAME_DELAY},                                    \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_WHITE, 11, WAVEFORM_FRAME_DELAY},                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, WAVEFORM_FRAME_DELAY},                                    \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_BLACK, 11, WAVEFORM_FRAME_DELAY},                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, WAVEFORM_FRAME_DELAY},                                    \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_WHITE, 11, WAVEFORM_FRAME_DELAY}
+
+// Full refresh in 1 bit mode: only black pixels, then black and white pixels and discharge.
+const struct waveformPhase waveform1BitPhases[] = {
+    WAVEFORM_CLEAR_SEQUENCE,
+    {WAVEFORM_SOURCE_1BIT, WAVEFORM_LUT_BLACK, 3, WAVEFORM_FRAME_DELAY},
+    {WAVEFORM_SOURCE_1BIT, WAVEFORM_LUT_BW, 1, WAVEFORM_FRAME_DELAY},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, WAVEFORM_FRAME_DELAY},
+};
+
+// Full refresh in 3 bit mode: 9 phases of the grayscale waveform, then set panel drivers into HiZ state.
+const struct waveformPhase waveform3BitPhases[] = {
+    WAVEFORM_CLEAR_SEQUENCE,
+    {WAVEFORM_SOURCE_3BIT, 0, 9, WAVEFORM_FRAME_DELAY},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_SKIP, 1, WAVEFORM_FRAME_DELAY},
+};
+
+// Partial update: changed pixels only, then discharge.
+const struct waveformPhase waveformPartialPhases[] = {
+    {WAVEFORM_SOURCE_PARTIAL, 0, 4, WAVEFORM_FRAME_DELAY},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 2, WAVEFORM_FRAME_DELAY},
+};
+
+const struct waveformTable waveformTable1Bit = WAVEFORM_TABLE(waveform1BitPhases, 0);
+const struct waveformTable waveformTable3Bit = WAVEFORM_TABLE(waveform3BitPhases, 0);
+const struct waveformTable waveformTablePartial = WAVEFORM_TABLE(waveformPartialPhases, 0);
+
 #endif
 #endif
\ No newline at end of file
@@ -33,18 +33,23 @@
 class Inkplate;
 
 
-class EPDDriver : public Esp
+class EPDDriver : public Esp, public WaveformEngine
 {
   public:
     void writePixelInternal(int16_t x, int16_t y, uint16_t color);
     int initDriver(Inkplate *_inkplatePtr);
 
     void display(bool _leaveOn = 0);
-    void selectDisplayMode(uint8_t displayMode);
+    bool selectDisplayMode(uint8_t displayMode);
     void clearDisplay();
     uint32_t partialUpdate(bool _forced = false, bool leaveOn = false);
     void setFullUpdateThreshold(uint16_t _numberOfPartialUpdates);
     uint8_t getDisplayMode();
+    // False after a failed selectDisplayMode() left the driver without framebuffers.
+    bool hasFramebuffers()
+    {
+        return _displayMode == 0 ? (DMemoryNew != NULL && _partial != NULL) : DMemory4Bit != NULL;
+    }
 
 
     void setSdCardOk(int16_t s);
@@ -70,17 +75,14 @@ class EPDDriver : public Esp
     RTC rtc;
 
     uint8_t _beginDone = 0;
-    uint8_t _displayMode;
+    uint8_t _displayMode = 0;
 
 
     uint32_t pinLUT[256];
-    uint32_t *GLUT;
-    uint32_t *GLUT2;
-    uint8_t *DMemoryNew;
-    uint8_t *_partial;
-    uint8_t *DMemory4Bit;
-    uint8_t *_pBuffer;
-    uint8_t waveform3Bit[8][9] = WAVEFORM3BIT;
+    uint8_t *DMemoryNew = NULL;
+    uint8_t *_partial = NULL;
+    uint8_t *DMemory4Bit = NULL;
+    uint8_t *_pBuffer = NULL;
     uint16_t _partialUpdateLimiter = 10;
     uint16_t _partialUpdateCounter = 0;
     uint8_t _blockPartial = 1;
@@ -88,9 +90,9 @@ class EPDDriver : public Esp
 
 
   private:
-    void calculateLUTs();
     void pmicBegin();
     uint8_t initializeFramebuffers();
+    void releaseFramebuffers(uint8_t _mode);
     void gpioInit();
     uint8_t readPowerGood();
     void pinsAsOutputs();
@@ -102,6 +104,11 @@ class EPDDriver : public Esp
     void vscan_start();
     void hscan_start(uint32_t _d);
     void vscan_end();
+    void sendLine();
+    volatile uint8_t *getFreeLine();
+    void sendCleanLine(uint8_t _clean);
+    void waitForLines();
+    bool setLineSenderMode(bool _async);
     uint8_t _panelState = 0;
     Inkplate *_inkplate;
 };
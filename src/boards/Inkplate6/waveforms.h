@@ -3,6 +3,8 @@
 
 #ifdef ARDUINO_INKPLATE6V2
 
+#include "../../system/waveformEngine/WaveformEngine.h"
+
 #define WAVEFORM3BIT                                                                                                   \
     {{0, 0, 0, 0, 1, 1, 1, 1, 0}, {0, 0, 0, 1, 1, 1, 1, 0, 0}, {1, 1, 1, 1, 0, 2, 1, 0, 0},                            \
      {1, 1, 1, 2, 2, 1, 1, 0, 0}, {1, 1, 1, 1, 2, 2, 1, 0, 0}, {0, 1, 1, 1, 2, 2, 1, 0, 0},                            \
@@ -11,5 +13,47 @@
 
 #define E_INK_WIDTH  800
 #define E_INK_HEIGHT 600
+
+// Delay between two frames [us].
+#define WAVEFORM_FRAME_DELAY 230
+
+// Clear sequence used before every full refresh (black, white, black, white).
+#define WAVEFORM_CLEAR_SEQUENCE                                                                                        \
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_WHITE, 1, WAVEFORM_FRAME_DELAY},                                            \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_BLACK, 18, WAVEFORM_FRAME_DELAY},                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, WAVEFORM_FRAME_DELAY},                                    \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_WHITE, 18, WAVEFORM_FRAME_DELAY},                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, WAVEFORM_FRAME_DELAY},                                    \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_BLACK, 18, WAVEFORM_FRAME_DELAY},                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, WAVEFORM_FRAME_DELAY},                                    \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_WHITE, 18, WAVEFORM_FRAME_DELAY},                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, WAVEFORM_FRAME_DELAY}
+
+// Full refresh in 1 bit mode: only black pixels, then black and white pixels and discharge.
+const struct waveformPhase waveform1BitPhases[] = {
+    WAVEFORM_CLEAR_SEQUENCE,
+    {WAVEFORM_SOURCE_1BIT, WAVEFORM_LUT_BLACK, 5, WAVEFORM_FRAME_DELAY},
+    {WAVEFORM_SOURCE_1BIT, WAVEFORM_LUT_BW, 1, WAVEFORM_FRAME_DELAY},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, WAVEFORM_FRAME_DELAY},
+};
+
+// Full refresh in 3 bit mode: 9 phases of the grayscale waveform, then set panel drivers into HiZ state.
+const struct waveformPhase waveform3BitPhases[] = {
+    WAVEFORM_CLEAR_SEQUENCE,
+    {WAVEFORM_SOURCE_3BIT, 0, 9, WAVEFORM_FRAME_DELAY},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_SKIP, 1, WAVEFORM_FRAME_DELAY},
+};
+
+// Partial update: changed pixels only, then discharge.
+const struct waveformPhase waveformPartialPhases[] = {
+    {WAVEFORM_SOURCE_PARTIAL, 0, 6, WAVEFORM_FRAME_DELAY},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 2, WAVEFORM_FRAME_DELAY},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_SKIP, 1, WAVEFORM_FRAME_DELAY},
+};
+
+const struct waveformTable waveformTable1Bit = WAVEFORM_TABLE(waveform1BitPhases, 1);
+const struct waveformTable waveformTable3Bit = WAVEFORM_TABLE(waveform3BitPhases, 1);
+const struct waveformTable waveformTablePartial = WAVEFORM_TABLE(waveformPartialPhases, 1);
+
 #endif
 #endif
@@ -58,7 +58,7 @@ class EPDDriver
     IOExpander externalIO;
 
     uint8_t _beginDone = 0;
-    uint8_t _displayMode;
+    uint8_t _displayMode = 0;
 
     uint8_t *DMemory4Bit;
 
@@ -0,0 +1,202 @@
+/**
+ **************************************************
+ *
+ * @file        Inkplate6COLORFramebuffer.cpp
+ * @brief       Pixel writes and the LVGL flush callback of the Inkplate 6COLOR. Nothing here touches the
+ *              hardware, so the host simulator (extras/simulator) builds it with its mock EPD driver.
+ *
+ * @copyright   GNU General Public License v3.0
+ * @authors     Soldered
+ ***************************************************/
+
+#ifdef ARDUINO_INKPLATECOLOR
+#include "Inkplate-LVGL.h"
+
+/**
+ *
+ * @brief       writePixelInternal funtion sets pixel data for (x, y) pixel position
+ *
+ * @param       int16_t x0
+ *              default position for x, will be changed depending on rotation
+ * @param       int16_t y0
+ *              default position for y, will be changed depending on rotation
+ * @param       uint16_t color
+ *              pixel color, in 3bit mode have values in range 0-7
+ *
+ * @note        If x0 or y0 are out of inkplate screen borders, function will
+ * exit.
+ */
+void EPDDriver::writePixelInternal(int16_t x, int16_t y, uint16_t color)
+{
+    int16_t x0 = x;
+    int16_t y0 = y;
+    if (x0 > E_INK_WIDTH - 1 || y0 > E_INK_HEIGHT - 1 || x0 < 0 || y0 < 0)
+        return;
+    if (color > 6)
+        return;
+
+    switch (_inkplate->getRotation())
+    {
+    case 3:
+        _swap_int16_t(x0, y0);
+        x0 = E_INK_HEIGHT - x0 - 1;
+        break;
+    case 0:
+        x0 = E_INK_WIDTH - x0 - 1;
+        y0 = E_INK_HEIGHT - y0 - 1;
+        break;
+    case 1:
+        _swap_int16_t(x0, y0);
+        y0 = E_INK_WIDTH - y0 - 1;
+        break;
+    }
+
+    int _x = x0 / 2;
+    int _x_sub = x0 % 2;
+    uint8_t temp;
+    temp = *(DMemory4Bit + E_INK_WIDTH / 2 * y0 + _x);
+    *(DMemory4Bit + E_INK_WIDTH / 2 * y0 + _x) = (pixelMaskGLUT[_x_sub] & temp) | (_x_sub ? color : color << 4);
+}
+
+
+/**
+ * @brief       display_flush_callback function is called whenever there is a change made on the current
+ *              LVGL screen. The data is downscaled to a 3-bit color palette from RGB565
+ *              and stored in the EPD buffer for rendering
+ *
+ * @param       lv_display_t *disp
+ *              A pointer to the created LVGL display instance
+ *
+ * @param       lv_area_t *area
+ *              A pointer to the area of the display which has changed
+ *
+ * @param       uint8_t px_map
+ *              An array of pixel values in L8 format
+ *
+ */
+void IRAM_ATTR display_flush_callback(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    PROFILER_SCOPE("flush");
+
+    Inkplate *self = (Inkplate *)lv_display_get_user_data(disp);
+
+    int32_t w = lv_area_get_width(area);
+    int32_t h = lv_area_get_height(area);
+
+    // Validate input and boundaries
+    if (w <= 0 || h <= 0 || px_map == NULL || area->x1 < 0 || area->y1 < 0 || area->x2 >= E_INK_WIDTH ||
+        area->y2 >= E_INK_HEIGHT)
+    {
+        lv_display_flush_ready(disp);
+        return;
+    }
+    if (self->ditherEnabled && self->_renderMode == LV_DISP_RENDER_MODE_FULL)
+    {
+        self->dither.ditherFramebuffer(px_map, E_INK_WIDTH, E_INK_HEIGHT);
+    }
+    else
+    {
+        // Framebuffer and constants
+        uint8_t *buffer3b = self->DMemory4Bit;
+        const int width_bytes_3b = E_INK_WIDTH / 2;
+        const uint8_t *maskGLUT = pixelMaskGLUT;
+
+        const uint8_t *src8 = px_map; // Source image in RGB565 (2 bytes per pixel)
+
+        uint8_t R, G, B;
+
+        for (int32_t y = 0; y < h; y++)
+        {
+            const uint8_t *src_row = src8 + (y * w * 2);
+
+            for (int32_t x = 0; x < w; x++)
+            {
+                uint8_t lo = src_row[2 * x + 0];
+                uint8_t hi = src_row[2 * x + 1];
+                uint16_t pixel = (uint16_t)hi << 8 | lo;
+
+                // Extract 5-6-5 bits and scale to 0–255 range
+                uint8_t r5 = (pixel >> 11) & 0x1F;
+                uint8_t g6 = (pixel >> 5) & 0x3F;
+                uint8_t b5 = pixel & 0x1F;
+
+                R = (r5 * 527 + 23) >> 6;
+                G = (g6 * 259 + 33) >> 6;
+                B = (b5 * 527 + 23) >> 6;
+
+                // Convert to HSV
+                float rf = R / 255.0f;
+                float gf = G / 255.0f;
+                float bf = B / 255.0f;
+
+                float maxc = max(rf, max(gf, bf));
+                float minc = min(rf, min(gf, bf));
+                float delta = maxc - minc;
+
+                float H = 0.0f; // hue 0–360
+                float S = (maxc == 0) ? 0 : (delta / maxc);
+                float V = maxc;
+
+                // Compute hue
+                if (delta > 0.0001f)
+                {
+                    if (maxc == rf)
+                        H = 60.0f * fmod(((gf - bf) / delta), 6.0f);
+                    else if (maxc == gf)
+                        H = 60.0f * (((bf - rf) / delta) + 2.0f);
+                    else
+                        H = 60.0f * (((rf - gf) / delta) + 4.0f);
+                }
+                if (H < 0)
+                    H += 360.0f;
+
+                // Classification
+                uint8_t color;
+
+                if (S < 0.12f)
+                {
+                    if (V < 0.20f)
+                        color = INKPLATE_BLACK;
+                    else if (V > 0.85f)
+                        color = INKPLATE_WHITE;
+                    else
+                        color = INKPLATE_YELLOW;
+                }
+                else
+                {
+                    if (H >= 190 && H < 260)
+                        color = INKPLATE_BLUE;
+                    else if (H >= 90 && H < 150)
+                        color = INKPLATE_GREEN;
+                    else if (H >= 15 && H < 45)
+                        color = INKPLATE_ORANGE;
+                    else if (H >= 45 && H < 90)
+                        color = INKPLATE_YELLOW;
+                    else
+                        color = INKPLATE_RED;
+                }
+
+
+                // Apply 180° flip (Inkplate coordinate convention)
+                int32_t sx = area->x1 + x;
+                int32_t sy = area->y1 + y;
+                int32_t fx = E_INK_WIDTH - sx - 1;
+                int32_t fy = E_INK_HEIGHT - sy - 1;
+
+                // Write pixel to 3-bit framebuffer (4-bit packed)
+                int x_byte = fx / 2;
+                int x_sub = fx % 2;
+                uint8_t *dst_row = buffer3b + (width_bytes_3b * fy);
+
+                uint8_t prev = dst_row[x_byte];
+                uint8_t newv = (maskGLUT[x_sub] & prev) | (x_sub ? color : (color << 4));
+
+                dst_row[x_byte] = newv;
+            }
+        }
+    }
+
+    lv_display_flush_ready(disp);
+}
+
+#endif
@@ -3,6 +3,8 @@
 
 #ifdef ARDUINO_INKPLATE6FLICK
 
+#include "../../system/waveformEngine/WaveformEngine.h"
+
 #define WAVEFORM3BIT                                                                                                   \
     {{0, 0, 0, 0, 0, 1, 1, 1, 0}, {0, 0, 1, 2, 1, 1, 2, 1, 0}, {0, 1, 1, 2, 1, 1, 1, 2, 0},                            \
      {1, 1, 1, 2, 2, 1, 1, 2, 0}, {1, 1, 1, 2, 1, 2, 1, 2, 0}, {0, 1, 1, 2, 1, 2, 1, 2, 0},                            \
@@ -11,5 +13,46 @@
 
 #define E_INK_WIDTH  1024
 #define E_INK_HEIGHT 758
+
+// Delay between two frames [us]. Most of the phases on this panel are sent without any delay.
+#define WAVEFORM_FRAME_DELAY 230
+
+// Clear sequence used before every full refresh (white, black, white, black).
+#define WAVEFORM_CLEAR_SEQUENCE                                                                                        \
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_WHITE, 5, 0},                                                               \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_BLACK, 15, 0},                                                          \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, 0},                                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_WHITE, 15, 0},                                                          \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, 0},                                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_BLACK, 15, 0},                                                          \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, 0},                                                       \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_WHITE, 15, 0},                                                          \
+        {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, 0}
+
+// Full refresh in 1 bit mode: only black pixels, then black and white pixels and discharge.
+const struct waveformPhase waveform1BitPhases[] = {
+    WAVEFORM_CLEAR_SEQUENCE,
+    {WAVEFORM_SOURCE_1BIT, WAVEFORM_LUT_BLACK, 4, 0},
+    {WAVEFORM_SOURCE_1BIT, WAVEFORM_LUT_BW, 1, WAVEFORM_FRAME_DELAY},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 1, 0},
+};
+
+// Full refresh in 3 bit mode: 9 phases of the grayscale waveform, then set panel drivers into HiZ state.
+const struct waveformPhase waveform3BitPhases[] = {
+    WAVEFORM_CLEAR_SEQUENCE,
+    {WAVEFORM_SOURCE_3BIT, 0, 9, 0},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_SKIP, 1, 0},
+};
+
+// Partial update: changed pixels only, then discharge.
+const struct waveformPhase waveformPartialPhases[] = {
+    {WAVEFORM_SOURCE_PARTIAL, 0, 5, 0},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_DISCHARGE, 2, 0},
+    {WAVEFORM_SOURCE_CLEAN, WAVEFORM_CLEAN_SKIP, 1, 0},
+};
+
+const struct waveformTable waveformTable1Bit = WAVEFORM_TABLE(waveform1BitPhases, 0);
+const struct waveformTable waveformTable3Bit = WAVEFORM_TABLE(waveform3BitPhases, 0);
+const struct waveformTable waveformTablePartial = WAVEFORM_TABLE(waveformPartialPhases, 1);
 #endif
 #endif
@@ -141,6 +141,30 @@ bool FatFile::contiguousRange(uint32_t *bgnBlock, uint32_t *endBlock)
         }
     }
 
+fail:
+    return false;
+}
+//------------------------------------------------------------------------------
+bool FatFile::clusterRun(uint32_t *cluster, uint32_t *count)
+{
+    uint32_t c = *cluster;
+    uint32_t next;
+    int8_t fg;
+
+    *count = 1;
+    while ((fg = m_vol->fatGet(c, &next)) > 0 && next == c + 1)
+    {
+        c = next;
+        (*count)++;
+    }
+    if (fg < 0)
+    {
+        DBG_FAIL_MACRO;
+        goto fail;
+    }
+    *cluster = fg ? next : 0;
+    return true;
+
 fail:
     return false;
 }
@@ -955,14 +979,26 @@ int FatFile::read(void *buf, size_t nbyte)
             size_t nb = toRead >> 9;
             if (!isRootFixed())
             {
-                uint8_t mb = m_vol->blocksPerCluster() - blockOfCluster;
+                uint32_t mb = m_vol->blocksPerCluster() - blockOfCluster;
+                // Clusters that follow each other on the card are read with the same multi-block command,
+                // m_curCluster ends at the cluster of the last block read.
+                while (mb < nb)
+                {
+                    uint32_t next;
+                    if (m_vol->fatGet(m_curCluster, &next) <= 0 || next != m_curCluster + 1)
+                    {
+                        break;
+                    }
+                    m_curCluster = next;
+                    mb += m_vol->blocksPerCluster();
+                }
                 if (mb < nb)
                 {
                     nb = mb;
                 }
             }
             n = 512 * nb;
-            if (m_vol->cacheBlockNumber() <= block && block < (m_vol->cacheBlockNumber() + nb))
+            if (block <= m_vol->cacheBlockNumber() && m_vol->cacheBlockNumber() < block + nb)
             {
                 // flush cache if a block is in the cache
                 if (!m_vol->cacheSyncData())
@@ -1414,6 +1450,22 @@ fail:
     return false;
 }
 //------------------------------------------------------------------------------
+bool FatFile::seekSetCluster(uint32_t pos, uint32_t cluster)
+{
+    // error if not an open file or past end of file
+    if (!isFile() || pos > m_fileSize)
+    {
+        DBG_FAIL_MACRO;
+        goto fail;
+    }
+    m_curCluster = pos ? cluster : 0;
+    m_curPosition = pos;
+    return true;
+
+fail:
+    return false;
+}
+//------------------------------------------------------------------------------
 void FatFile::setpos(FatPos_t *pos)
 {
     m_curPosition = pos->position;
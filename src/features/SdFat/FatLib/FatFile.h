@@ -230,6 +230,16 @@ class FatFile
      * the value false is returned for failure.
      */
     bool close();
+    /** Find the end of a run of physically contiguous clusters of the file.
+     *
+     * \param[in,out] cluster First cluster of the run, on return the first
+     * cluster of the next run or zero at the end of the cluster chain.
+     * \param[out] count Number of clusters in the run.
+     *
+     * \return The value true is returned for success and
+     * the value false is returned for failure.
+     */
+    bool clusterRun(uint32_t *cluster, uint32_t *count);
     /** Check for contiguous file and return its raw block range.
      *
      * \param[out] bgnBlock the first block address for the file.
@@ -875,6 +885,18 @@ class FatFile
      * the value false is returned for failure.
      */
     bool seekSet(uint32_t pos);
+    /** Sets a file's position when the cluster of the position is already
+     * known (from a map of the clusters made with clusterRun()), the cluster
+     * chain is not followed.
+     *
+     * \param[in] pos The new position in bytes from the beginning of the file.
+     * \param[in] cluster Cluster that holds the byte at pos - 1, ignored for
+     * pos zero.
+     *
+     * \return The value true is returned for success and
+     * the value false is returned for failure.
+     */
+    bool seekSetCluster(uint32_t pos, uint32_t cluster);
     /** Set the current working directory.
      *
      * \param[in] dir New current working directory.
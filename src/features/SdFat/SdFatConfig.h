@@ -70,14 +70,37 @@
  */
 #define ENABLE_EXTENDED_TRANSFER_CLASS 0
 //------------------------------------------------------------------------------
+/**
+ * SD_SPI_ESP32_DMA is nonzero if the ESP32 SPI DMA driver (SpiDriver/SdSpiESP32.cpp)
+ * is used. It is written for Arduino core 2.x (ESP-IDF 4.x): it uses the
+ * private SPI DMA API of IDF 4.x and the spi_t of the core's SPI HAL. Other
+ * cores use the SPI library driver.
+ */
+#if defined(ESP32)
+#include "esp_idf_version.h"
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
+#define SD_SPI_ESP32_DMA 1
+#endif // ESP_IDF_VERSION
+#endif // defined(ESP32)
+#ifndef SD_SPI_ESP32_DMA
+#define SD_SPI_ESP32_DMA 0
+#endif // SD_SPI_ESP32_DMA
+//------------------------------------------------------------------------------
 /**
  * If the symbol USE_STANDARD_SPI_LIBRARY is zero, an optimized custom SPI
  * driver is used if it exists.  If the symbol USE_STANDARD_SPI_LIBRARY is
  * one, the standard Arduino SPI.h library is used with SPI. If the symbol
  * USE_STANDARD_SPI_LIBRARY is two, the SPI port can be selected with the
  * constructors SdFat(SPIClass* spiPort) and SdFatEX(SPIClass* spiPort).
+ *
+ * ESP32 uses its custom driver (block transfers with SPI DMA) if
+ * SD_SPI_ESP32_DMA is nonzero, the SPI port can still be selected.
  */
+#if SD_SPI_ESP32_DMA
+#define USE_STANDARD_SPI_LIBRARY 0
+#else // SD_SPI_ESP32_DMA
 #define USE_STANDARD_SPI_LIBRARY 2
+#endif // SD_SPI_ESP32_DMA
 //------------------------------------------------------------------------------
 /**
  * If the symbol ENABLE_SOFTWARE_SPI_CLASS is nonzero, the class SdFatSoftSpi
@@ -211,7 +234,7 @@
 /**
  * Determine the default SPI configuration.
  */
-#if defined(__STM32F1__) || defined(__STM32F4__) || defined(PLATFORM_ID)
+#if defined(__STM32F1__) || defined(__STM32F4__) || defined(PLATFORM_ID) || SD_SPI_ESP32_DMA
 // has multiple SPI ports
 #define SD_HAS_CUSTOM_SPI 2
 #elif defined(__AVR__) || defined(__SAM3X8E__) || defined(__SAM3X8H__) ||                                              \
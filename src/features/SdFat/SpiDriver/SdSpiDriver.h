@@ -32,6 +32,10 @@
 #include "SPI.h"
 #include "SdSpiBaseDriver.h"
 #include <Arduino.h>
+#if SD_SPI_ESP32_DMA
+#include "rom/lldesc.h"
+#include "soc/spi_struct.h"
+#endif // SD_SPI_ESP32_DMA
 //------------------------------------------------------------------------------
 /** SDCARD_SPI is defined if board has built-in SD card socket */
 #ifndef SDCARD_SPI
@@ -294,6 +298,16 @@ class SdSpiAltDriver
 #else  // IMPLEMENT_SPI_PORT_SELECTION
   private:
 #endif // IMPLEMENT_SPI_PORT_SELECTION
+#if SD_SPI_ESP32_DMA
+    void dmaBegin();
+    void dmaTransfer(const uint8_t *txBuf, uint8_t *rxBuf, size_t n);
+    /** SPI registers of the port, nullptr if DMA is not available. */
+    spi_dev_t *m_dev = nullptr;
+    lldesc_t *m_txDesc = nullptr;
+    lldesc_t *m_rxDesc = nullptr;
+    /** DMA capable copy of buffers the DMA can't reach (PSRAM, flash). */
+    uint8_t *m_bounce = nullptr;
+#endif // SD_SPI_ESP32_DMA
     SPISettings m_spiSettings;
     uint8_t m_csPin;
 };
@@ -0,0 +1,267 @@
+/**
+ **************************************************
+ * @file        SdSpiESP32.cpp
+ * @brief       SPI driver of SdFat for the ESP32. Commands and short transfers go through the SPI data registers
+ *              of the Arduino SPI library, data blocks are sent and received with the SPI DMA. The port is set up
+ *              (pins, clock, mode) by SPIClass, only the transfers use the registers directly.
+ *
+ *              Released under the MIT License, same as the rest of SdFat.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#if defined(ESP32)
+#include "SdSpiDriver.h"
+#if SD_SPI_ESP32_DMA
+#include "../../../system/memoryStats/MemoryStats.h"
+#include "driver/spi_common_internal.h"
+#include "soc/soc_memory_layout.h"
+
+// Shorter transfers are done through the 64 byte data registers, starting the DMA costs more than it saves.
+#define SD_DMA_MIN_TRANSFER 64
+
+// Longest transfer of one DMA descriptor (4095 bytes rounded down to whole words).
+#define SD_DMA_MAX_TRANSFER 4092
+
+// Size of the bounce buffer, one data block.
+#define SD_DMA_BOUNCE_SIZE 512
+
+/**
+ * @brief       dmaCapable checks if the SPI DMA can read and write a buffer directly: it must be in internal RAM
+ *              (ESP32 SPI DMA can't reach PSRAM or flash) and be whole words.
+ *
+ * @param       const void *buf
+ *              Buffer.
+ * @param       size_t n
+ *              Size of the buffer.
+ *
+ * @return      True if the buffer can be used by the DMA.
+ */
+static inline bool dmaCapable(const void *buf, size_t n)
+{
+    return esp_ptr_dma_capable(buf) && !(reinterpret_cast<uintptr_t>(buf) & 0X3) && !(n & 0X3);
+}
+//------------------------------------------------------------------------------
+/** Initialize the SPI bus.
+ *
+ * \param[in] csPin SD card chip select pin.
+ */
+void SdSpiAltDriver::begin(uint8_t csPin)
+{
+    m_csPin = csPin;
+    pinMode(m_csPin, OUTPUT);
+    digitalWrite(m_csPin, HIGH);
+    m_spi->begin();
+    if (m_dev == nullptr)
+    {
+        dmaBegin();
+    }
+}
+//------------------------------------------------------------------------------
+/** Set SPI options for access to SD/SDHC cards.
+ *
+ */
+void SdSpiAltDriver::activate()
+{
+    m_spi->beginTransaction(m_spiSettings);
+}
+//------------------------------------------------------------------------------
+void SdSpiAltDriver::deactivate()
+{
+    m_spi->endTransaction();
+}
+//------------------------------------------------------------------------------
+/** Receive a byte.
+ *
+ * \return The byte.
+ */
+uint8_t SdSpiAltDriver::receive()
+{
+    return m_spi->transfer(0XFF);
+}
+//------------------------------------------------------------------------------
+/** Receive multiple bytes.
+ *
+ * \param[out] buf Buffer to receive the data.
+ * \param[in] n Number of bytes to receive.
+ *
+ * \return Zero for no error or nonzero error code.
+ */
+uint8_t SdSpiAltDriver::receive(uint8_t *buf, size_t n)
+{
+    // The card must see 0XFF on MOSI while it sends, the buffer is sent and received at the same time.
+    if (m_dev == nullptr || n < SD_DMA_MIN_TRANSFER)
+    {
+        memset(buf, 0XFF, n);
+        m_spi->transferBytes(buf, buf, n);
+        return 0;
+    }
+
+    while (n)
+    {
+        size_t len = n < SD_DMA_MAX_TRANSFER ? n : SD_DMA_MAX_TRANSFER;
+        if (dmaCapable(buf, len))
+        {
+            memset(buf, 0XFF, len);
+            dmaTransfer(buf, buf, len);
+        }
+        else
+        {
+            len = len < SD_DMA_BOUNCE_SIZE ? len : SD_DMA_BOUNCE_SIZE;
+            memset(m_bounce, 0XFF, len);
+            dmaTransfer(m_bounce, m_bounce, len);
+            memcpy(buf, m_bounce, len);
+        }
+        buf += len;
+        n -= len;
+    }
+    return 0;
+}
+//------------------------------------------------------------------------------
+/** Send a byte.
+ *
+ * \param[in] b Byte to send
+ */
+void SdSpiAltDriver::send(uint8_t b)
+{
+    m_spi->transfer(b);
+}
+//------------------------------------------------------------------------------
+/** Send multiple bytes.
+ *
+ * \param[in] buf Buffer for data to be sent.
+ * \param[in] n Number of bytes to send.
+ */
+void SdSpiAltDriver::send(const uint8_t *buf, size_t n)
+{
+    if (m_dev == nullptr || n < SD_DMA_MIN_TRANSFER)
+    {
+        m_spi->writeBytes(buf, n);
+        return;
+    }
+
+    while (n)
+    {
+        size_t len = n < SD_DMA_MAX_TRANSFER ? n : SD_DMA_MAX_TRANSFER;
+        if (dmaCapable(buf, len))
+        {
+            dmaTransfer(buf, nullptr, len);
+        }
+        else
+        {
+            len = len < SD_DMA_BOUNCE_SIZE ? len : SD_DMA_BOUNCE_SIZE;
+            memcpy(m_bounce, buf, len);
+            dmaTransfer(m_bounce, nullptr, len);
+        }
+        buf += len;
+        n -= len;
+    }
+}
+//------------------------------------------------------------------------------
+/** Get a DMA channel for the SPI port of SPIClass. If there is none (or no
+ * memory for the descriptors), all transfers use the data registers.
+ */
+void SdSpiAltDriver::dmaBegin()
+{
+    if (m_spi->bus() == nullptr)
+    {
+        return;
+    }
+    // The default port is VSPI. SPIClass doesn't tell the port of the others, spi_t of the core 2.x SPI HAL
+    // (SD_SPI_ESP32_DMA) starts with the pointer to the registers of the port.
+    spi_dev_t *dev = m_spi == &SPI ? &SPI3 : *reinterpret_cast<spi_dev_t **>(m_spi->bus());
+    spi_host_device_t host;
+    if (dev == &SPI2)
+    {
+        host = SPI2_HOST;
+    }
+    else if (dev == &SPI3)
+    {
+        host = SPI3_HOST;
+    }
+    else
+    {
+        // SPI0 and SPI1 are the flash and PSRAM bus.
+        return;
+    }
+
+    m_txDesc = (lldesc_t *)trackedMalloc(MEMORY_TAG_DRIVER, 2 * sizeof(lldesc_t), MALLOC_CAP_DMA);
+    m_bounce = (uint8_t *)trackedMalloc(MEMORY_TAG_DRIVER, SD_DMA_BOUNCE_SIZE, MALLOC_CAP_DMA);
+    uint32_t txChannel, rxChannel;
+    if (m_txDesc == nullptr || m_bounce == nullptr ||
+        spicommon_dma_chan_alloc(host, SPI_DMA_CH_AUTO, &txChannel, &rxChannel) != ESP_OK)
+    {
+        trackedFree(MEMORY_TAG_DRIVER, m_txDesc, 2 * sizeof(lldesc_t));
+        trackedFree(MEMORY_TAG_DRIVER, m_bounce, SD_DMA_BOUNCE_SIZE);
+        m_txDesc = nullptr;
+        m_bounce = nullptr;
+        return;
+    }
+    m_rxDesc = m_txDesc + 1;
+
+    dev->dma_conf.out_data_burst_en = 1;
+    dev->dma_conf.indscr_burst_en = 1;
+    dev->dma_conf.outdscr_burst_en = 1;
+    m_dev = dev;
+}
+//------------------------------------------------------------------------------
+/** Send and receive one DMA transfer and wait for its end. Called inside
+ * activate()/deactivate(), the port is locked and configured by SPIClass.
+ *
+ * \param[in] txBuf Data to be sent, DMA capable.
+ * \param[out] rxBuf Buffer for the received data, DMA capable, nullptr to
+ * only send.
+ * \param[in] n Number of bytes, at most SD_DMA_MAX_TRANSFER.
+ */
+void SdSpiAltDriver::dmaTransfer(const uint8_t *txBuf, uint8_t *rxBuf, size_t n)
+{
+    // Reset the DMA state left from the previous transfer.
+    m_dev->dma_conf.out_rst = 1;
+    m_dev->dma_conf.in_rst = 1;
+    m_dev->dma_conf.ahbm_fifo_rst = 1;
+    m_dev->dma_conf.ahbm_rst = 1;
+    m_dev->dma_conf.out_rst = 0;
+    m_dev->dma_conf.in_rst = 0;
+    m_dev->dma_conf.ahbm_fifo_rst = 0;
+    m_dev->dma_conf.ahbm_rst = 0;
+
+    m_txDesc->size = (n + 3) & ~3;
+    m_txDesc->length = n;
+    m_txDesc->sosf = 0;
+    m_txDesc->owner = 1;
+    m_txDesc->qe.stqe_next = 0;
+    m_txDesc->eof = 1;
+    m_txDesc->buf = const_cast<uint8_t *>(txBuf);
+    m_txDesc->offset = 0;
+
+    m_dev->mosi_dlen.usr_mosi_dbitlen = n * 8 - 1;
+    m_dev->user.usr_mosi = 1;
+    m_dev->user.usr_miso = rxBuf != nullptr;
+    if (rxBuf != nullptr)
+    {
+        // RX DMA writes whole words.
+        m_rxDesc->size = (n + 3) & ~3;
+        m_rxDesc->length = (n + 3) & ~3;
+        m_rxDesc->sosf = 0;
+        m_rxDesc->owner = 1;
+        m_rxDesc->qe.stqe_next = 0;
+        m_rxDesc->eof = 1;
+        m_rxDesc->buf = rxBuf;
+        m_rxDesc->offset = 0;
+        m_dev->miso_dlen.usr_miso_dbitlen = n * 8 - 1;
+        m_dev->dma_in_link.addr = reinterpret_cast<uint32_t>(m_rxDesc) & 0XFFFFF;
+        m_dev->dma_in_link.start = 1;
+    }
+    m_dev->dma_out_link.addr = reinterpret_cast<uint32_t>(m_txDesc) & 0XFFFFF;
+    m_dev->dma_out_link.start = 1;
+
+    m_dev->cmd.usr = 1;
+    while (m_dev->cmd.usr)
+    {
+    }
+
+    // Byte transfers of SPIClass read MISO too.
+    m_dev->user.usr_miso = 1;
+}
+#endif // SD_SPI_ESP32_DMA
+#endif // defined(ESP32)
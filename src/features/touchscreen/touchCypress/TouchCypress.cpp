@@ -31,6 +31,9 @@ static void IRAM_ATTR tsInt()
 
     // On interrupt event set flag to true.
     _tsFlag = true;
+
+    // Let the LVGL service read the touch now (does nothing if the service is not running).
+    LvglService::wakeFromISR();
 }
 
 /**
@@ -17,8 +17,8 @@ void DitherAlgorithm::begin(uint16_t *palette, uint8_t *paletteIndices, uint8_t
 {
     palette_size = paletteSize;
 
-    _palette = (uint16_t *)ps_malloc(palette_size * sizeof(uint16_t));
-    _paletteIndices = (uint8_t *)ps_malloc(palette_size * sizeof(uint8_t));
+    _palette = (uint16_t *)trackedMalloc(MEMORY_TAG_DITHER, palette_size * sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+    _paletteIndices = (uint8_t *)trackedMalloc(MEMORY_TAG_DITHER, palette_size * sizeof(uint8_t), MALLOC_CAP_SPIRAM);
     _inkplate = inkplatePtr;
 
 
@@ -27,6 +27,18 @@ void DitherAlgorithm::begin(uint16_t *palette, uint8_t *paletteIndices, uint8_t
 }
 
 
+/**
+ * @brief       setMemoryCaps selects where the error diffusion rows are allocated.
+ *
+ * @param       uint32_t caps
+ *              Memory capabilities (MALLOC_CAP_xxx), rows are in PSRAM by default.
+ */
+void DitherAlgorithm::setMemoryCaps(uint32_t caps)
+{
+    _rowCaps = caps;
+}
+
+
 // ------------------
 // 1. Classic weighted RGB distance (original)
 // ------------------
@@ -94,7 +106,6 @@ RGBTRIPLE DitherAlgorithm::map_pixel_fast(int _r, int _g, int _b)
 
         // lower is better
         int brightnessErr = abs(srcY - palY);
-        int satDiff = srcSat - palSat; // we like palSat close to or above srcSat
 
         bool better = false;
 
@@ -209,7 +220,6 @@ RGBTRIPLE DitherAlgorithm::map_pixel_HSV(int _r, int _g, int _b, uint16_t *palet
 
     for (uint8_t j = 0; j < palette_size; j++)
     {
-        RGBTRIPLE palRgb;
         int _palr = (palette[j] >> 11) & 0x1F;
         int _palg = (palette[j] >> 5) & 0x3F;
         int _palb = palette[j] & 0x1F;
@@ -242,9 +252,10 @@ uint8_t DitherAlgorithm::clampValue(int32_t _value, int32_t _min, int32_t _max)
 
 void DitherAlgorithm::ditherFramebuffer(uint8_t *frameBuffer, int width, int height)
 {
+    PROFILER_SCOPE("ditherFramebuffer");
 
     // Allocate a 2D array for pixels
-    RGBTRIPLE **pixels = (RGBTRIPLE **)ps_malloc(height * sizeof(RGBTRIPLE *));
+    RGBTRIPLE **pixels = (RGBTRIPLE **)trackedMalloc(MEMORY_TAG_DITHER, height * sizeof(RGBTRIPLE *), MALLOC_CAP_SPIRAM);
     if (!pixels)
     {
         return;
@@ -252,12 +263,12 @@ void DitherAlgorithm::ditherFramebuffer(uint8_t *frameBuffer, int width, int hei
 
     for (int y = 0; y < height; y++)
     {
-        pixels[y] = (RGBTRIPLE *)ps_malloc(width * sizeof(RGBTRIPLE));
+        pixels[y] = (RGBTRIPLE *)trackedMalloc(MEMORY_TAG_DITHER, width * sizeof(RGBTRIPLE), MALLOC_CAP_SPIRAM);
         if (!pixels[y])
         {
             for (int i = 0; i < y; i++)
-                free(pixels[i]);
-            free(pixels);
+                trackedFree(MEMORY_TAG_DITHER, pixels[i], width * sizeof(RGBTRIPLE));
+            trackedFree(MEMORY_TAG_DITHER, pixels, height * sizeof(RGBTRIPLE *));
             return;
         }
     }
@@ -287,22 +298,36 @@ void DitherAlgorithm::ditherFramebuffer(uint8_t *frameBuffer, int width, int hei
 
     // Prepare dithering
     // int16_t errCurrR[width];
-    int16_t *errCurrR = (int16_t *)ps_malloc(width * sizeof(int16_t));
+    int16_t *errCurrR = (int16_t *)trackedMalloc(MEMORY_TAG_DITHER, width * sizeof(int16_t), _rowCaps);
     // int16_t errCurrG[width];
-    int16_t *errCurrG = (int16_t *)ps_malloc(width * sizeof(int16_t));
+    int16_t *errCurrG = (int16_t *)trackedMalloc(MEMORY_TAG_DITHER, width * sizeof(int16_t), _rowCaps);
     // int16_t errCurrB[width];
-    int16_t *errCurrB = (int16_t *)ps_malloc(width * sizeof(int16_t));
+    int16_t *errCurrB = (int16_t *)trackedMalloc(MEMORY_TAG_DITHER, width * sizeof(int16_t), _rowCaps);
 
     // int16_t errNextR[width];
     // int16_t errNextG[width];
     // int16_t errNextB[width];
 
-    int16_t *errNextR = (int16_t *)ps_malloc(width * sizeof(int16_t));
+    int16_t *errNextR = (int16_t *)trackedMalloc(MEMORY_TAG_DITHER, width * sizeof(int16_t), _rowCaps);
     // int16_t errCurrG[width];
-    int16_t *errNextG = (int16_t *)ps_malloc(width * sizeof(int16_t));
+    int16_t *errNextG = (int16_t *)trackedMalloc(MEMORY_TAG_DITHER, width * sizeof(int16_t), _rowCaps);
     // int16_t errCurrB[width];
-    int16_t *errNextB = (int16_t *)ps_malloc(width * sizeof(int16_t));
+    int16_t *errNextB = (int16_t *)trackedMalloc(MEMORY_TAG_DITHER, width * sizeof(int16_t), _rowCaps);
 
+    if (!errCurrR || !errCurrG || !errCurrB || !errNextR || !errNextG || !errNextB)
+    {
+        // trackedFree() skips the rows that weren't allocated.
+        trackedFree(MEMORY_TAG_DITHER, errCurrR, width * sizeof(int16_t));
+        trackedFree(MEMORY_TAG_DITHER, errCurrG, width * sizeof(int16_t));
+        trackedFree(MEMORY_TAG_DITHER, errCurrB, width * sizeof(int16_t));
+        trackedFree(MEMORY_TAG_DITHER, errNextR, width * sizeof(int16_t));
+        trackedFree(MEMORY_TAG_DITHER, errNextG, width * sizeof(int16_t));
+        trackedFree(MEMORY_TAG_DITHER, errNextB, width * sizeof(int16_t));
+        for (int y = 0; y < height; y++)
+            trackedFree(MEMORY_TAG_DITHER, pixels[y], width * sizeof(RGBTRIPLE));
+        trackedFree(MEMORY_TAG_DITHER, pixels, height * sizeof(RGBTRIPLE *));
+        return;
+    }
 
     memset(errCurrR, 0, width * sizeof(int16_t));
     memset(errCurrG, 0, width * sizeof(int16_t));
@@ -402,9 +427,16 @@ void DitherAlgorithm::ditherFramebuffer(uint8_t *frameBuffer, int width, int hei
 
     for (int y = 0; y < height; y++)
     {
-        free(pixels[y]);
+        trackedFree(MEMORY_TAG_DITHER, pixels[y], width * sizeof(RGBTRIPLE));
     }
-    free(pixels);
+    trackedFree(MEMORY_TAG_DITHER, pixels, height * sizeof(RGBTRIPLE *));
+
+    trackedFree(MEMORY_TAG_DITHER, errCurrR, width * sizeof(int16_t));
+    trackedFree(MEMORY_TAG_DITHER, errCurrG, width * sizeof(int16_t));
+    trackedFree(MEMORY_TAG_DITHER, errCurrB, width * sizeof(int16_t));
+    trackedFree(MEMORY_TAG_DITHER, errNextR, width * sizeof(int16_t));
+    trackedFree(MEMORY_TAG_DITHER, errNextG, width * sizeof(int16_t));
+    trackedFree(MEMORY_TAG_DITHER, errNextB, width * sizeof(int16_t));
     return;
 }
 
@@ -8,6 +8,7 @@
 #include <string.h>
 #include <math.h>
 #include <float.h>
+#include "esp_heap_caps.h"
 
 class Inkplate;
 
@@ -23,7 +24,10 @@ class DitherAlgorithm
     void ditherFramebuffer(uint8_t *frameBuffer, int width, int height);
     void begin(uint16_t *palette, uint8_t *paletteIndices, uint8_t paletteSize, Inkplate *inkplatePtr);
 
+    void setMemoryCaps(uint32_t caps);
+
   private:
+    uint32_t _rowCaps = MALLOC_CAP_SPIRAM;
     uint8_t color_index;
     Inkplate *_inkplate;
     uint8_t palette_size;
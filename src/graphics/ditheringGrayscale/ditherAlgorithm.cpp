@@ -10,17 +10,35 @@ void DitherAlgorithm::begin(Inkplate *inkplatePtr)
 }
 
 
+/**
+ * @brief       setMemoryCaps selects where the error diffusion rows are allocated.
+ *
+ * @param       uint32_t caps
+ *              Memory capabilities (MALLOC_CAP_xxx), rows are in PSRAM by default.
+ */
+void DitherAlgorithm::setMemoryCaps(uint32_t caps)
+{
+    _rowCaps = caps;
+}
+
+
 void DitherAlgorithm::ditherFramebuffer(uint8_t *frameBuffer, int width, int height, uint8_t mode)
 {
+    PROFILER_SCOPE("ditherFramebuffer");
+
     // mode = 0 → 1-bit (2 levels)
     // mode = 1 → 3-bit (8 levels)
     const int maxLevel = (mode == 0) ? 1 : 7;
     const float scale = 255.0f / maxLevel;
 
-    int16_t *errCurr = (int16_t *)ps_malloc(width * sizeof(int16_t));
-    int16_t *errNext = (int16_t *)ps_malloc(width * sizeof(int16_t));
+    int16_t *errCurr = (int16_t *)trackedMalloc(MEMORY_TAG_DITHER, width * sizeof(int16_t), _rowCaps);
+    int16_t *errNext = (int16_t *)trackedMalloc(MEMORY_TAG_DITHER, width * sizeof(int16_t), _rowCaps);
     if (!errCurr || !errNext)
+    {
+        trackedFree(MEMORY_TAG_DITHER, errCurr, width * sizeof(int16_t));
+        trackedFree(MEMORY_TAG_DITHER, errNext, width * sizeof(int16_t));
         return;
+    }
 
     memset(errCurr, 0, width * sizeof(int16_t));
 
@@ -93,8 +111,8 @@ void DitherAlgorithm::ditherFramebuffer(uint8_t *frameBuffer, int width, int hei
         memcpy(errCurr, errNext, width * sizeof(int16_t));
     }
 
-    free(errCurr);
-    free(errNext);
+    trackedFree(MEMORY_TAG_DITHER, errCurr, width * sizeof(int16_t));
+    trackedFree(MEMORY_TAG_DITHER, errNext, width * sizeof(int16_t));
 }
 
 
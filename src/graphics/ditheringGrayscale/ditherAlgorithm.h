@@ -8,6 +8,7 @@
 #include <string.h>
 #include <math.h>
 #include <float.h>
+#include "esp_heap_caps.h"
 
 class Inkplate;
 
@@ -23,7 +24,10 @@ class DitherAlgorithm
     void ditherFramebuffer(uint8_t *frameBuffer, int width, int height, uint8_t mode);
     void begin(Inkplate *inkplatePtr);
 
+    void setMemoryCaps(uint32_t caps);
+
   private:
+    uint32_t _rowCaps = MALLOC_CAP_SPIRAM;
     Inkplate *_inkplate;
 };
 
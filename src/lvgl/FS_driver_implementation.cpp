@@ -2,59 +2,578 @@
 #include "Inkplate-LVGL.h"
 #ifndef ARDUINO_INKPLATE2
 
+// Every file read through 'S:' has its own read-ahead cache in PSRAM. Image and font decoders issue many small
+// reads and seeks, without the cache each one is a command and a block transfer on the SPI bus. The cache always
+// reads whole 512 byte blocks. While the file is read sequentially the read-ahead window doubles on every miss (up
+// to the cache size); a seek somewhere else drops it back to the minimum, so random small reads don't pull in data
+// that is never used.
+//
+// Files opened for writing use the same buffer for write-behind: writes are collected in it and go to the card
+// when it's full (or on seek and close). The buffer ends at a block boundary of the file, so every flush after the
+// first is whole blocks and SdFat writes it with multi-block commands.
+#define SD_BLOCK_SIZE     512
+#define SD_MIN_READ_AHEAD (2 * SD_BLOCK_SIZE)
+
+// Run of clusters that follow each other on the card. A seek on the card normally follows the cluster chain in the
+// FAT from the start of the file (or from the current position), with the runs of the file mapped it's a lookup.
+struct sdExtent {
+  uint32_t index;   // Index of the first cluster of the run in the file.
+  uint32_t cluster; // Its cluster number on the card.
+  uint32_t count;   // Clusters in the run.
+};
+
+struct sdFile {
+  SdFile file;
+  char *path;
+  bool write;
+  bool read;           // Written file opened with LV_FS_MODE_RD too.
+  uint32_t pos;        // Position LVGL sees, the card is only seeked when the cache is filled.
+  uint32_t size;
+  uint8_t *cache;      // Allocated on the first read (or write).
+  uint32_t cacheSize;
+  uint32_t cacheStart; // File offset of cache[0].
+  uint32_t cacheLen;   // Valid bytes in the cache (bytes not written yet for written files).
+  uint32_t readAhead;  // Bytes read on the next miss.
+  uint32_t nextPos;    // Where the next read starts if the file is read sequentially.
+  struct sdExtent *extents; // Made on the first seek on the card.
+  uint16_t extentCount;
+  bool noExtents;      // Too fragmented (or FAT error), seeks follow the FAT.
+  struct sdCacheStats stats;
+  struct sdFile *next;
+};
+
+static struct sdFile *openFiles = NULL;
+static uint32_t cacheSize = LV_FS_SD_CACHE_SIZE;
+static bool dirIndex = false;
+static struct sdCacheStats closedStats; // Counters of the files that were already closed.
+
+// Handles of the open files come from a pool, the heap is used only when more files than that are open.
+static struct sdFile filePool[LV_FS_SD_FILE_POOL];
+static bool filePoolUsed[LV_FS_SD_FILE_POOL];
+
+static struct sdFile *allocFile() {
+  for (int i = 0; i < LV_FS_SD_FILE_POOL; i++) {
+    if (!filePoolUsed[i]) {
+      filePoolUsed[i] = true;
+      filePool[i] = sdFile();
+      return &filePool[i];
+    }
+  }
+  return new sdFile();
+}
+
+static void freeFile(struct sdFile *f) {
+  if (f >= filePool && f < filePool + LV_FS_SD_FILE_POOL)
+    filePoolUsed[f - filePool] = false;
+  else
+    delete f;
+}
+
+static void addStats(struct sdCacheStats *_to, const struct sdCacheStats *_from) {
+  _to->hits += _from->hits;
+  _to->misses += _from->misses;
+  _to->cardReads += _from->cardReads;
+  _to->bytesRequested += _from->bytesRequested;
+  _to->bytesFromCard += _from->bytesFromCard;
+  _to->invalidations += _from->invalidations;
+  _to->extentSeeks += _from->extentSeeks;
+  _to->cardWrites += _from->cardWrites;
+  _to->bytesToCard += _from->bytesToCard;
+}
+
+static bool allocCache(struct sdFile *f) {
+  if (f->cache == NULL && cacheSize > 0) {
+    f->cache = (uint8_t *)trackedMalloc(MEMORY_TAG_FS_CACHE, cacheSize, MALLOC_CAP_SPIRAM);
+    f->cacheSize = f->cache != NULL ? cacheSize : 0;
+  }
+  return f->cache != NULL;
+}
+
+static void freeExtents(struct sdFile *f) {
+  if (f->extents != NULL)
+    trackedFree(MEMORY_TAG_FS_CACHE, f->extents, f->extentCount * sizeof(struct sdExtent));
+  f->extents = NULL;
+  f->extentCount = 0;
+  f->noExtents = false;
+}
+
+// Drop the cached data of every other handle of the file, it was changed on the card. Its clusters may have
+// changed too, the extent map is made again on the next seek.
+static void invalidateCaches(struct sdFile *_writer) {
+  for (struct sdFile *f = openFiles; f != NULL; f = f->next) {
+    if (f == _writer || strcmp(f->path, _writer->path) != 0)
+      continue;
+    if (f->cacheLen) {
+      f->cacheLen = 0;
+      f->stats.invalidations++;
+    }
+    freeExtents(f);
+  }
+}
+
+// Map the runs of contiguous clusters of the file, the FAT is read once for the whole file.
+static bool makeExtents(struct sdFile *f) {
+  static struct sdExtent runs[LV_FS_SD_MAX_EXTENTS];
+
+  if (f->extents != NULL)
+    return true;
+  if (f->noExtents)
+    return false;
+
+  // If it doesn't work out, don't try again until the file changes.
+  f->noExtents = true;
+  uint32_t cluster = f->file.firstCluster();
+  uint16_t n = 0;
+  uint32_t index = 0;
+  while (cluster != 0) {
+    if (n == LV_FS_SD_MAX_EXTENTS)
+      return false;
+    runs[n].index = index;
+    runs[n].cluster = cluster;
+    if (!f->file.clusterRun(&cluster, &runs[n].count))
+      return false;
+    index += runs[n].count;
+    n++;
+  }
+  if (n == 0)
+    return false;
+
+  f->extents = (struct sdExtent *)trackedMalloc(MEMORY_TAG_FS_CACHE, n * sizeof(struct sdExtent), MALLOC_CAP_8BIT);
+  if (f->extents == NULL)
+    return false;
+  memcpy(f->extents, runs, n * sizeof(struct sdExtent));
+  f->extentCount = n;
+  f->noExtents = false;
+  return true;
+}
+
+// Move the position of the file on the card to _pos. With the extent map the cluster of the position is found
+// with a binary search of the runs (one step for an unfragmented file) instead of following the FAT.
+static bool cardSeek(struct sdFile *f, uint32_t _pos) {
+  if (_pos == f->file.curPosition() || _pos == 0 || !makeExtents(f))
+    return f->file.seekSet(_pos);
+
+  // Position is in the cluster of the byte before it (SdFat moves to the next cluster on the next read).
+  uint32_t index = (_pos - 1) >> (f->file.volume()->clusterSizeShift() + 9);
+  uint16_t lo = 0;
+  uint16_t hi = f->extentCount;
+  while (hi - lo > 1) {
+    uint16_t mid = (lo + hi) / 2;
+    if (f->extents[mid].index <= index)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  struct sdExtent *e = &f->extents[lo];
+  if (index >= e->index + e->count)
+    return f->file.seekSet(_pos);
+  f->stats.extentSeeks++;
+  return f->file.seekSetCluster(_pos, e->cluster + (index - e->index));
+}
+
+// Read from the card at the file position _pos, bypassing the cache.
+static int32_t cardRead(struct sdFile *f, uint32_t _pos, void *_buf, uint32_t _len) {
+  if (!cardSeek(f, _pos))
+    return -1;
+  int32_t res = f->file.read(_buf, _len);
+  if (res > 0) {
+    f->stats.cardReads++;
+    f->stats.bytesFromCard += res;
+  }
+  return res;
+}
+
+// Write to the card at its current position, bypassing the buffer.
+static bool cardWrite(struct sdFile *f, const uint8_t *_buf, uint32_t _len) {
+  size_t res = f->file.write(_buf, _len);
+  f->stats.cardWrites++;
+  f->stats.bytesToCard += res;
+  invalidateCaches(f);
+  return res == _len;
+}
+
+// Write what's in the write-behind buffer to the card.
+static bool flushWrite(struct sdFile *f) {
+  if (f->cacheLen == 0)
+    return true;
+  PROFILER_SCOPE("sdFlush");
+  bool ok = cardWrite(f, f->cache, f->cacheLen);
+  f->cacheLen = 0;
+  return ok;
+}
+
 static void * sd_open(lv_fs_drv_t *drv, const char *path, lv_fs_mode_t mode) {
-  SdFile *f = new SdFile();
-  oflag_t flags = (mode == LV_FS_MODE_WR) ? (O_WRITE | O_CREAT | O_TRUNC) : O_READ;
-  bool ok = f->open(path, flags);
-  
-  if (!ok) { 
-    delete f; 
-    return NULL; 
-  }
-  
+  PROFILER_SCOPE("sdOpen");
+  struct sdFile *f = allocFile();
+  f->write = (mode & LV_FS_MODE_WR) != 0;
+  f->read = f->write && (mode & LV_FS_MODE_RD) != 0;
+  // Write only truncates, read and write keeps the content (same as "w" and "r+").
+  oflag_t flags = O_READ;
+  if (f->write)
+    flags = f->read ? (O_RDWR | O_CREAT) : (O_WRITE | O_CREAT | O_TRUNC);
+  bool ok = f->file.open(path, flags);
+
+  if (!ok) {
+    freeFile(f);
+    return NULL;
+  }
+
+  f->path = strdup(path);
+  if (f->path == NULL) {
+    f->file.close();
+    freeFile(f);
+    return NULL;
+  }
+
   // LVGL 9.4 expects file pointer to be at position 0
-  f->seekSet(0);
+  f->file.seekSet(0);
+  f->size = f->file.fileSize();
+  f->readAhead = SD_MIN_READ_AHEAD;
+  f->next = openFiles;
+  openFiles = f;
+
+  // Truncating is a write too. The file may be new, the index of its directory is out of date. Its copy on the
+  // 'M:' RAM drive is old.
+  if (f->write) {
+    invalidateCaches(f);
+    lv_fs_sd_invalidate_dir_index(path);
+    lv_fs_mem_remove(path);
+  }
   return f;
 }
 
 static lv_fs_res_t sd_close(lv_fs_drv_t *drv, void *file_p) {
-  SdFile *f = static_cast<SdFile*>(file_p);
-  f->close();
-  delete f;
-  return LV_FS_RES_OK;
+  struct sdFile *f = static_cast<struct sdFile*>(file_p);
+  bool ok = flushWrite(f);
+  ok &= f->file.close();
+
+  for (struct sdFile **p = &openFiles; *p != NULL; p = &(*p)->next) {
+    if (*p == f) {
+      *p = f->next;
+      break;
+    }
+  }
+  addStats(&closedStats, &f->stats);
+
+  if (f->cache != NULL)
+    trackedFree(MEMORY_TAG_FS_CACHE, f->cache, f->cacheSize);
+  freeExtents(f);
+  free(f->path);
+  freeFile(f);
+  return ok ? LV_FS_RES_OK : LV_FS_RES_UNKNOWN;
 }
 
 static lv_fs_res_t sd_read(lv_fs_drv_t *drv, void *file_p, void *buf, uint32_t btr, uint32_t *br) {
-  SdFile *f = static_cast<SdFile*>(file_p);
-  int32_t res = f->read(buf, btr);
-  
-  if (res < 0) {
-    *br = 0;
-    return LV_FS_RES_UNKNOWN;
+  PROFILER_SCOPE("sdRead");
+  struct sdFile *f = static_cast<struct sdFile*>(file_p);
+  *br = 0;
+
+  // Written files are read straight from the card, after their buffered data is written.
+  if (f->write) {
+    if (!f->read)
+      return LV_FS_RES_DENIED;
+    if (!flushWrite(f) || !f->file.seekSet(f->pos))
+      return LV_FS_RES_UNKNOWN;
+    int res = f->file.read(buf, btr);
+    if (res < 0)
+      return LV_FS_RES_UNKNOWN;
+    f->pos += res;
+    *br = res;
+    return LV_FS_RES_OK;
   }
-  
-  *br = (uint32_t)res;
-  return LV_FS_RES_OK;
+
+  allocCache(f);
+
+  bool sequential = (f->pos == f->nextPos);
+  bool hit = true;
+  bool error = false;
+  uint8_t *out = (uint8_t *)buf;
+  uint32_t left = f->pos < f->size ? min(btr, f->size - f->pos) : 0;
+  f->stats.bytesRequested += btr;
+
+  if (!sequential)
+    f->readAhead = SD_MIN_READ_AHEAD;
+
+  while (left > 0) {
+    // Whatever is already in the cache.
+    if (f->pos >= f->cacheStart && f->pos < f->cacheStart + f->cacheLen) {
+      uint32_t n = min(left, f->cacheStart + f->cacheLen - f->pos);
+      memcpy(out, f->cache + (f->pos - f->cacheStart), n);
+      out += n;
+      f->pos += n;
+      left -= n;
+      continue;
+    }
+
+    hit = false;
+
+    // Reads that don't fit into the cache (or no cache at all) go straight into the buffer of the caller.
+    if (left >= f->cacheSize) {
+      int32_t res = cardRead(f, f->pos, out, left);
+      error = (res < 0);
+      if (res <= 0)
+        break;
+      out += res;
+      f->pos += res;
+      left -= res;
+      continue;
+    }
+
+    // Fill the cache from the block the read starts in.
+    uint32_t start = f->pos & ~(uint32_t)(SD_BLOCK_SIZE - 1);
+    uint32_t len = max(f->readAhead, (f->pos - start + left + SD_BLOCK_SIZE - 1) & ~(uint32_t)(SD_BLOCK_SIZE - 1));
+    int32_t res = cardRead(f, start, f->cache, min(len, f->cacheSize));
+    f->cacheStart = start;
+    f->cacheLen = res > 0 ? res : 0;
+    error = (res < 0);
+    if (f->pos >= f->cacheStart + f->cacheLen)
+      break;
+
+    if (sequential)
+      f->readAhead = min(f->readAhead * 2, f->cacheSize);
+  }
+
+  // Reads at the end of the file don't count.
+  if (!hit)
+    f->stats.misses++;
+  else if (out != buf)
+    f->stats.hits++;
+
+  *br = out - (uint8_t *)buf;
+  f->nextPos = f->pos;
+  return (error && *br == 0) ? LV_FS_RES_UNKNOWN : LV_FS_RES_OK;
+}
+
+static lv_fs_res_t sd_write(lv_fs_drv_t *drv, void *file_p, const void *buf, uint32_t btw, uint32_t *bw) {
+  PROFILER_SCOPE("sdWrite");
+  struct sdFile *f = static_cast<struct sdFile*>(file_p);
+  const uint8_t *in = (const uint8_t *)buf;
+  bool ok = true;
+  *bw = 0;
+
+  if (!f->write)
+    return LV_FS_RES_DENIED;
+
+  allocCache(f);
+  f->stats.bytesRequested += btw;
+
+  while (ok && btw > 0) {
+    // Buffer is filled up to the first block boundary after cacheSize bytes from its start.
+    if (f->cacheLen == 0)
+      f->cacheStart = f->pos;
+    uint32_t limit = f->cacheSize - (f->cacheStart & (SD_BLOCK_SIZE - 1));
+
+    // Writes that don't fit into an empty buffer (or no buffer at all) go straight to the card.
+    if (f->cacheSize == 0 || (f->cacheLen == 0 && btw >= limit)) {
+      uint32_t start = f->pos;
+      ok = cardWrite(f, in, btw);
+      f->pos = f->file.curPosition();
+      *bw += f->pos - start;
+      break;
+    }
+
+    uint32_t n = min(btw, limit - f->cacheLen);
+    memcpy(f->cache + f->cacheLen, in, n);
+    f->cacheLen += n;
+    f->pos += n;
+    in += n;
+    btw -= n;
+    *bw += n;
+    if (f->cacheLen == limit)
+      ok = flushWrite(f);
+  }
+
+  f->size = max(f->size, f->pos);
+  return ok ? LV_FS_RES_OK : LV_FS_RES_UNKNOWN;
 }
 
 static lv_fs_res_t sd_seek(lv_fs_drv_t *drv, void *file_p, uint32_t pos, lv_fs_whence_t whence) {
-  SdFile *f = static_cast<SdFile*>(file_p);
-  
+  struct sdFile *f = static_cast<struct sdFile*>(file_p);
+  int64_t newPos;
+
   switch (whence) {
     case LV_FS_SEEK_SET:
-      return f->seekSet(pos) ? LV_FS_RES_OK : LV_FS_RES_UNKNOWN;
+      newPos = pos;
+      break;
     case LV_FS_SEEK_CUR:
-      return f->seekCur((int32_t)pos) ? LV_FS_RES_OK : LV_FS_RES_UNKNOWN;
+      newPos = (int64_t)f->pos + (int32_t)pos;
+      break;
     case LV_FS_SEEK_END:
-      return f->seekEnd((int32_t)pos) ? LV_FS_RES_OK : LV_FS_RES_UNKNOWN;
+      newPos = (int64_t)f->size + (int32_t)pos;
+      break;
     default:
       return LV_FS_RES_UNKNOWN;
   }
+
+  if (newPos < 0 || newPos > f->size)
+    return LV_FS_RES_UNKNOWN;
+
+  // Buffered data of written files goes to the card first, their position is the position on the card. Read files
+  // only move the position LVGL sees, the card is seeked (with the extent map) when a read misses the cache.
+  if (f->write && (!flushWrite(f) || !f->file.seekSet((uint32_t)newPos)))
+    return LV_FS_RES_UNKNOWN;
+
+  f->pos = (uint32_t)newPos;
+  return LV_FS_RES_OK;
 }
 
 static lv_fs_res_t sd_tell(lv_fs_drv_t *drv, void *file_p, uint32_t *pos_p) {
-  SdFile *f = static_cast<SdFile*>(file_p);
-  *pos_p = f->curPosition();
+  struct sdFile *f = static_cast<struct sdFile*>(file_p);
+  *pos_p = f->pos;
+  return LV_FS_RES_OK;
+}
+
+// Listing a directory with openNext() opens every entry and reads its long name back from the directory entries
+// before it. With the index enabled the names are saved in an index file in the directory, the next listing reads
+// them back from it sequentially. FAT doesn't update the directory's own entry when files are added, removed or
+// renamed, so the index is checked against a hash of the raw directory entries, read in one sequential pass.
+#define SD_DIR_INDEX_NAME  ".lvdir.idx"
+#define SD_DIR_INDEX_MAGIC 0x3244564C // "LVD2"
+
+struct sdDirIndexHeader {
+  uint32_t magic;        // 0 while the index is written.
+  uint32_t firstCluster; // Of the directory.
+  uint32_t entries;      // Used directory entries (long name parts included).
+  uint32_t hash;         // FNV-1a of the listed part of the entries.
+  uint32_t count;        // Names in the index.
+};
+
+struct sdDir {
+  SdFile dir;
+  SdFile index;
+  bool fromIndex;  // Names are read from the index.
+  bool makeIndex;  // Names read from the directory are written to a new index.
+  uint32_t count;
+};
+
+// Path of the index of the directory _dir (path LVGL passes to the driver).
+static void dirIndexPath(char *_out, size_t _size, const char *_dir) {
+  size_t len = strlen(_dir);
+  snprintf(_out, _size, "%s%s" SD_DIR_INDEX_NAME, _dir, (len == 0 || _dir[len - 1] != '/') ? "/" : "");
+}
+
+// What the index of the directory must match. Long name parts are hashed whole, of a short entry only the name,
+// attributes and case flags: size and times change on every write of a file, the index file itself too.
+static bool dirStamp(SdFile *_dir, struct sdDirIndexHeader *_h) {
+  dir_t entry;
+  int n;
+  memset(_h, 0, sizeof(struct sdDirIndexHeader));
+  _h->magic = SD_DIR_INDEX_MAGIC;
+  _h->firstCluster = _dir->firstCluster();
+  _h->hash = 2166136261UL;
+
+  _dir->rewind();
+  while ((n = _dir->read(&entry, sizeof(entry))) == sizeof(entry) && entry.name[0] != DIR_NAME_FREE) {
+    if (entry.name[0] == DIR_NAME_DELETED)
+      continue;
+    const uint8_t *b = (const uint8_t *)&entry;
+    size_t len = DIR_IS_LONG_NAME(&entry) ? sizeof(entry) : offsetof(dir_t, reservedNT) + 1;
+    for (size_t i = 0; i < len; i++)
+      _h->hash = (_h->hash ^ b[i]) * 16777619UL;
+    _h->entries++;
+  }
+  _dir->rewind();
+  return n >= 0;
+}
+
+static void * sd_dir_open(lv_fs_drv_t *drv, const char *path) {
+  PROFILER_SCOPE("sdDirOpen");
+  struct sdDir *d = new sdDir();
+  if (!d->dir.open(path[0] ? path : "/", O_READ) || !d->dir.isDir()) {
+    delete d;
+    return NULL;
+  }
+  if (!dirIndex)
+    return d;
+
+  char indexPath[256];
+  struct sdDirIndexHeader stamp, saved;
+  dirIndexPath(indexPath, sizeof(indexPath), path);
+  if (!dirStamp(&d->dir, &stamp))
+    return d;
+
+  if (d->index.open(indexPath, O_READ)) {
+    if (d->index.read(&saved, sizeof(saved)) == sizeof(saved) && memcmp(&saved, &stamp, offsetof(struct sdDirIndexHeader, count)) == 0) {
+      d->fromIndex = true;
+      d->count = saved.count;
+      d->dir.close();
+      return d;
+    }
+    d->index.close();
+  }
+
+  // Out of date or missing, write a new one while the directory is listed. Header stays invalid until the end.
+  memset(&saved, 0, sizeof(saved));
+  if (d->index.open(indexPath, O_WRITE | O_CREAT | O_TRUNC)) {
+    d->makeIndex = d->index.write((const uint8_t *)&saved, sizeof(saved)) == sizeof(saved);
+    if (!d->makeIndex)
+      d->index.close();
+  }
+  return d;
+}
+
+// Names of directories start with '/', an empty name is the end of the directory.
+static lv_fs_res_t sd_dir_read(lv_fs_drv_t *drv, void *rddir_p, char *fn, uint32_t fn_len) {
+  struct sdDir *d = static_cast<struct sdDir*>(rddir_p);
+  char name[257];
+  uint16_t len = 0;
+  fn[0] = '\0';
+
+  if (d->fromIndex) {
+    if (d->count == 0)
+      return LV_FS_RES_OK;
+    if (d->index.read(&len, sizeof(len)) != sizeof(len) || len >= sizeof(name) || d->index.read(name, len) != len)
+      return LV_FS_RES_UNKNOWN;
+    name[len] = '\0';
+    d->count--;
+    lv_strlcpy(fn, name, fn_len);
+    return LV_FS_RES_OK;
+  }
+
+  SdFile entry;
+  while (entry.openNext(&d->dir, O_READ)) {
+    name[0] = '/';
+    bool isDir = entry.isDir();
+    bool ok = entry.getName(name + 1, sizeof(name) - 1);
+    entry.close();
+    if (!ok || strcmp(name + 1, SD_DIR_INDEX_NAME) == 0)
+      continue;
+
+    const char *n = isDir ? name : name + 1;
+    lv_strlcpy(fn, n, fn_len);
+    if (d->makeIndex) {
+      len = strlen(n);
+      d->makeIndex = d->index.write((const uint8_t *)&len, sizeof(len)) == sizeof(len) &&
+                     d->index.write((const uint8_t *)n, len) == len;
+      d->count++;
+    }
+    return LV_FS_RES_OK;
+  }
+
+  // End of the directory, the index is complete.
+  if (d->makeIndex) {
+    struct sdDirIndexHeader h;
+    d->makeIndex = false;
+    if (dirStamp(&d->dir, &h)) {
+      h.count = d->count;
+      d->index.seekSet(0);
+      d->index.write((const uint8_t *)&h, sizeof(h));
+    }
+    d->index.close();
+  }
+  return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t sd_dir_close(lv_fs_drv_t *drv, void *rddir_p) {
+  struct sdDir *d = static_cast<struct sdDir*>(rddir_p);
+
+  // Listing stopped before the end, the index is not complete.
+  if (d->makeIndex)
+    d->index.remove();
+  d->index.close();
+  d->dir.close();
+  delete d;
   return LV_FS_RES_OK;
 }
 
@@ -67,10 +586,94 @@ void lv_fs_init_sd() {
   drv.open_cb  = sd_open;
   drv.close_cb = sd_close;
   drv.read_cb  = sd_read;
+  drv.write_cb = sd_write;
   drv.seek_cb  = sd_seek;
   drv.tell_cb  = sd_tell;
-  drv.cache_size = 0;              // optional but helpful for file reads
+  drv.dir_open_cb  = sd_dir_open;
+  drv.dir_read_cb  = sd_dir_read;
+  drv.dir_close_cb = sd_dir_close;
+  drv.cache_size = 0;              // Driver has its own read-ahead cache in PSRAM
 
   lv_fs_drv_register(&drv);
 }
-#endif
\ No newline at end of file
+
+/**
+ * @brief       lv_fs_sd_set_cache_size sets the size of the read-ahead cache (write-behind buffer of written files)
+ *              of the files opened on the SD card after this call (files already open keep their cache).
+ *
+ * @param       uint32_t _bytes
+ *              Cache size of each file, rounded up to whole 512 byte blocks. 0 disables the cache.
+ */
+void lv_fs_sd_set_cache_size(uint32_t _bytes) {
+  cacheSize = (_bytes + SD_BLOCK_SIZE - 1) & ~(uint32_t)(SD_BLOCK_SIZE - 1);
+}
+
+/**
+ * @brief       lv_fs_sd_get_cache_size returns the size of the read-ahead cache of newly opened files.
+ *
+ * @return      Cache size in bytes.
+ */
+uint32_t lv_fs_sd_get_cache_size() {
+  return cacheSize;
+}
+
+/**
+ * @brief       lv_fs_sd_set_dir_index turns the directory index on or off. With it, listing a directory through
+ *              'S:' (lv_fs_dir_open()/lv_fs_dir_read()) saves the names into a .lvdir.idx file in the directory and
+ *              the next listing reads them from it, as long as the directory wasn't changed.
+ *
+ * @param       bool _enable
+ *              True to use and write the index files.
+ *
+ * @note        Index is checked against a hash of the directory entries (one sequential read of the directory),
+ *              so files added, removed or renamed by anything, not only through 'S:', make it out of date.
+ */
+void lv_fs_sd_set_dir_index(bool _enable) {
+  dirIndex = _enable;
+}
+
+/**
+ * @brief       lv_fs_sd_invalidate_dir_index removes the index of the directory a file is in, the next listing
+ *              reads the directory again.
+ *
+ * @param       const char *_path
+ *              Path of a file on the SD card (without "S:"), its directory index is removed.
+ */
+void lv_fs_sd_invalidate_dir_index(const char *_path) {
+  char indexPath[256];
+  const char *slash = strrchr(_path, '/');
+  int len = slash != NULL ? slash - _path + 1 : 0;
+  snprintf(indexPath, sizeof(indexPath), "%.*s" SD_DIR_INDEX_NAME, len, _path);
+
+  SdFile index;
+  if (index.open(indexPath, O_WRITE))
+    index.remove();
+}
+
+/**
+ * @brief       lv_fs_sd_get_cache_stats returns the read-ahead cache counters of a file open on the SD card.
+ *
+ * @param       lv_fs_file_t *_file
+ *              File opened with lv_fs_open("S:..."), NULL for the sum of all files since boot.
+ * @param       struct sdCacheStats *_stats
+ *              Filled with the counters.
+ *
+ * @return      True if filled, false if the file is not open on the SD card.
+ */
+bool lv_fs_sd_get_cache_stats(lv_fs_file_t *_file, struct sdCacheStats *_stats) {
+  if (_stats == NULL)
+    return false;
+
+  if (_file != NULL) {
+    if (_file->drv == NULL || _file->drv->letter != 'S' || _file->file_d == NULL)
+      return false;
+    *_stats = static_cast<struct sdFile*>(_file->file_d)->stats;
+    return true;
+  }
+
+  *_stats = closedStats;
+  for (struct sdFile *f = openFiles; f != NULL; f = f->next)
+    addStats(_stats, &f->stats);
+  return true;
+}
+#endif
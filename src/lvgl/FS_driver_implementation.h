@@ -1,3 +1,45 @@
 #pragma once
 
-void lv_fs_init_sd(); 
\ No newline at end of file
+#include <stdint.h>
+
+#include "lvgl.h"
+
+// Size of the read-ahead cache (write-behind buffer for written files) of each file open on the SD card, can be
+// changed with lv_fs_sd_set_cache_size().
+#ifndef LV_FS_SD_CACHE_SIZE
+#define LV_FS_SD_CACHE_SIZE (32 * 1024)
+#endif
+
+// Handles of open files kept in a static pool, more open files are allocated on the heap.
+#ifndef LV_FS_SD_FILE_POOL
+#define LV_FS_SD_FILE_POOL 8
+#endif
+
+// Most runs of contiguous clusters kept in the extent map of a file, more fragmented files seek through the FAT.
+#ifndef LV_FS_SD_MAX_EXTENTS
+#define LV_FS_SD_MAX_EXTENTS 32
+#endif
+
+/**
+ * @brief       Read-ahead cache and write-behind buffer counters of one file (or of all files, see
+ *              lv_fs_sd_get_cache_stats()).
+ */
+struct sdCacheStats
+{
+    uint32_t hits;           // Reads served from the cache.
+    uint32_t misses;         // Reads that needed the card.
+    uint32_t cardReads;      // Reads from the card (whole blocks).
+    uint32_t bytesRequested; // Bytes LVGL asked to read (or write).
+    uint32_t bytesFromCard;  // Bytes read from the card.
+    uint32_t invalidations;  // Cache dropped because the file was written.
+    uint32_t extentSeeks;    // Seeks on the card done with the extent map (without following the FAT).
+    uint32_t cardWrites;     // Writes to the card (write-behind buffer flushes and big writes).
+    uint32_t bytesToCard;    // Bytes written to the card.
+};
+
+void lv_fs_init_sd();
+void lv_fs_sd_set_cache_size(uint32_t _bytes);
+uint32_t lv_fs_sd_get_cache_size();
+bool lv_fs_sd_get_cache_stats(lv_fs_file_t *_file, struct sdCacheStats *_stats);
+void lv_fs_sd_set_dir_index(bool _enable);
+void lv_fs_sd_invalidate_dir_index(const char *_path);
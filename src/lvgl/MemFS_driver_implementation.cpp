@@ -0,0 +1,457 @@
+#include "MemFS_driver_implementation.h"
+#include "Inkplate-LVGL.h"
+
+// 'M:' keeps whole files in PSRAM, for assets that are used on every refresh (fonts, icons, backgrounds). A file
+// that is not in RAM yet is loaded from the SD card the first time it's opened ("M:/icons/wifi.png" is
+// "/icons/wifi.png" on the card), files can also be added from a buffer (a download). Files are kept in a list from
+// the most to the least recently used one; when a new file doesn't fit into the budget, files nobody uses are
+// dropped from the end of the list.
+//
+// Decoders that take images from memory (PNG and LVGL .bin images) don't need to read the file at all: the image
+// descriptor from lv_fs_mem_image_dsc() points into the RAM copy.
+
+struct memFile {
+  char *name;     // Without the leading '/'.
+  uint8_t *data;
+  uint32_t size;
+  uint16_t opened; // Open handles.
+  uint16_t pins;   // Pointers handed out by lv_fs_mem_data() and lv_fs_mem_image_dsc().
+  bool stale;      // Removed (or changed on the card) while in use, freed when it's not used anymore.
+  struct memFile *next;
+};
+
+struct memHandle {
+  struct memFile *file;
+  uint32_t pos;
+};
+
+static struct memFile *files = NULL; // Most recently used first.
+static uint32_t budget = LV_FS_MEM_BUDGET;
+static struct memFsStats stats;
+
+// "M:/icons/a.png" and "M:icons/a.png" are the same file.
+static const char *fileName(const char *_path) {
+  while (*_path == '/')
+    _path++;
+  return _path;
+}
+
+static bool inUse(struct memFile *f) {
+  return f->opened || f->pins;
+}
+
+// Find the file and make it the most recently used one.
+static struct memFile *findFile(const char *_name) {
+  _name = fileName(_name);
+  for (struct memFile **p = &files; *p != NULL; p = &(*p)->next) {
+    struct memFile *f = *p;
+    if (f->stale || strcmp(f->name, _name) != 0)
+      continue;
+    if (p != &files) {
+      *p = f->next;
+      f->next = files;
+      files = f;
+    }
+    return f;
+  }
+  return NULL;
+}
+
+static void dropFile(struct memFile *_f) {
+  for (struct memFile **p = &files; *p != NULL; p = &(*p)->next) {
+    if (*p == _f) {
+      *p = _f->next;
+      break;
+    }
+  }
+  stats.files--;
+  stats.bytesUsed -= _f->size;
+  trackedFree(MEMORY_TAG_MEM_FS, _f->data, _f->size);
+  free(_f->name);
+  delete _f;
+}
+
+// Drop the file now, or once it's closed and released if it's in use.
+static void forgetFile(struct memFile *_f) {
+  if (inUse(_f))
+    _f->stale = true;
+  else
+    dropFile(_f);
+}
+
+// Drop the least recently used files nobody uses until _size more bytes fit into the budget.
+static bool makeRoom(uint32_t _size) {
+  if (_size > budget)
+    return false;
+  while (stats.bytesUsed + _size > budget) {
+    struct memFile *last = NULL;
+    for (struct memFile *f = files; f != NULL; f = f->next) {
+      if (!inUse(f))
+        last = f;
+    }
+    if (last == NULL)
+      return false;
+    dropFile(last);
+    stats.evictions++;
+  }
+  return true;
+}
+
+// Forget the file with this name before the data of its replacement is allocated, so its bytes don't push other
+// files out of the budget.
+static void forgetName(const char *_name) {
+  struct memFile *old = findFile(_name);
+  if (old != NULL)
+    forgetFile(old);
+}
+
+static uint8_t *allocData(uint32_t _size) {
+  if (_size == 0 || !makeRoom(_size))
+    return NULL;
+  return (uint8_t *)trackedMalloc(MEMORY_TAG_MEM_FS, _size, MALLOC_CAP_SPIRAM);
+}
+
+// Add a file with data from allocData() (or adopted), forgetName() must be called before the data is allocated.
+// Returns NULL if the name can't be copied, the data then still belongs to the caller.
+static struct memFile *addFile(const char *_name, uint8_t *_data, uint32_t _size) {
+  char *name = strdup(fileName(_name));
+  if (name == NULL)
+    return NULL;
+
+  struct memFile *f = new memFile();
+  f->name = name;
+  f->data = _data;
+  f->size = _size;
+  f->next = files;
+  files = f;
+  stats.files++;
+  stats.bytesUsed += _size;
+  return f;
+}
+
+#ifndef ARDUINO_INKPLATE2
+// Read the whole file from the SD card, it goes from the card straight into its RAM copy.
+static struct memFile *loadFile(const char *_path) {
+  PROFILER_SCOPE("memLoad");
+  SdFile file;
+  if (!file.open(_path, O_READ))
+    return NULL;
+
+  uint32_t size = file.fileSize();
+  forgetName(_path);
+  uint8_t *data = allocData(size);
+  bool ok = data != NULL && file.read(data, size) == (int)size;
+  file.close();
+  struct memFile *f = ok ? addFile(_path, data, size) : NULL;
+  if (f == NULL) {
+    trackedFree(MEMORY_TAG_MEM_FS, data, size);
+    return NULL;
+  }
+
+  stats.loads++;
+  stats.bytesLoaded += size;
+  return f;
+}
+#endif
+
+// File from RAM, loaded from the SD card if it's not there.
+static struct memFile *getFile(const char *_path) {
+  struct memFile *f = findFile(_path);
+  if (f != NULL) {
+    stats.hits++;
+    return f;
+  }
+  stats.misses++;
+#ifndef ARDUINO_INKPLATE2
+  return loadFile(_path);
+#else
+  return NULL;
+#endif
+}
+
+// Drop a file that was removed while in use once nobody uses it.
+static void releaseFile(struct memFile *_f) {
+  if (_f->stale && !inUse(_f))
+    dropFile(_f);
+}
+
+static void * mem_open(lv_fs_drv_t *drv, const char *path, lv_fs_mode_t mode) {
+  if (mode != LV_FS_MODE_RD)
+    return NULL;
+
+  struct memFile *f = getFile(path);
+  if (f == NULL)
+    return NULL;
+
+  struct memHandle *h = new memHandle();
+  h->file = f;
+  f->opened++;
+  return h;
+}
+
+static lv_fs_res_t mem_close(lv_fs_drv_t *drv, void *file_p) {
+  struct memHandle *h = static_cast<struct memHandle*>(file_p);
+  h->file->opened--;
+  releaseFile(h->file);
+  delete h;
+  return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t mem_read(lv_fs_drv_t *drv, void *file_p, void *buf, uint32_t btr, uint32_t *br) {
+  struct memHandle *h = static_cast<struct memHandle*>(file_p);
+  *br = h->pos < h->file->size ? min(btr, h->file->size - h->pos) : 0;
+  memcpy(buf, h->file->data + h->pos, *br);
+  h->pos += *br;
+  return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t mem_seek(lv_fs_drv_t *drv, void *file_p, uint32_t pos, lv_fs_whence_t whence) {
+  struct memHandle *h = static_cast<struct memHandle*>(file_p);
+  int64_t newPos;
+
+  switch (whence) {
+    case LV_FS_SEEK_SET:
+      newPos = pos;
+      break;
+    case LV_FS_SEEK_CUR:
+      newPos = (int64_t)h->pos + (int32_t)pos;
+      break;
+    case LV_FS_SEEK_END:
+      newPos = (int64_t)h->file->size + (int32_t)pos;
+      break;
+    default:
+      return LV_FS_RES_UNKNOWN;
+  }
+
+  if (newPos < 0 || newPos > h->file->size)
+    return LV_FS_RES_UNKNOWN;
+  h->pos = (uint32_t)newPos;
+  return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t mem_tell(lv_fs_drv_t *drv, void *file_p, uint32_t *pos_p) {
+  struct memHandle *h = static_cast<struct memHandle*>(file_p);
+  *pos_p = h->pos;
+  return LV_FS_RES_OK;
+}
+
+void lv_fs_init_mem() {
+  static lv_fs_drv_t drv;
+  lv_fs_drv_init(&drv);
+
+  drv.letter = 'M';
+  drv.open_cb  = mem_open;
+  drv.close_cb = mem_close;
+  drv.read_cb  = mem_read;
+  drv.seek_cb  = mem_seek;
+  drv.tell_cb  = mem_tell;
+  drv.cache_size = 0; // Files are in RAM already
+
+  lv_fs_drv_register(&drv);
+}
+
+/**
+ * @brief       lv_fs_mem_set_budget sets how many bytes the files on the 'M:' RAM drive may take together. Files
+ *              nobody uses are dropped right away (least recently used first) if they take more.
+ *
+ * @param       uint32_t _bytes
+ *              Budget in bytes.
+ */
+void lv_fs_mem_set_budget(uint32_t _bytes) {
+  budget = _bytes;
+  makeRoom(0);
+}
+
+/**
+ * @brief       lv_fs_mem_get_budget returns the budget of the 'M:' RAM drive.
+ *
+ * @return      Budget in bytes.
+ */
+uint32_t lv_fs_mem_get_budget() {
+  return budget;
+}
+
+/**
+ * @brief       lv_fs_mem_load preloads a file from the SD card to the 'M:' RAM drive, so the first use doesn't
+ *              wait for the card. Files are also loaded on their first lv_fs_open("M:..."), this only does it
+ *              earlier. SD card must be initialized with sdCardInit() first.
+ *
+ * @param       const char *_path
+ *              Path of the file on the SD card, the same path opens it on 'M:'.
+ *
+ * @return      True if the file is in RAM, false if it can't be read or doesn't fit into the budget.
+ */
+bool lv_fs_mem_load(const char *_path) {
+  return getFile(_path) != NULL;
+}
+
+/**
+ * @brief       lv_fs_mem_add copies a buffer to the 'M:' RAM drive as a file.
+ *
+ * @param       const char *_name
+ *              Name of the file, opened as "M:<name>". A file with the same name is replaced (removed even if
+ *              the new one doesn't fit).
+ * @param       const void *_data
+ *              Content of the file.
+ * @param       uint32_t _size
+ *              Size of the file in bytes.
+ *
+ * @return      True if added, false if it doesn't fit into the budget, is empty or there is no memory for it.
+ */
+bool lv_fs_mem_add(const char *_name, const void *_data, uint32_t _size) {
+  forgetName(_name);
+  uint8_t *data = allocData(_size);
+  if (data == NULL)
+    return false;
+  memcpy(data, _data, _size);
+  if (addFile(_name, data, _size) == NULL) {
+    trackedFree(MEMORY_TAG_MEM_FS, data, _size);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief       lv_fs_mem_add_download adds a buffer returned by downloadFile() or downloadFileHTTPS() to the 'M:'
+ *              RAM drive without copying it. The drive takes the buffer over and frees it when the file is dropped.
+ *
+ * @param       const char *_name
+ *              Name of the file, opened as "M:<name>". A file with the same name is replaced (removed even if
+ *              the new one doesn't fit).
+ * @param       uint8_t *_buffer
+ *              Buffer with the downloaded file.
+ * @param       int32_t _len
+ *              Length of the file, same as the one returned by the download function.
+ *
+ * @return      True if added, false if it doesn't fit into the budget or there is no memory for its name (buffer
+ *              then still belongs to the caller, free it with freeDownload()).
+ */
+bool lv_fs_mem_add_download(const char *_name, uint8_t *_buffer, int32_t _len) {
+  if (_buffer == NULL || _len <= 0)
+    return false;
+  forgetName(_name);
+  if (!makeRoom(_len) || addFile(_name, _buffer, _len) == NULL)
+    return false;
+  memoryStatsRemove(MEMORY_TAG_DOWNLOAD, _len);
+  memoryStatsAdd(MEMORY_TAG_MEM_FS, _len);
+  return true;
+}
+
+/**
+ * @brief       lv_fs_mem_remove removes a file from the 'M:' RAM drive. The SD card driver calls it for every file
+ *              opened for writing, so 'M:' never serves an old copy of a file changed through 'S:'.
+ *
+ * @param       const char *_name
+ *              Name of the file.
+ *
+ * @return      True if the file was in RAM.
+ *
+ * @note        File that is open or pinned (lv_fs_mem_data(), lv_fs_mem_image_dsc()) can't be opened anymore, its
+ *              memory is freed when it's closed and released.
+ */
+bool lv_fs_mem_remove(const char *_name) {
+  struct memFile *f = findFile(_name);
+  if (f == NULL)
+    return false;
+  forgetFile(f);
+  return true;
+}
+
+/**
+ * @brief       lv_fs_mem_clear removes all files from the 'M:' RAM drive (files in use are freed when released).
+ */
+void lv_fs_mem_clear() {
+  struct memFile *f = files;
+  while (f != NULL) {
+    struct memFile *next = f->next;
+    forgetFile(f);
+    f = next;
+  }
+}
+
+/**
+ * @brief       lv_fs_mem_data returns the content of a file on the 'M:' RAM drive without copying it, the file is
+ *              loaded from the SD card if it's not in RAM. The file is pinned: it's not dropped to stay within the
+ *              budget until lv_fs_mem_release() is called with the returned pointer.
+ *
+ * @param       const char *_name
+ *              Name of the file.
+ * @param       uint32_t *_size
+ *              Size of the file in bytes, set if not NULL.
+ *
+ * @return      Pointer to the content, NULL if the file can't be loaded.
+ */
+const uint8_t *lv_fs_mem_data(const char *_name, uint32_t *_size) {
+  struct memFile *f = getFile(_name);
+  if (f == NULL)
+    return NULL;
+  f->pins++;
+  if (_size != NULL)
+    *_size = f->size;
+  return f->data;
+}
+
+/**
+ * @brief       lv_fs_mem_image_dsc fills an image descriptor that points into the RAM copy of an image file, for
+ *              lv_image_set_src(). LVGL .bin images are drawn straight from it, PNG files are decoded from it
+ *              without reading the file first. The file is pinned like with lv_fs_mem_data(), call
+ *              lv_fs_mem_release(_dsc->data) when the image isn't used anymore.
+ *
+ * @param       const char *_name
+ *              Name of the image file (.bin or .png).
+ * @param       lv_image_dsc_t *_dsc
+ *              Filled descriptor, must stay valid while the image uses it.
+ *
+ * @return      True if filled, false if the file can't be loaded.
+ *
+ * @note        JPG decoder (TJPGD) reads from files only, open JPG files as "M:<name>" instead.
+ */
+bool lv_fs_mem_image_dsc(const char *_name, lv_image_dsc_t *_dsc) {
+  uint32_t size;
+  const uint8_t *data = lv_fs_mem_data(_name, &size);
+  if (data == NULL)
+    return false;
+
+  memset(_dsc, 0, sizeof(lv_image_dsc_t));
+  if (size > sizeof(lv_image_header_t) && data[0] == LV_IMAGE_HEADER_MAGIC) {
+    // LVGL binary image, the header is followed by the pixels (and palette).
+    memcpy(&_dsc->header, data, sizeof(lv_image_header_t));
+    _dsc->data = data + sizeof(lv_image_header_t);
+    _dsc->data_size = size - sizeof(lv_image_header_t);
+  } else {
+    // Encoded image, the decoder reads the size and format from the data.
+    _dsc->header.magic = LV_IMAGE_HEADER_MAGIC;
+    _dsc->header.cf = LV_COLOR_FORMAT_UNKNOWN;
+    _dsc->data = data;
+    _dsc->data_size = size;
+  }
+  return true;
+}
+
+/**
+ * @brief       lv_fs_mem_release unpins a file pinned by lv_fs_mem_data() or lv_fs_mem_image_dsc().
+ *
+ * @param       const void *_data
+ *              Pointer returned by lv_fs_mem_data() (or data of the image descriptor).
+ */
+void lv_fs_mem_release(const void *_data) {
+  const uint8_t *p = (const uint8_t *)_data;
+  for (struct memFile *f = files; f != NULL; f = f->next) {
+    if (f->pins && p >= f->data && p < f->data + f->size) {
+      f->pins--;
+      releaseFile(f);
+      return;
+    }
+  }
+}
+
+/**
+ * @brief       lv_fs_mem_get_stats returns the counters of the 'M:' RAM drive.
+ *
+ * @param       struct memFsStats *_stats
+ *              Filled with the counters.
+ */
+void lv_fs_mem_get_stats(struct memFsStats *_stats) {
+  *_stats = stats;
+  _stats->budget = budget;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "lvgl.h"
+
+// Most bytes the files on the 'M:' RAM drive may take together, can be changed with lv_fs_mem_set_budget().
+#ifndef LV_FS_MEM_BUDGET
+#define LV_FS_MEM_BUDGET (1024 * 1024)
+#endif
+
+/**
+ * @brief       Counters of the 'M:' RAM drive, filled by lv_fs_mem_get_stats().
+ */
+struct memFsStats
+{
+    uint32_t hits;        // Files found in RAM (opens and zero-copy lookups).
+    uint32_t misses;      // Files that were not in RAM.
+    uint32_t loads;       // Files loaded from the SD card.
+    uint32_t bytesLoaded; // Bytes read from the SD card.
+    uint32_t evictions;   // Files dropped to stay within the budget.
+    uint32_t files;       // Files in RAM now.
+    uint32_t bytesUsed;   // Their size.
+    uint32_t budget;
+};
+
+void lv_fs_init_mem();
+void lv_fs_mem_set_budget(uint32_t _bytes);
+uint32_t lv_fs_mem_get_budget();
+bool lv_fs_mem_load(const char *_path);
+bool lv_fs_mem_add(const char *_name, const void *_data, uint32_t _size);
+bool lv_fs_mem_add_download(const char *_name, uint8_t *_buffer, int32_t _len);
+bool lv_fs_mem_remove(const char *_name);
+void lv_fs_mem_clear();
+const uint8_t *lv_fs_mem_data(const char *_name, uint32_t *_size);
+bool lv_fs_mem_image_dsc(const char *_name, lv_image_dsc_t *_dsc);
+void lv_fs_mem_release(const void *_data);
+void lv_fs_mem_get_stats(struct memFsStats *_stats);
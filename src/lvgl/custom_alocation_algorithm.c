@@ -1,19 +1,602 @@
+/**
+ **************************************************
+ * @file        custom_alocation_algorithm.c
+ * @brief       Tiered memory allocator for LVGL. Small blocks (widgets, styles, events, list nodes,
+ *              draw tasks) are served from fixed size class slabs in internal SRAM, larger blocks
+ *              from a TLSF arena in PSRAM and huge buffers directly from the PSRAM heap.
+ *
+ *              Slab page: [header | block | block | ... ], pages are SLAB_PAGE_SIZE aligned so the
+ *              page of any slab block is found by masking its address.
+ *              Direct block: [size | data], size is needed for the memory statistics.
+ *
+ *              Frame arena is a bump-pointer arena for the blocks used only during one refresh (draw
+ *              tasks, layers, masks). Freeing a frame block only decrements the counter of live blocks,
+ *              arena is rewound by lv_frame_reset() at the end of the refresh.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
 #include "custom_allocation_algorithm.h"
+#include "../system/memoryStats/MemoryStats.h"
 #include "esp_heap_caps.h"
+#include "src/lv_conf_internal.h"
+#include "src/osal/lv_os_private.h"
+#include "src/stdlib/builtin/lv_tlsf.h"
+#include "src/stdlib/lv_mem.h"
+#include <string.h>
+
+#if LV_MEM_TRACE
+#include <stdio.h>
+#define MEM_TRACE(...) printf(__VA_ARGS__)
+#else
+#define MEM_TRACE(...)
+#endif
+
+#if LV_USE_OS
+// With parallel draw units the allocator is used from several tasks at once, all tiers share one lock.
+static lv_mutex_t memLock;
+#define MEM_LOCK() lv_mutex_lock(&memLock)
+#define MEM_UNLOCK() lv_mutex_unlock(&memLock)
+#else
+#define MEM_LOCK()
+#define MEM_UNLOCK()
+#endif
+
+// Size classes of the slab pools, blocks larger than the last class go to the PSRAM arena.
+static const uint16_t slabClassSize[LV_MEM_SLAB_CLASS_COUNT] = {16, 32, 48, 64, 96, 128, 192, 256};
+
+// Header at the start of every slab page.
+typedef struct slab_page
+{
+	struct slab_page *next;
+	struct slab_page *prev;
+	void *freeList;
+	uint16_t used;
+	uint16_t capacity;
+	uint8_t sizeClass;
+} slab_page_t;
+
+#define SLAB_HEADER_SIZE ((sizeof(slab_page_t) + 7) & ~7)
+
+// Header of the blocks allocated directly from the PSRAM heap, keeps the data 16 byte aligned.
+#define DIRECT_HEADER_SIZE 16
+
+// Internal SRAM region divided into slab pages.
+static uint8_t *slabBase = NULL;
+static size_t slabSize = 0;
+static slab_page_t *slabFreePages = NULL;
+static slab_page_t *slabPartialPages[LV_MEM_SLAB_CLASS_COUNT];
+
+// PSRAM TLSF arena, grows by adding new pools.
+static lv_tlsf_t arena = NULL;
+static void *arenaPools[LV_MEM_ARENA_MAX_POOLS];
+static lv_pool_t arenaPoolHandle[LV_MEM_ARENA_MAX_POOLS];
+static size_t arenaPoolSize[LV_MEM_ARENA_MAX_POOLS];
+static int arenaPoolCount = 0;
+
+#if LV_USE_FRAME_ARENA
+// Frame arena, offset and live counter are atomic so draw units on the other core can use it too.
+static uint8_t *frameBase = NULL;
+static uint32_t frameOffset = 0;
+static int32_t frameLive = 0;
+#endif
+
+/**
+ * @brief       Finds the smallest size class the block fits in.
+ *
+ * @param       size_t size
+ *              Size of the block in bytes.
+ *
+ * @return      Index of the size class, -1 if block is too large for slabs.
+ */
+static int slabClass(size_t size)
+{
+	for (int i = 0; i < LV_MEM_SLAB_CLASS_COUNT; i++)
+	{
+		if (size <= slabClassSize[i])
+			return i;
+	}
+	return -1;
+}
+
+/**
+ * @brief       Checks if the pointer is inside slab region.
+ */
+static inline int isSlab(const void *p)
+{
+	return slabBase != NULL && (const uint8_t *)p >= slabBase && (const uint8_t *)p < slabBase + slabSize;
+}
+
+/**
+ * @brief       Checks if the pointer is inside the frame arena.
+ */
+static inline int isFrame(const void *p)
+{
+#if LV_USE_FRAME_ARENA
+	return frameBase != NULL && (const uint8_t *)p >= frameBase &&
+	       (const uint8_t *)p < frameBase + LV_MEM_FRAME_ARENA_SIZE;
+#else
+	(void)p;
+	return 0;
+#endif
+}
+
+/**
+ * @brief       Checks if the pointer is inside one of the arena pools.
+ */
+static int isArena(const void *p)
+{
+	for (int i = 0; i < arenaPoolCount; i++)
+	{
+		if ((const uint8_t *)p >= (const uint8_t *)arenaPools[i] &&
+		    (const uint8_t *)p < (const uint8_t *)arenaPools[i] + arenaPoolSize[i])
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief       Takes one free page and prepares it for the size class.
+ *
+ * @return      Pointer to the page, NULL if there are no free pages.
+ */
+static slab_page_t *slabNewPage(int sizeClass)
+{
+	slab_page_t *page = slabFreePages;
+	if (page == NULL)
+		return NULL;
+	slabFreePages = page->next;
+
+	uint16_t blockSize = slabClassSize[sizeClass];
+	page->sizeClass = sizeClass;
+	page->used = 0;
+	page->capacity = (LV_MEM_SLAB_PAGE_SIZE - SLAB_HEADER_SIZE) / blockSize;
+	page->freeList = NULL;
+
+	// Link all blocks of the page into the free list.
+	uint8_t *block = (uint8_t *)page + SLAB_HEADER_SIZE;
+	for (int i = 0; i < page->capacity; i++)
+	{
+		*(void **)block = page->freeList;
+		page->freeList = block;
+		block += blockSize;
+	}
+
+	page->prev = NULL;
+	page->next = slabPartialPages[sizeClass];
+	if (page->next)
+		page->next->prev = page;
+	slabPartialPages[sizeClass] = page;
+
+	return page;
+}
+
+/**
+ * @brief       Removes the page from the list of partially used pages of its size class.
+ */
+static void slabUnlink(slab_page_t *page)
+{
+	if (page->prev)
+		page->prev->next = page->next;
+	else
+		slabPartialPages[page->sizeClass] = page->next;
+	if (page->next)
+		page->next->prev = page->prev;
+	page->next = NULL;
+	page->prev = NULL;
+}
+
+static void *slabAlloc(int sizeClass)
+{
+	slab_page_t *page = slabPartialPages[sizeClass];
+	if (page == NULL)
+		page = slabNewPage(sizeClass);
+	if (page == NULL)
+		return NULL;
+
+	void *p = page->freeList;
+	page->freeList = *(void **)p;
+	page->used++;
+
+	// Page is full, remove it from the list so the next allocation doesn't have to skip it.
+	if (page->freeList == NULL)
+		slabUnlink(page);
+
+	return p;
+}
+
+static void slabFree(void *p)
+{
+	slab_page_t *page = (slab_page_t *)((uintptr_t)p & ~((uintptr_t)LV_MEM_SLAB_PAGE_SIZE - 1));
+
+	// Page was full, it has a free block again.
+	if (page->freeList == NULL)
+	{
+		page->next = slabPartialPages[page->sizeClass];
+		page->prev = NULL;
+		if (page->next)
+			page->next->prev = page;
+		slabPartialPages[page->sizeClass] = page;
+	}
+
+	*(void **)p = page->freeList;
+	page->freeList = p;
+	page->used--;
+
+	// Empty pages go back to the common list, so any size class can use them.
+	if (page->used == 0)
+	{
+		slabUnlink(page);
+		page->next = slabFreePages;
+		slabFreePages = page;
+	}
+}
+
+static inline size_t slabBlockSize(const void *p)
+{
+	slab_page_t *page = (slab_page_t *)((uintptr_t)p & ~((uintptr_t)LV_MEM_SLAB_PAGE_SIZE - 1));
+	return slabClassSize[page->sizeClass];
+}
+
+/**
+ * @brief       Adds a new PSRAM pool into the arena. Pool is always LV_MEM_ARENA_CHUNK_SIZE large,
+ *              blocks larger than LV_MEM_ARENA_MAX_BLOCK never come to the arena so they always fit.
+ *
+ * @return      1 if pool is added, 0 if there is no PSRAM left or all pool slots are used.
+ */
+static int arenaGrow()
+{
+	if (arenaPoolCount >= LV_MEM_ARENA_MAX_POOLS)
+		return 0;
+
+	size_t size = LV_MEM_ARENA_CHUNK_SIZE;
+	void *mem = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+	if (mem == NULL)
+		return 0;
+
+	if (arena == NULL)
+	{
+		arena = lv_tlsf_create_with_pool(mem, size);
+		arenaPoolHandle[arenaPoolCount] = lv_tlsf_get_pool(arena);
+	}
+	else
+	{
+		arenaPoolHandle[arenaPoolCount] = lv_tlsf_add_pool(arena, mem, size);
+	}
+
+	arenaPools[arenaPoolCount] = mem;
+	arenaPoolSize[arenaPoolCount] = size;
+	arenaPoolCount++;
+	return 1;
+}
+
+static void *arenaAlloc(size_t size)
+{
+	void *p = arena ? lv_tlsf_malloc(arena, size) : NULL;
+	if (p == NULL && arenaGrow())
+		p = lv_tlsf_malloc(arena, size);
+	return p;
+}
+
+static void *directAlloc(size_t size)
+{
+	uint8_t *p = heap_caps_malloc(size + DIRECT_HEADER_SIZE, MALLOC_CAP_SPIRAM);
+	if (p == NULL)
+		return NULL;
+	*(size_t *)p = size;
+	return p + DIRECT_HEADER_SIZE;
+}
+
+static void *directRealloc(void *p, size_t size)
+{
+	uint8_t *newP = heap_caps_realloc((uint8_t *)p - DIRECT_HEADER_SIZE, size + DIRECT_HEADER_SIZE, MALLOC_CAP_SPIRAM);
+	if (newP == NULL)
+		return NULL;
+	*(size_t *)newP = size;
+	return newP + DIRECT_HEADER_SIZE;
+}
+
 void lv_mem_init(void)
 {
+#if LV_USE_OS
+	lv_mutex_init(&memLock);
+#endif
+
+	// Slab region is optional, if there is not enough internal SRAM all blocks go to PSRAM.
+	slabSize = LV_MEM_SLAB_POOL_SIZE & ~((size_t)LV_MEM_SLAB_PAGE_SIZE - 1);
+	slabBase = slabSize ? heap_caps_aligned_alloc(LV_MEM_SLAB_PAGE_SIZE, slabSize, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+	                    : NULL;
+	if (slabBase == NULL)
+		slabSize = 0;
+
+	slabFreePages = NULL;
+	for (size_t i = 0; i < slabSize; i += LV_MEM_SLAB_PAGE_SIZE)
+	{
+		slab_page_t *page = (slab_page_t *)(slabBase + i);
+		page->next = slabFreePages;
+		slabFreePages = page;
+	}
+	memset(slabPartialPages, 0, sizeof(slabPartialPages));
+
+	arenaGrow();
+
+#if LV_USE_FRAME_ARENA
+	frameBase = trackedMalloc(MEMORY_TAG_LVGL, LV_MEM_FRAME_ARENA_SIZE, MALLOC_CAP_SPIRAM);
+	frameOffset = 0;
+	frameLive = 0;
+#endif
+}
+
+void lv_mem_deinit(void)
+{
+	if (slabBase)
+		heap_caps_free(slabBase);
+	slabBase = NULL;
+	slabSize = 0;
+
+	for (int i = 0; i < arenaPoolCount; i++)
+		heap_caps_free(arenaPools[i]);
+	arenaPoolCount = 0;
+	arena = NULL;
+
+#if LV_USE_FRAME_ARENA
+	trackedFree(MEMORY_TAG_LVGL, frameBase, LV_MEM_FRAME_ARENA_SIZE);
+	frameBase = NULL;
+#endif
+
+#if LV_USE_OS
+	lv_mutex_delete(&memLock);
+#endif
+}
+
+static void *mallocCore(size_t size)
+{
+	void *p = NULL;
+	int sizeClass = slabClass(size);
+
+	if (sizeClass >= 0)
+	{
+		p = slabAlloc(sizeClass);
+		if (p != NULL)
+			memoryStatsAdd(MEMORY_TAG_LVGL, slabClassSize[sizeClass]);
+	}
+	if (p == NULL && size <= LV_MEM_ARENA_MAX_BLOCK)
+	{
+		p = arenaAlloc(size);
+		if (p != NULL)
+			memoryStatsAdd(MEMORY_TAG_LVGL, lv_tlsf_block_size(p));
+	}
+	if (p == NULL)
+	{
+		p = directAlloc(size);
+		if (p != NULL)
+			memoryStatsAdd(MEMORY_TAG_LVGL, size);
+	}
+
+	MEM_TRACE("a %p %u\n", p, (unsigned)size);
+	return p;
+}
+
+static void freeCore(void *p);
+
+static void *reallocCore(void *p, size_t new_size)
+{
+	void *newP = NULL;
+	size_t oldSize = 0;
+
+	if (p == NULL)
+		return mallocCore(new_size);
+
+	if (isFrame(p))
+	{
+		// Size of frame blocks is not stored, copy up to the end of the arena.
+		newP = mallocCore(new_size);
+		if (newP == NULL)
+			return NULL;
+		oldSize = frameBase + LV_MEM_FRAME_ARENA_SIZE - (uint8_t *)p;
+		memcpy(newP, p, oldSize < new_size ? oldSize : new_size);
+		freeCore(p);
+		return newP;
+	}
+
+	if (isSlab(p))
+	{
+		// Block is large enough, nothing to do.
+		oldSize = slabBlockSize(p);
+		if (new_size <= oldSize)
+		{
+			MEM_TRACE("r %p %p %u\n", p, p, (unsigned)new_size);
+			return p;
+		}
+	}
+	else if (isArena(p))
+	{
+		// TLSF grows the block in place if the next block is free.
+		oldSize = lv_tlsf_block_size(p);
+		if (new_size <= LV_MEM_ARENA_MAX_BLOCK)
+		{
+			newP = lv_tlsf_realloc(arena, p, new_size);
+			if (newP)
+			{
+				memoryStatsRemove(MEMORY_TAG_LVGL, oldSize);
+				memoryStatsAdd(MEMORY_TAG_LVGL, lv_tlsf_block_size(newP));
+				MEM_TRACE("r %p %p %u\n", p, newP, (unsigned)new_size);
+				return newP;
+			}
+		}
+	}
+	else
+	{
+		oldSize = *(size_t *)((uint8_t *)p - DIRECT_HEADER_SIZE);
+		newP = directRealloc(p, new_size);
+		if (newP)
+		{
+			memoryStatsRemove(MEMORY_TAG_LVGL, oldSize);
+			memoryStatsAdd(MEMORY_TAG_LVGL, new_size);
+		}
+		MEM_TRACE("r %p %p %u\n", p, newP, (unsigned)new_size);
+		return newP;
+	}
+
+	// Block has to move into another tier.
+	newP = mallocCore(new_size);
+	if (newP == NULL)
+		return NULL;
+	memcpy(newP, p, oldSize < new_size ? oldSize : new_size);
+	freeCore(p);
+
+	return newP;
+}
+
+static void freeCore(void *p)
+{
+	MEM_TRACE("f %p\n", p);
+
+	if (p == NULL)
+		return;
+
+	if (isFrame(p))
+	{
+		// Memory is reclaimed by lv_frame_reset().
+#if LV_USE_FRAME_ARENA
+		__atomic_fetch_sub(&frameLive, 1, __ATOMIC_RELAXED);
+#endif
+		return;
+	}
+
+	if (isSlab(p))
+	{
+		memoryStatsRemove(MEMORY_TAG_LVGL, slabBlockSize(p));
+		slabFree(p);
+	}
+	else if (isArena(p))
+	{
+		memoryStatsRemove(MEMORY_TAG_LVGL, lv_tlsf_block_size(p));
+		lv_tlsf_free(arena, p);
+	}
+	else
+	{
+		memoryStatsRemove(MEMORY_TAG_LVGL, *(size_t *)((uint8_t *)p - DIRECT_HEADER_SIZE));
+		heap_caps_free((uint8_t *)p - DIRECT_HEADER_SIZE);
+	}
 }
+
 void *lv_malloc_core(size_t size)
 {
-	return heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+	MEM_LOCK();
+	void *p = mallocCore(size);
+	MEM_UNLOCK();
+	return p;
 }
 
 void *lv_realloc_core(void *p, size_t new_size)
 {
-	return heap_caps_realloc(p, new_size, MALLOC_CAP_SPIRAM);
+	MEM_LOCK();
+	void *newP = reallocCore(p, new_size);
+	MEM_UNLOCK();
+	return newP;
 }
 
 void lv_free_core(void *p)
 {
-	heap_caps_free(p);
-}
\ No newline at end of file
+	MEM_LOCK();
+	freeCore(p);
+	MEM_UNLOCK();
+}
+
+/**
+ * @brief       Walker for lv_tlsf_walk_pool(), adds free blocks of the arena into the monitor.
+ */
+static void arenaWalker(void *ptr, size_t size, int used, void *user)
+{
+	lv_mem_monitor_t *mon_p = (lv_mem_monitor_t *)user;
+	(void)ptr;
+
+	if (used)
+	{
+		mon_p->used_cnt++;
+		return;
+	}
+
+	mon_p->free_cnt++;
+	mon_p->free_size += size;
+	if (size > mon_p->free_biggest_size)
+		mon_p->free_biggest_size = size;
+}
+
+#if LV_USE_FRAME_ARENA
+void *lv_frame_malloc(size_t size)
+{
+	if (frameBase == NULL || size > LV_MEM_FRAME_ARENA_SIZE)
+		return lv_malloc(size);
+
+	// Offset moves only when the block fits, so it never passes the end of the arena (and can't wrap around
+	// into blocks that are still used).
+	uint32_t alignedSize = (size + 7) & ~7;
+	uint32_t offset = __atomic_load_n(&frameOffset, __ATOMIC_RELAXED);
+	do
+	{
+		// Arena is full, use the regular allocator.
+		if (offset + alignedSize > LV_MEM_FRAME_ARENA_SIZE)
+			return lv_malloc(size);
+	} while (!__atomic_compare_exchange_n(&frameOffset, &offset, offset + alignedSize, 1, __ATOMIC_RELAXED,
+										  __ATOMIC_RELAXED));
+
+	__atomic_fetch_add(&frameLive, 1, __ATOMIC_RELAXED);
+	return frameBase + offset;
+}
+
+void *lv_frame_malloc_zeroed(size_t size)
+{
+	void *p = lv_frame_malloc(size);
+	if (p != NULL)
+		memset(p, 0, size);
+	return p;
+}
+
+void lv_frame_reset(void)
+{
+	// Some frame block is still used (e.g. a layer that will be finished in the next refresh), keep
+	// the arena as it is, new blocks go to the regular allocator until everything is freed.
+	if (__atomic_load_n(&frameLive, __ATOMIC_RELAXED) != 0)
+		return;
+
+	__atomic_store_n(&frameOffset, 0, __ATOMIC_RELAXED);
+}
+#endif
+
+void lv_mem_monitor_core(lv_mem_monitor_t *mon_p)
+{
+	MEM_LOCK();
+
+	// Slabs, only whole free pages are counted as free memory.
+	mon_p->total_size = slabSize;
+	for (slab_page_t *page = slabFreePages; page != NULL; page = page->next)
+	{
+		mon_p->free_cnt++;
+		mon_p->free_size += LV_MEM_SLAB_PAGE_SIZE;
+	}
+
+	// PSRAM arena.
+	for (int i = 0; i < arenaPoolCount; i++)
+	{
+		mon_p->total_size += arenaPoolSize[i];
+		lv_tlsf_walk_pool(arenaPoolHandle[i], arenaWalker, mon_p);
+	}
+
+	if (mon_p->total_size)
+		mon_p->used_pct = 100 - (100U * mon_p->free_size) / mon_p->total_size;
+	if (mon_p->free_size)
+		mon_p->frag_pct = 100 - (100U * mon_p->free_biggest_size) / mon_p->free_size;
+
+	MEM_UNLOCK();
+}
+
+lv_result_t lv_mem_test_core(void)
+{
+	MEM_LOCK();
+	int failed = arena && lv_tlsf_check(arena);
+	MEM_UNLOCK();
+
+	return failed ? LV_RESULT_INVALID : LV_RESULT_OK;
+}
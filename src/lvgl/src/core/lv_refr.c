@@ -436,6 +436,9 @@ refr_finish:
     lv_draw_sw_mask_cleanup();
 #endif
 
+    /*Everything allocated for this refresh is freed, start the next one with an empty frame arena*/
+    lv_frame_reset();
+
     lv_display_send_event(disp_refr, LV_EVENT_REFR_READY, NULL);
 
     LV_TRACE_REFR("finished");
@@ -899,7 +902,7 @@ static void refr_area(const lv_area_t * area_p, int32_t y_offset)
         /* Don't draw to the layers buffer of the display but create smaller dummy layers which are using the
          * display's layer buffer. These will be the tiles. By using tiles it's more likely that there will
          * be independent areas for each draw unit. */
-        lv_layer_t * tile_layers = lv_malloc(tile_cnt * sizeof(lv_layer_t));
+        lv_layer_t * tile_layers = lv_frame_malloc(tile_cnt * sizeof(lv_layer_t));
         LV_ASSERT_MALLOC(tile_layers);
         if(tile_layers == NULL) {
             disp_refr->refreshed_area = *area_p;
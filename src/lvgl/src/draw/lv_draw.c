@@ -39,6 +39,9 @@ static bool is_independent(lv_layer_t * layer, lv_draw_task_t * t_check, uint8_t
 static void cleanup_task(lv_draw_task_t * t, lv_display_t * disp);
 static inline size_t get_draw_dsc_size(lv_draw_task_type_t type);
 static lv_draw_task_t * get_first_available_task(lv_layer_t * layer);
+#if LV_USE_FRAME_ARENA
+static void * frame_buf_malloc(size_t size_bytes, lv_color_format_t color_format);
+#endif
 
 #if LV_LOG_LEVEL <= LV_LOG_LEVEL_INFO
 static inline uint32_t get_layer_size_kb(uint32_t size_byte)
@@ -102,7 +105,7 @@ lv_draw_task_t * lv_draw_add_task(lv_layer_t * layer, const lv_area_t * coords,
     LV_PROFILER_DRAW_BEGIN;
     size_t dsc_size = get_draw_dsc_size(type);
     LV_ASSERT_FORMAT_MSG(dsc_size > 0, "Draw task size is 0 for type %d", type);
-    lv_draw_task_t * new_task = lv_malloc_zeroed(LV_ALIGN_UP(sizeof(lv_draw_task_t), 8) + dsc_size);
+    lv_draw_task_t * new_task = lv_frame_malloc_zeroed(LV_ALIGN_UP(sizeof(lv_draw_task_t), 8) + dsc_size);
     LV_ASSERT_MALLOC(new_task);
     new_task->area = *coords;
     new_task->_real_area = *coords;
@@ -429,7 +432,7 @@ void lv_layer_reset(lv_layer_t * layer)
 lv_layer_t * lv_draw_layer_create(lv_layer_t * parent_layer, lv_color_format_t color_format, const lv_area_t * area)
 {
     LV_PROFILER_DRAW_BEGIN;
-    lv_layer_t * new_layer = lv_malloc_zeroed(sizeof(lv_layer_t));
+    lv_layer_t * new_layer = lv_frame_malloc_zeroed(sizeof(lv_layer_t));
     LV_ASSERT_MALLOC(new_layer);
     if(new_layer == NULL) {
         LV_PROFILER_DRAW_END;
@@ -498,7 +501,15 @@ void * lv_draw_layer_alloc_buf(lv_layer_t * layer)
     }
 #endif
 
+#if LV_USE_FRAME_ARENA
+    /*Layers live only during one refresh, allocate their buffers from the frame arena*/
+    static lv_draw_buf_handlers_t frame_buf_handlers;
+    frame_buf_handlers = *lv_draw_buf_get_handlers();
+    frame_buf_handlers.buf_malloc_cb = frame_buf_malloc;
+    layer->draw_buf = lv_draw_buf_create_ex(&frame_buf_handlers, w, h, layer->color_format, 0);
+#else
     layer->draw_buf = lv_draw_buf_create(w, h, layer->color_format, 0);
+#endif
 
     if(layer->draw_buf == NULL) {
         LV_LOG_WARN("Allocating layer buffer failed. Try later");
@@ -541,6 +552,16 @@ void lv_draw_task_get_area(const lv_draw_task_t * t, lv_area_t * area)
  *   STATIC FUNCTIONS
  **********************/
 
+#if LV_USE_FRAME_ARENA
+static void * frame_buf_malloc(size_t size_bytes, lv_color_format_t color_format)
+{
+    LV_UNUSED(color_format);
+
+    /*Allocate larger memory to be sure it can be aligned as needed*/
+    return lv_frame_malloc(size_bytes + LV_DRAW_BUF_ALIGN - 1);
+}
+#endif
+
 /**
  * Check if there are older draw task overlapping the area of `t_check`
  * @param layer         the draw ctx to search in
@@ -33,6 +33,12 @@
 #define LV_COLOR_DEPTH 16
 #endif
 
+/** 1: E-ink profile. Builds only the blend paths the panels need and applies the flat e-ink theme
+ *  (no shadows, gradients or transitions), see `examples/Inkplate6/Diagnostics/EinkProfileBenchmark`. */
+#ifndef INKPLATE_EINK_PROFILE
+#define INKPLATE_EINK_PROFILE 0
+#endif
+
 /*=========================
    STDLIB WRAPPER SETTINGS
  *=========================*/
@@ -83,6 +89,42 @@
 
 #endif  /*LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN*/
 
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM
+    /** Tiered allocator in `custom_alocation_algorithm.c`:
+     *  - blocks up to 256 bytes come from size class slabs in internal SRAM,
+     *  - blocks up to `LV_MEM_ARENA_MAX_BLOCK` come from a TLSF arena in PSRAM,
+     *  - larger blocks are allocated directly from the PSRAM heap. */
+    #define LV_USE_TLSF_ARENA 1
+
+    /** [bytes] Internal SRAM reserved for the slabs. 0: disable slabs. */
+    #define LV_MEM_SLAB_POOL_SIZE (32 * 1024U)
+
+    /** [bytes] Size (and alignment) of one slab page. Must be power of 2. */
+    #define LV_MEM_SLAB_PAGE_SIZE 2048
+
+    /** Number of slab size classes (16, 32, 48, 64, 96, 128, 192, 256 bytes). */
+    #define LV_MEM_SLAB_CLASS_COUNT 8
+
+    /** [bytes] Size of one PSRAM pool of the TLSF arena. New pool is added when the arena is full. */
+    #define LV_MEM_ARENA_CHUNK_SIZE (256 * 1024U)
+
+    /** Max number of PSRAM pools in the TLSF arena. */
+    #define LV_MEM_ARENA_MAX_POOLS 16
+
+    /** [bytes] Larger blocks skip the arena and are allocated directly from the PSRAM heap. */
+    #define LV_MEM_ARENA_MAX_BLOCK (LV_MEM_ARENA_CHUNK_SIZE / 2)
+
+    /** 1: Allocate draw tasks, layers and mask buffers from a bump-pointer arena that is reset after every refresh. */
+    #define LV_USE_FRAME_ARENA 1
+
+    /** [bytes] Size of the frame arena (in PSRAM). If it's full, blocks are allocated from the regular tiers. */
+    #define LV_MEM_FRAME_ARENA_SIZE (64 * 1024U)
+
+    /** 1: Print every allocation as a trace line (`a`, `r`, `f`) that can be replayed by
+     *  `extras/allocatorBenchmark`. */
+    #define LV_MEM_TRACE 0
+#endif  /*LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM*/
+
 /*====================
    HAL SETTINGS
  *====================*/
@@ -107,7 +149,18 @@
  * - LV_OS_MQX
  * - LV_OS_SDL2
  * - LV_OS_CUSTOM */
+
+/** 1: Render with two software draw units, one on each ESP32 core (uses the FreeRTOS OSAL).
+ *  LVGL calls from other tasks must then be wrapped in `lv_lock()` / `lv_unlock()`. */
+#ifndef INKPLATE_PARALLEL_DRAW
+#define INKPLATE_PARALLEL_DRAW 0
+#endif
+
+#if INKPLATE_PARALLEL_DRAW
+#define LV_USE_OS   LV_OS_FREERTOS
+#else
 #define LV_USE_OS   LV_OS_NONE
+#endif
 
 #if LV_USE_OS == LV_OS_CUSTOM
     #define LV_OS_CUSTOM_INCLUDE <stdint.h>
@@ -119,6 +172,9 @@
      * RTOS task notifications can only be used when there is only one task that can be the recipient of the event.
      */
     #define LV_USE_FREERTOS_TASK_NOTIFY 1
+
+    /** 1: Pin LVGL threads to the cores in round-robin order, so every draw unit runs on its own core. */
+    #define LV_FREERTOS_PIN_THREADS 1
 #endif
 
 /*========================
@@ -153,8 +209,9 @@
 
 /** Stack size of drawing thread.
  * NOTE: If FreeType or ThorVG is enabled, it is recommended to set it to 32KB or more.
+ * Task stacks are allocated from internal SRAM, every draw unit has its own.
  */
-#define LV_DRAW_THREAD_STACK_SIZE    (64 * 1024)         /**< [bytes]*/
+#define LV_DRAW_THREAD_STACK_SIZE    (16 * 1024)         /**< [bytes]*/
 
 /** Thread priority of the drawing task.
  *  Higher values mean higher priority.
@@ -173,6 +230,25 @@
      * - gradients use RGB888
      * - bitmaps with transparency may use ARGB8888
      */
+    #if INKPLATE_EINK_PROFILE
+    /* E-ink profile: the display is L8 (grayscale boards) or RGB565 (color boards). RGB888 and ARGB8888
+     * stay, gradients, JPEG/PNG decoders and opacity layers use them. A8 is needed for fonts and masks. */
+    #if LV_COLOR_DEPTH == 16
+    #define LV_DRAW_SW_SUPPORT_RGB565       1
+    #else
+    #define LV_DRAW_SW_SUPPORT_RGB565       0
+    #endif
+    #define LV_DRAW_SW_SUPPORT_RGB565_SWAPPED       0
+    #define LV_DRAW_SW_SUPPORT_RGB565A8     0
+    #define LV_DRAW_SW_SUPPORT_RGB888       1
+    #define LV_DRAW_SW_SUPPORT_XRGB8888     0
+    #define LV_DRAW_SW_SUPPORT_ARGB8888     1
+    #define LV_DRAW_SW_SUPPORT_ARGB8888_PREMULTIPLIED 0
+    #define LV_DRAW_SW_SUPPORT_L8           1
+    #define LV_DRAW_SW_SUPPORT_AL88         0
+    #define LV_DRAW_SW_SUPPORT_A8           1
+    #define LV_DRAW_SW_SUPPORT_I1           1
+    #else
     #define LV_DRAW_SW_SUPPORT_RGB565       1
     #define LV_DRAW_SW_SUPPORT_RGB565_SWAPPED       1
     #define LV_DRAW_SW_SUPPORT_RGB565A8     1
@@ -184,6 +260,7 @@
     #define LV_DRAW_SW_SUPPORT_AL88         1
     #define LV_DRAW_SW_SUPPORT_A8           1
     #define LV_DRAW_SW_SUPPORT_I1           1
+    #endif
 
     /* The threshold of the luminance to consider a pixel as
      * active in indexed color format */
@@ -192,7 +269,11 @@
     /** Set number of draw units.
      *  - > 1 requires operating system to be enabled in `LV_USE_OS`.
      *  - > 1 means multiple threads will render the screen in parallel. */
+    #if INKPLATE_PARALLEL_DRAW
+    #define LV_DRAW_SW_DRAW_UNIT_CNT    2
+    #else
     #define LV_DRAW_SW_DRAW_UNIT_CNT    1
+    #endif
 
     /** Use Arm-2D to accelerate software (sw) rendering. */
     #define LV_USE_DRAW_ARM2D_SYNC      0
@@ -826,10 +907,18 @@
     #define LV_THEME_DEFAULT_DARK 0
 
     /** 1: Enable grow on press */
+    #if INKPLATE_EINK_PROFILE
+    #define LV_THEME_DEFAULT_GROW 0
+    #else
     #define LV_THEME_DEFAULT_GROW 1
+    #endif
 
-    /** Default transition time in ms. */
+    /** Default transition time in ms. Every transition frame is a panel refresh on e-ink. */
+    #if INKPLATE_EINK_PROFILE
+    #define LV_THEME_DEFAULT_TRANSITION_TIME 0
+    #else
     #define LV_THEME_DEFAULT_TRANSITION_TIME 80
+    #endif
 #endif /*LV_USE_THEME_DEFAULT*/
 
 /** A very simple theme that is a good starting point for a custom theme */
@@ -893,7 +982,7 @@
     #define LV_FS_FATFS_CACHE_SIZE 0    /**< >0 to cache this number of bytes in lv_fs_read() */
 #endif
 
-/** API for memory-mapped file access. */
+/** API for memory-mapped file access. 'M' is used by the RAM drive of the library (MemFS_driver_implementation.h). */
 #define LV_USE_FS_MEMFS 0
 #if LV_USE_FS_MEMFS
     #define LV_FS_MEMFS_LETTER '\0'     /**< Set an upper-case driver-identifier letter for this driver (e.g. 'A'). */
@@ -1072,11 +1161,18 @@
     #endif
 #endif /*LV_USE_SYSMON*/
 
+/** 1: Enable the Inkplate profiler (`system/profiler`). Records LVGL's `LV_PROFILER_*` hooks and the
+ *  library trace points (flush, dithering, partial diff, waveform phases, panel power, SD and network I/O)
+ *  into a ring buffer that can be dumped as Chrome trace JSON with `profilerDump()`. */
+#ifndef INKPLATE_PROFILER
+#define INKPLATE_PROFILER 0
+#endif
+
 /** 1: Enable runtime performance profiler */
-#define LV_USE_PROFILER 0
+#define LV_USE_PROFILER INKPLATE_PROFILER
 #if LV_USE_PROFILER
     /** 1: Enable the built-in profiler */
-    #define LV_USE_PROFILER_BUILTIN 1
+    #define LV_USE_PROFILER_BUILTIN 0
     #if LV_USE_PROFILER_BUILTIN
         /** Default profiler trace buffer size */
         #define LV_PROFILER_BUILTIN_BUF_SIZE (16 * 1024)     /**< [bytes] */
@@ -1084,20 +1180,20 @@
         #define LV_USE_PROFILER_BUILTIN_POSIX 0 /**< Enable POSIX profiler port */
     #endif
 
-    /** Header to include for profiler */
-    #define LV_PROFILER_INCLUDE "lvgl/src/misc/lv_profiler_builtin.h"
+    /** Header to include for profiler (relative to `src/misc/lv_profiler.h`) */
+    #define LV_PROFILER_INCLUDE "../../../system/profiler/Profiler.h"
 
     /** Profiler start point function */
-    #define LV_PROFILER_BEGIN    LV_PROFILER_BUILTIN_BEGIN
+    #define LV_PROFILER_BEGIN    PROFILER_BEGIN(__func__)
 
     /** Profiler end point function */
-    #define LV_PROFILER_END      LV_PROFILER_BUILTIN_END
+    #define LV_PROFILER_END      PROFILER_END(__func__)
 
     /** Profiler start point function with custom tag */
-    #define LV_PROFILER_BEGIN_TAG LV_PROFILER_BUILTIN_BEGIN_TAG
+    #define LV_PROFILER_BEGIN_TAG(tag) PROFILER_BEGIN(tag)
 
     /** Profiler end point function with custom tag */
-    #define LV_PROFILER_END_TAG   LV_PROFILER_BUILTIN_END_TAG
+    #define LV_PROFILER_END_TAG(tag)   PROFILER_END(tag)
 
     /*Enable layout profiler*/
     #define LV_PROFILER_LAYOUT 1
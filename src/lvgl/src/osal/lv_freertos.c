@@ -90,6 +90,20 @@ lv_result_t lv_thread_init(lv_thread_t * pxThread,  const char * const name,
     pxThread->pTaskArg = xAttr;
     pxThread->pvStartRoutine = pvStartRoutine;
 
+#if defined(ESP_PLATFORM) && defined(LV_FREERTOS_PIN_THREADS) && LV_FREERTOS_PIN_THREADS
+    /* Spread the threads (e.g. SW draw units) over the cores, so they really run in parallel. */
+    static uint32_t ulNextCore = 0;
+    BaseType_t xCore = (BaseType_t)(ulNextCore++ % portNUM_PROCESSORS);
+
+    BaseType_t xTaskCreateStatus = xTaskCreatePinnedToCore(
+                                       prvRunThread,
+                                       name,
+                                       (configSTACK_DEPTH_TYPE)(usStackSize / sizeof(StackType_t)),
+                                       (void *)pxThread,
+                                       tskIDLE_PRIORITY + xSchedPriority,
+                                       &pxThread->xTaskHandle,
+                                       xCore);
+#else
     BaseType_t xTaskCreateStatus = xTaskCreate(
                                        prvRunThread,
                                        name,
@@ -97,6 +111,7 @@ lv_result_t lv_thread_init(lv_thread_t * pxThread,  const char * const name,
                                        (void *)pxThread,
                                        tskIDLE_PRIORITY + xSchedPriority,
                                        &pxThread->xTaskHandle);
+#endif
 
     /* Ensure that the FreeRTOS task was successfully created. */
     if(xTaskCreateStatus != pdPASS) {
@@ -1,7 +1,8 @@
 #include "../../lv_conf_internal.h"
-#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN || LV_USE_TLSF_ARENA
 
 #include "lv_tlsf_private.h"
+#include "lv_tlsf.h"
 #include "../../stdlib/lv_string.h"
 #include "../../misc/lv_log.h"
 #include "../../misc/lv_assert.h"
@@ -10,7 +11,11 @@
 #undef  printf
 #define printf LV_LOG_ERROR
 
-#define TLSF_MAX_POOL_SIZE (LV_MEM_SIZE + LV_MEM_POOL_EXPAND_SIZE)
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+    #define TLSF_MAX_POOL_SIZE (LV_MEM_SIZE + LV_MEM_POOL_EXPAND_SIZE)
+#else
+    #define TLSF_MAX_POOL_SIZE LV_MEM_ARENA_CHUNK_SIZE
+#endif
 
 #if !defined(_DEBUG)
     #define _DEBUG 0
@@ -1242,4 +1247,4 @@ void * lv_tlsf_realloc(lv_tlsf_t tlsf, void * ptr, size_t size)
     return p;
 }
 
-#endif /*LV_STDLIB_BUILTIN*/
+#endif /*LV_STDLIB_BUILTIN || LV_USE_TLSF_ARENA*/
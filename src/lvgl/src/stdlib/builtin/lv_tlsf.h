@@ -1,5 +1,5 @@
 #include "../../lv_conf_internal.h"
-#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN || LV_USE_TLSF_ARENA
 
 #ifndef LV_TLSF_H
 #define LV_TLSF_H
@@ -93,4 +93,4 @@ int lv_tlsf_check_pool(lv_pool_t pool);
 
 #endif /*LV_TLSF_H*/
 
-#endif /*LV_STDLIB_BUILTIN*/
+#endif /*LV_STDLIB_BUILTIN || LV_USE_TLSF_ARENA*/
@@ -96,6 +96,34 @@ void * lv_malloc_zeroed(size_t size);
  */
 void lv_free(void * data);
 
+#if LV_USE_FRAME_ARENA
+/**
+ * Allocate memory that is used only during one refresh (draw tasks, layers, masks).
+ * It comes from a bump-pointer arena which is reset at the end of the refresh.
+ * The block can be released with `lv_free()` as usual. If the arena is full, `lv_malloc()` is used.
+ * @param size requested size in bytes
+ * @return pointer to allocated uninitialized memory, or NULL on failure
+ */
+void * lv_frame_malloc(size_t size);
+
+/**
+ * Same as `lv_frame_malloc()` but the memory is zeroed.
+ * @param size requested size in bytes
+ * @return pointer to allocated zeroed memory, or NULL on failure
+ */
+void * lv_frame_malloc_zeroed(size_t size);
+
+/**
+ * Reset the frame arena. Called at the end of every refresh.
+ * The arena is not reset if some of its blocks are still not freed.
+ */
+void lv_frame_reset(void);
+#else
+#define lv_frame_malloc(size)        lv_malloc(size)
+#define lv_frame_malloc_zeroed(size) lv_malloc_zeroed(size)
+#define lv_frame_reset()
+#endif
+
 /**
  * Reallocate a memory with a new size. The old content will be kept.
  * @param data_p pointer to an allocated memory.
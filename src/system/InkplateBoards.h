@@ -15,7 +15,9 @@
 #define __INKPLATE_BOARDS_H__
 
 // Board selector. It only includes files for selected board.
-#ifdef ARDUINO_INKPLATE10V2
+#ifdef INKPLATE_SIMULATOR
+#include "SimDriver.h"
+#elif defined(ARDUINO_INKPLATE10V2)
 #include "../boards/Inkplate10/Inkplate10Driver.h"
 #elif defined(ARDUINO_INKPLATE6V2)
 #include "boards/Inkplate6/Inkplate6Driver.h"
@@ -17,6 +17,8 @@
  ***************************************************/
 
 #include "NetworkController.h"
+#include "../memoryStats/MemoryStats.h"
+#include "../profiler/Profiler.h"
 
 /**
  * @brief       Connects Inkplate to a provided WiFi network.
@@ -387,6 +389,8 @@ char *NetworkController::getPathToResourceFromURL(const char *urlToGetPathToReso
  */
 uint8_t *NetworkController::downloadFileHTTPS(const char *url, int32_t *defaultLen)
 {
+    PROFILER_SCOPE("downloadFileHTTPS");
+
     if (!isConnected())
         return NULL;
 
@@ -437,7 +441,7 @@ uint8_t *NetworkController::downloadFileHTTPS(const char *url, int32_t *defaultL
     else
         *defaultLen = size;
 
-    uint8_t *buffer = (uint8_t *)ps_malloc(size);
+    uint8_t *buffer = (uint8_t *)trackedMalloc(MEMORY_TAG_DOWNLOAD, size, MALLOC_CAP_SPIRAM);
     uint8_t *buffPtr = buffer;
 
     if (httpCode == HTTP_CODE_OK)
@@ -492,13 +496,15 @@ uint8_t *NetworkController::downloadFileHTTPS(const char *url, int32_t *defaultL
  */
 uint8_t *NetworkController::downloadFile(WiFiClient *s, int32_t len)
 {
+    PROFILER_SCOPE("downloadFile");
+
     if (!isConnected())
         return NULL;
 
     bool sleep = WiFi.getSleep();
     WiFi.setSleep(false);
 
-    uint8_t *buffer = (uint8_t *)ps_malloc(len);
+    uint8_t *buffer = (uint8_t *)trackedMalloc(MEMORY_TAG_DOWNLOAD, len, MALLOC_CAP_SPIRAM);
     uint8_t *buffPtr = buffer;
 
     uint8_t buff[128] = {0};
@@ -537,6 +543,8 @@ uint8_t *NetworkController::downloadFile(WiFiClient *s, int32_t len)
  */
 uint8_t *NetworkController::downloadFile(const char *url, int32_t *defaultLen)
 {
+    PROFILER_SCOPE("downloadFile");
+
     if (!isConnected())
         return NULL;
 
@@ -562,7 +570,7 @@ uint8_t *NetworkController::downloadFile(const char *url, int32_t *defaultLen)
     else
         *defaultLen = size;
 
-    uint8_t *buffer = (uint8_t *)ps_malloc(size);
+    uint8_t *buffer = (uint8_t *)trackedMalloc(MEMORY_TAG_DOWNLOAD, size, MALLOC_CAP_SPIRAM);
     uint8_t *buffPtr = buffer;
 
     if (httpCode == HTTP_CODE_OK)
@@ -598,6 +606,21 @@ uint8_t *NetworkController::downloadFile(const char *url, int32_t *defaultLen)
     return buffer;
 }
 
+/**
+ * @brief       Frees the buffer returned by downloadFile() or downloadFileHTTPS(). Buffer can also be
+ *              freed with free(), but then it stays counted in the memory statistics.
+ *
+ * @param       uint8_t *buffer
+ *              Buffer with the downloaded file
+ *
+ * @param       int32_t len
+ *              Length of the file, same as the one returned by the download function
+ */
+void NetworkController::freeDownload(uint8_t *buffer, int32_t len)
+{
+    trackedFree(MEMORY_TAG_DOWNLOAD, buffer, len);
+}
+
 /**
  * @brief       Set if Inkplate should follow redirects when making HTTP requests
  *
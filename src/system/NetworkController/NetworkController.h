@@ -45,6 +45,7 @@ class NetworkController
     uint8_t *downloadFile(const char *url, int32_t *defaultLen);
     uint8_t *downloadFileHTTPS(const char *url, int32_t *defaultLen);
     uint8_t *downloadFile(WiFiClient *url, int32_t len);
+    void freeDownload(uint8_t *buffer, int32_t len);
     void applyHttpsCertificate(const char *certificate);
 
     // The default parameters for nptServer here are cast to (char*) to keep the compiler happy
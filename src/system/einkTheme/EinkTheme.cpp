@@ -0,0 +1,95 @@
+/**
+ **************************************************
+ * @file        EinkTheme.cpp
+ * @brief       Flat LVGL theme for e-paper. Uses the default theme and removes shadows, gradients and
+ *              transitions from it, these only add gray fringes, dithering noise and extra panel refreshes.
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#include "EinkTheme.h"
+#include "../../lvgl/src/themes/lv_theme_private.h"
+
+// There is only one display, so the theme and its style are static.
+static lv_theme_t einkTheme;
+static lv_style_t flatStyle;
+static bool inited = false;
+
+/**
+ * @brief       applyCallback is called by LVGL for every new object, after the default theme has added its
+ *              styles. The flat style is added for the states the default theme styles, later added styles win.
+ *
+ * @param       lv_theme_t *_th
+ *              This theme.
+ * @param       lv_obj_t *_obj
+ *              New object.
+ */
+static void applyCallback(lv_theme_t *_th, lv_obj_t *_obj)
+{
+    LV_UNUSED(_th);
+
+    lv_obj_add_style(_obj, &flatStyle, LV_PART_MAIN);
+    lv_obj_add_style(_obj, &flatStyle, LV_PART_MAIN | LV_STATE_PRESSED);
+    lv_obj_add_style(_obj, &flatStyle, LV_PART_MAIN | LV_STATE_CHECKED);
+    lv_obj_add_style(_obj, &flatStyle, LV_PART_INDICATOR);
+    lv_obj_add_style(_obj, &flatStyle, LV_PART_KNOB);
+}
+
+/**
+ * @brief       einkThemeInit initializes the e-ink theme. Set it with lv_display_set_theme(), Inkplate::begin()
+ *              does it automatically if INKPLATE_EINK_PROFILE is set in lv_conf.h.
+ *
+ * @param       lv_display_t *_disp
+ *              LVGL display, used by the default theme for DPI scaling.
+ *
+ * @return      Pointer to the theme, NULL if the default theme is disabled in lv_conf.h.
+ */
+lv_theme_t *einkThemeInit(lv_display_t *_disp)
+{
+#if LV_USE_THEME_DEFAULT
+    lv_theme_t *parent = lv_theme_default_init(_disp, lv_palette_main(LV_PALETTE_GREY), lv_color_black(),
+                                               LV_THEME_DEFAULT_DARK, LV_FONT_DEFAULT);
+    if (parent == NULL)
+        return NULL;
+
+    if (!inited)
+    {
+        lv_style_init(&flatStyle);
+        lv_style_set_shadow_width(&flatStyle, 0);
+        lv_style_set_shadow_opa(&flatStyle, LV_OPA_TRANSP);
+        lv_style_set_bg_grad_dir(&flatStyle, LV_GRAD_DIR_NONE);
+        lv_style_set_transition(&flatStyle, NULL);
+    }
+
+    // Fonts and colors are the same as in the parent, only the look of the objects is changed.
+    einkTheme = *parent;
+    lv_theme_set_parent(&einkTheme, parent);
+    lv_theme_set_apply_cb(&einkTheme, applyCallback);
+    inited = true;
+
+    return &einkTheme;
+#else
+    LV_UNUSED(_disp);
+    return NULL;
+#endif
+}
+
+/**
+ * @brief       einkThemeIsInited checks if einkThemeInit() was called.
+ *
+ * @return      true if the theme is initialized.
+ */
+bool einkThemeIsInited()
+{
+    return inited;
+}
@@ -0,0 +1,29 @@
+/**
+ **************************************************
+ * @file        EinkTheme.h
+ * @brief       Flat LVGL theme for e-paper. Uses the default theme and removes shadows, gradients and
+ *              transitions from it, these only add gray fringes, dithering noise and extra panel refreshes.
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#ifndef __EINK_THEME_H__
+#define __EINK_THEME_H__
+
+#include "Arduino.h"
+#include "../../lvgl/lvgl.h"
+
+lv_theme_t *einkThemeInit(lv_display_t *_disp);
+bool einkThemeIsInited();
+
+#endif
@@ -18,7 +18,24 @@
 
 #include "Esp.h"
 #include "../../boardSelect.h"
+#include "../memoryStats/MemoryStats.h"
 #ifdef USES_I2S
+
+// State of the interrupt driven line sender. There is only one I2S used for the EPD, so it's shared.
+// Queue holds DMA descriptors of the lines waiting to be sent (CPU built lines or constant clean lines).
+static volatile i2s_dev_t *_senderI2S = NULL;
+static volatile lldesc_s *_senderQueue[I2S_LINE_BUFFERS];
+static intr_handle_t _senderIntr = NULL;
+static SemaphoreHandle_t _senderFree = NULL;
+static portMUX_TYPE _senderLock = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint8_t _senderHead = 0;
+static volatile uint8_t _senderTail = 0;
+static volatile uint8_t _senderPending = 0;
+static volatile bool _senderBusy = false;
+
+// Pixel data for each of the clean patterns (white, black, discharge, skip).
+static const uint8_t _cleanPatterns[4] = {B10101010, B01010101, B00000000, B11111111};
+
 /**
  * @brief       Function Intializes I2S driver of the ESP32
  *
@@ -96,7 +113,8 @@ void IRAM_ATTR I2SInit(i2s_dev_t *_i2sDev, uint8_t _clockDivider)
 }
 
 /**
- * @brief       Function sedns data with I2S DMA driver.
+ * @brief       Function starts sending one line with I2S DMA driver. It does not wait for the end of the
+ *              transmission.
  *
  * @param       i2s_dev_t *_i2sDev
  *              Pointer of the selected I2S driver
@@ -107,7 +125,7 @@ void IRAM_ATTR I2SInit(i2s_dev_t *_i2sDev, uint8_t _clockDivider)
  * @note        Function must be declared static to fit into Instruction RAM of the ESP32. Also, DMA descriptor must be
  * already configured!
  */
-void IRAM_ATTR sendDataI2S(i2s_dev_t *_i2sDev, volatile lldesc_s *_dmaDecs)
+static void IRAM_ATTR startDataI2S(i2s_dev_t *_i2sDev, volatile lldesc_s *_dmaDecs)
 {
     // Stop any on-going transmission (just in case).
     _i2sDev->out_link.stop = 1;
@@ -141,6 +159,23 @@ void IRAM_ATTR sendDataI2S(i2s_dev_t *_i2sDev, volatile lldesc_s *_dmaDecs)
 
     // Start sending I2S data out.
     _i2sDev->conf.tx_start = 1;
+}
+
+/**
+ * @brief       Function sedns data with I2S DMA driver.
+ *
+ * @param       i2s_dev_t *_i2sDev
+ *              Pointer of the selected I2S driver
+ *
+ *              lldesc_s *_dmaDecs
+ *              Pointer to the DMA descriptor.
+ *
+ * @note        Function must be declared static to fit into Instruction RAM of the ESP32. Also, DMA descriptor must be
+ * already configured!
+ */
+void IRAM_ATTR sendDataI2S(i2s_dev_t *_i2sDev, volatile lldesc_s *_dmaDecs)
+{
+    startDataI2S(_i2sDev, _dmaDecs);
 
     while (!_i2sDev->int_raw.out_total_eof)
         ;
@@ -153,6 +188,219 @@ void IRAM_ATTR sendDataI2S(i2s_dev_t *_i2sDev, volatile lldesc_s *_dmaDecs)
     _i2sDev->out_link.start = 0;
 }
 
+/**
+ * @brief       I2S interrupt of the line sender. When the line is sent, it ends the row on the panel
+ *              (same as vscan_end()) and starts sending the next queued line.
+ *
+ * @param       void *_arg
+ *              Not used.
+ */
+static void IRAM_ATTR i2sLineSenderISR(void *_arg)
+{
+    BaseType_t _woken = pdFALSE;
+
+    if (!_senderI2S->int_st.out_total_eof)
+        return;
+
+    // Clear the interrupt flags and stop the transmission.
+    _senderI2S->int_clr.val = _senderI2S->int_st.val;
+    _senderI2S->out_link.stop = 1;
+    _senderI2S->out_link.start = 0;
+
+    // End the row, latch the data into the panel. Next line sets CKV high again, keep it low long enough first.
+    SPH_SET;
+    CKV_CLEAR;
+    LE_SET;
+    LE_CLEAR;
+    ets_delay_us(I2S_SENDER_CKV_LOW_US);
+
+    portENTER_CRITICAL_ISR(&_senderLock);
+    _senderPending--;
+    _senderTail = (_senderTail + 1) % I2S_LINE_BUFFERS;
+    if (_senderPending)
+        startDataI2S((i2s_dev_t *)_senderI2S, _senderQueue[_senderTail]);
+    else
+        _senderBusy = false;
+    portEXIT_CRITICAL_ISR(&_senderLock);
+
+    // Line buffer of the sent line is free now.
+    xSemaphoreGiveFromISR(_senderFree, &_woken);
+    if (_woken)
+        portYIELD_FROM_ISR();
+}
+
+/**
+ * @brief       Adds the line into the queue of the line sender and starts sending if the sender
+ *              is not busy. Free slot in the queue must be already taken.
+ *
+ * @param       volatile lldesc_s *_dmaDesc
+ *              DMA descriptor of the line.
+ */
+static void IRAM_ATTR queueLineI2S(volatile lldesc_s *_dmaDesc)
+{
+    portENTER_CRITICAL(&_senderLock);
+    _senderQueue[_senderHead] = _dmaDesc;
+    _senderHead = (_senderHead + 1) % I2S_LINE_BUFFERS;
+    _senderPending++;
+    if (!_senderBusy)
+    {
+        _senderBusy = true;
+        startDataI2S((i2s_dev_t *)_senderI2S, _senderQueue[_senderTail]);
+    }
+    portEXIT_CRITICAL(&_senderLock);
+}
+
+/**
+ * @brief       Allocates DMA line buffers and descriptors and installs the I2S interrupt
+ *              used to send lines in the background.
+ *
+ * @param       int _lineSize
+ *              Size of one line in bytes (with the padding).
+ *
+ * @return      True if successful, false if memory allocation or interrupt allocation failed.
+ */
+bool Esp::initLineSender(int _lineSize)
+{
+    for (int i = 0; i < I2S_LINE_BUFFERS; i++)
+    {
+        _dmaLineBuffers[i] = (uint8_t *)trackedMalloc(MEMORY_TAG_DRIVER, _lineSize, MALLOC_CAP_DMA);
+        _dmaI2SDescs[i] = (lldesc_s *)trackedMalloc(MEMORY_TAG_DRIVER, sizeof(lldesc_t), MALLOC_CAP_DMA);
+        if (_dmaLineBuffers[i] == NULL || _dmaI2SDescs[i] == NULL)
+            return false;
+
+        // Line buffer and DMA descriptor are always the same, set them up only once.
+        memset((uint8_t *)_dmaLineBuffers[i], 0, _lineSize);
+        _dmaI2SDescs[i]->size = _lineSize;
+        _dmaI2SDescs[i]->length = _lineSize;
+        _dmaI2SDescs[i]->sosf = 1;
+        _dmaI2SDescs[i]->owner = 1;
+        _dmaI2SDescs[i]->qe.stqe_next = 0;
+        _dmaI2SDescs[i]->eof = 1;
+        _dmaI2SDescs[i]->buf = _dmaLineBuffers[i];
+        _dmaI2SDescs[i]->offset = 0;
+    }
+
+    // Clean lines are always the same, so they are prepared only once and never touched by the CPU again.
+    for (int i = 0; i < 4; i++)
+    {
+        _dmaCleanBuffers[i] = (uint8_t *)trackedMalloc(MEMORY_TAG_DRIVER, _lineSize, MALLOC_CAP_DMA);
+        _dmaCleanDescs[i] = (lldesc_s *)trackedMalloc(MEMORY_TAG_DRIVER, sizeof(lldesc_t), MALLOC_CAP_DMA);
+        if (_dmaCleanBuffers[i] == NULL || _dmaCleanDescs[i] == NULL)
+            return false;
+
+        memset((uint8_t *)_dmaCleanBuffers[i], _cleanPatterns[i], _lineSize);
+        _dmaCleanDescs[i]->size = _lineSize;
+        _dmaCleanDescs[i]->length = _lineSize;
+        _dmaCleanDescs[i]->sosf = 1;
+        _dmaCleanDescs[i]->owner = 1;
+        _dmaCleanDescs[i]->qe.stqe_next = 0;
+        _dmaCleanDescs[i]->eof = 1;
+        _dmaCleanDescs[i]->buf = _dmaCleanBuffers[i];
+        _dmaCleanDescs[i]->offset = 0;
+    }
+
+    // First buffer is also used for sending lines with polling.
+    _dmaLineBuffer = _dmaLineBuffers[0];
+    _dmaI2SDesc = _dmaI2SDescs[0];
+    _dmaLineIndex = 0;
+
+    _senderI2S = myI2S;
+    _senderFree = xSemaphoreCreateCounting(I2S_LINE_BUFFERS, I2S_LINE_BUFFERS);
+    if (_senderFree == NULL)
+        return false;
+
+    // Interrupt is installed, but stays disabled until async mode is selected.
+    myI2S->int_ena.val = 0;
+    myI2S->int_clr.val = 0xFFFFFFFF;
+    if (esp_intr_alloc(ETS_I2S1_INTR_SOURCE, ESP_INTR_FLAG_IRAM, i2sLineSenderISR, NULL, &_senderIntr) != ESP_OK)
+        return false;
+
+    return true;
+}
+
+/**
+ * @brief       Selects how lines are sent to the panel.
+ *
+ * @param       bool _async
+ *              True to send lines in the background using I2S interrupt, false to use polling.
+ */
+void Esp::setLineSender(bool _async)
+{
+    // Wait for the lines already in the queue.
+    waitI2SLines();
+
+    myI2S->int_clr.val = 0xFFFFFFFF;
+    myI2S->int_ena.out_total_eof = _async ? 1 : 0;
+    _lineSenderAsync = _async;
+    _dmaLineIndex = 0;
+    _senderHead = 0;
+    _senderTail = 0;
+}
+
+/**
+ * @brief       Gets the line buffer for the next line. In async mode, it waits until one of the line
+ *              buffers is sent (CPU is free while waiting).
+ *
+ * @return      Pointer to the DMA line buffer.
+ */
+volatile uint8_t *IRAM_ATTR Esp::getI2SLine()
+{
+    if (_lineSenderAsync)
+        xSemaphoreTake(_senderFree, portMAX_DELAY);
+
+    return _dmaLineBuffers[_dmaLineIndex];
+}
+
+/**
+ * @brief       Sends the line buffer returned by the last getI2SLine() call. In async mode line is only
+ *              queued and the row is ended in the interrupt, otherwise it waits until the line is sent.
+ */
+void IRAM_ATTR Esp::sendI2SLine()
+{
+    if (!_lineSenderAsync)
+    {
+        sendDataI2S((i2s_dev_t *)myI2S, _dmaI2SDescs[_dmaLineIndex]);
+        return;
+    }
+
+    queueLineI2S(_dmaI2SDescs[_dmaLineIndex]);
+    _dmaLineIndex = (_dmaLineIndex + 1) % I2S_LINE_BUFFERS;
+}
+
+/**
+ * @brief       Sends one of the prepared clean lines. Line buffer is not used, so CPU doesn't need to
+ *              build anything. In async mode line is only queued.
+ *
+ * @param       uint8_t _c
+ *              Clean pattern, 0 - white, 1 - black, 2 - discharge, 3 - skip.
+ */
+void IRAM_ATTR Esp::sendI2SCleanLine(uint8_t _c)
+{
+    if (!_lineSenderAsync)
+    {
+        sendDataI2S((i2s_dev_t *)myI2S, _dmaCleanDescs[_c & 0x03]);
+        return;
+    }
+
+    xSemaphoreTake(_senderFree, portMAX_DELAY);
+    queueLineI2S(_dmaCleanDescs[_c & 0x03]);
+}
+
+/**
+ * @brief       Waits until all queued lines are sent to the panel.
+ */
+void IRAM_ATTR Esp::waitI2SLines()
+{
+    if (!_lineSenderAsync)
+        return;
+
+    // All line buffers are free only when there is nothing left in the queue.
+    for (int i = 0; i < I2S_LINE_BUFFERS; i++)
+        xSemaphoreTake(_senderFree, portMAX_DELAY);
+    for (int i = 0; i < I2S_LINE_BUFFERS; i++)
+        xSemaphoreGive(_senderFree);
+}
+
 void IRAM_ATTR setI2S1pin(uint32_t _pin, uint32_t _function, uint32_t _inv)
 {
     // Check if valid pin is selected
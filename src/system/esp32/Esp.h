@@ -28,6 +28,16 @@
 #include "soc/i2s_struct.h"
 #include "soc/rtc.h"
 #include "soc/soc.h"
+#include "esp_intr_alloc.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Number of DMA line buffers used to send lines in the background.
+#define I2S_LINE_BUFFERS 2
+
+// Time CKV is held low between two lines sent in the background, polling mode never gets below it (vscan_end()).
+#define I2S_SENDER_CKV_LOW_US 1
 
 void IRAM_ATTR I2SInit(volatile i2s_dev_t *_i2sDev, uint8_t _clockDivider = 5);
 void IRAM_ATTR sendDataI2S(volatile i2s_dev_t *_i2sDev, volatile lldesc_s *_dmaDecs);
@@ -40,8 +50,21 @@ class Esp
 {
   public:
   protected:
+    bool initLineSender(int _lineSize);
+    void setLineSender(bool _async);
+    volatile uint8_t *getI2SLine();
+    void sendI2SLine();
+    void sendI2SCleanLine(uint8_t _c);
+    void waitI2SLines();
+
     volatile uint8_t *_dmaLineBuffer;
     volatile lldesc_s *_dmaI2SDesc;
+    volatile uint8_t *_dmaLineBuffers[I2S_LINE_BUFFERS];
+    volatile lldesc_s *_dmaI2SDescs[I2S_LINE_BUFFERS];
+    volatile uint8_t *_dmaCleanBuffers[4];
+    volatile lldesc_s *_dmaCleanDescs[4];
+    uint8_t _dmaLineIndex = 0;
+    bool _lineSenderAsync = false;
 
     // Use only I2S1 (I2S0 is not compatible with 8 bit data).
     volatile i2s_dev_t *myI2S;
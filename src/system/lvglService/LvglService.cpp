@@ -0,0 +1,271 @@
+/**
+ **************************************************
+ * @file        LvglService.cpp
+ * @brief       Library managed LVGL task. Owns the LVGL tick source, runs lv_timer_handler() and sleeps until
+ *              the next LVGL timer deadline or until something is invalidated or an input event arrives.
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#include "LvglService.h"
+#include "esp_timer.h"
+
+// There is only one LVGL instance, so the task handle is shared (it's also needed by wakeFromISR()).
+static volatile TaskHandle_t serviceTask = NULL;
+
+/**
+ * @brief       LVGL tick source. LVGL reads the time only when it needs it, so no periodic tick interrupt or
+ *              timer is needed.
+ *
+ * @return      Milliseconds since boot.
+ */
+static uint32_t serviceTick()
+{
+    return (uint32_t)(esp_timer_get_time() / 1000ULL);
+}
+
+/**
+ * @brief       begin starts the LVGL service task.
+ *
+ * @param       lv_display_t *_disp
+ *              LVGL display, invalidations on it wake up the task.
+ * @param       UBaseType_t _priority
+ *              FreeRTOS priority of the task.
+ * @param       BaseType_t _core
+ *              Core the task is pinned to.
+ *
+ * @return      true if the task is started, false if it's already running or there is not enough memory.
+ *
+ * @note        Remove your own lv_tick_inc() timers and lv_timer_handler() loops when using the service.
+ */
+bool LvglService::begin(lv_display_t *_disp, UBaseType_t _priority, BaseType_t _core)
+{
+    if (serviceTask != NULL || _disp == NULL)
+        return false;
+
+#if !LV_USE_OS
+    if (_mutex == NULL)
+        _mutex = xSemaphoreCreateRecursiveMutex();
+    if (_mutex == NULL)
+        return false;
+#endif
+
+    _display = _disp;
+    _stop = false;
+
+    lv_tick_set_cb(serviceTick);
+
+    // Anything that needs redraw (invalidated area, new object...) sends REFR_REQUEST.
+    lv_display_add_event_cb(_display, refrRequestCallback, LV_EVENT_REFR_REQUEST, this);
+
+    TaskHandle_t handle = NULL;
+    if (xTaskCreatePinnedToCore(task, "lvgl_service", LVGL_SERVICE_STACK_SIZE, this, _priority, &handle, _core) !=
+        pdPASS)
+    {
+        lv_display_remove_event_cb_with_user_data(_display, refrRequestCallback, this);
+        return false;
+    }
+    serviceTask = handle;
+
+    return true;
+}
+
+/**
+ * @brief       end stops the LVGL service task and waits until it exits.
+ *
+ * @note        The tick source stays installed, LVGL time keeps running.
+ */
+void LvglService::end()
+{
+    if (serviceTask == NULL)
+        return;
+
+    _stop = true;
+    wake();
+
+    while (serviceTask != NULL)
+        vTaskDelay(1);
+
+    lock();
+    lv_display_remove_event_cb_with_user_data(_display, refrRequestCallback, this);
+    unlock();
+}
+
+/**
+ * @brief       isRunning checks if the service task is running.
+ *
+ * @return      true if the task is running.
+ */
+bool LvglService::isRunning()
+{
+    return serviceTask != NULL;
+}
+
+/**
+ * @brief       lock takes the LVGL lock. All LVGL calls outside of the service task (and outside of LVGL
+ *              callbacks) must be done while holding it. Recursive, every lock() needs its unlock().
+ *
+ * @param       uint32_t _timeoutMs
+ *              How long to wait for the lock, waits forever by default.
+ *
+ * @return      true if the lock is taken (always true if the service was never started).
+ *
+ * @note        If LVGL is built with an OS (INKPLATE_PARALLEL_DRAW), this is LVGL's own lv_lock(), the same one
+ *              lv_timer_handler() takes. It has no timeout, _timeoutMs is ignored.
+ */
+bool LvglService::lock(uint32_t _timeoutMs)
+{
+#if LV_USE_OS
+    (void)_timeoutMs;
+    lv_lock();
+    return true;
+#else
+    if (_mutex == NULL)
+        return true;
+
+    TickType_t timeout = _timeoutMs == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(_timeoutMs);
+    return xSemaphoreTakeRecursive(_mutex, timeout) == pdTRUE;
+#endif
+}
+
+/**
+ * @brief       unlock releases the lock taken with lock().
+ */
+void LvglService::unlock()
+{
+#if LV_USE_OS
+    lv_unlock();
+#else
+    if (_mutex != NULL)
+        xSemaphoreGiveRecursive(_mutex);
+#endif
+}
+
+/**
+ * @brief       wake makes the service task run lv_timer_handler() now, instead of waiting for the next LVGL
+ *              timer deadline.
+ */
+void LvglService::wake()
+{
+    TaskHandle_t handle = serviceTask;
+    if (handle != NULL && handle != xTaskGetCurrentTaskHandle())
+        xTaskNotifyGive(handle);
+}
+
+/**
+ * @brief       wakeFromISR is the same as wake(), but can be called from the interrupt (e.g. touch or button
+ *              interrupt).
+ */
+void IRAM_ATTR LvglService::wakeFromISR()
+{
+    TaskHandle_t handle = serviceTask;
+    if (handle == NULL)
+        return;
+
+    BaseType_t higherPriorityWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(handle, &higherPriorityWoken);
+    if (higherPriorityWoken)
+        portYIELD_FROM_ISR();
+}
+
+/**
+ * @brief       setEventDriven stops the periodic polling of the input device. The service reads it only when
+ *              woken up (wakeFromISR() from the interrupt of the device) and keeps reading it while it's pressed.
+ *
+ * @param       lv_indev_t *_indev
+ *              Input device that has an interrupt calling wakeFromISR().
+ */
+void LvglService::setEventDriven(lv_indev_t *_indev)
+{
+    if (_indev == NULL)
+        return;
+
+    lock();
+    lv_indev_set_mode(_indev, LV_INDEV_MODE_EVENT);
+    unlock();
+}
+
+/**
+ * @brief       getWakeCount returns how many times the service task woke up since begin(). Handy to check
+ *              what keeps the CPU awake.
+ *
+ * @return      Number of wake ups.
+ */
+uint32_t LvglService::getWakeCount()
+{
+    return _wakeCount;
+}
+
+/**
+ * @brief       readEventDevices reads all input devices that are not polled by LVGL (LV_INDEV_MODE_EVENT).
+ *
+ * @return      true if any of them is still pressed, so it has to be read again soon.
+ */
+bool LvglService::readEventDevices()
+{
+    bool pressed = false;
+
+    for (lv_indev_t *indev = lv_indev_get_next(NULL); indev != NULL; indev = lv_indev_get_next(indev))
+    {
+        if (lv_indev_get_mode(indev) != LV_INDEV_MODE_EVENT)
+            continue;
+
+        lv_indev_read(indev);
+        if (lv_indev_get_state(indev) == LV_INDEV_STATE_PRESSED)
+            pressed = true;
+    }
+
+    return pressed;
+}
+
+/**
+ * @brief       refrRequestCallback wakes up the service when something on the display needs redraw.
+ *
+ * @param       lv_event_t *_e
+ *              LVGL event, user data is the LvglService.
+ */
+void LvglService::refrRequestCallback(lv_event_t *_e)
+{
+    LvglService *self = (LvglService *)lv_event_get_user_data(_e);
+    self->wake();
+}
+
+/**
+ * @brief       Service task. Runs LVGL and blocks until the next LVGL timer deadline or until woken up.
+ *
+ * @param       void *_arg
+ *              Pointer to the LvglService.
+ */
+void LvglService::task(void *_arg)
+{
+    LvglService *self = (LvglService *)_arg;
+
+    while (!self->_stop)
+    {
+        self->lock();
+        bool pressed = self->readEventDevices();
+        uint32_t next = lv_timer_handler();
+        self->unlock();
+
+        // Pressed event driven devices don't generate interrupts until released, read them at the usual rate.
+        if (pressed && next > LV_DEF_REFR_PERIOD)
+            next = LV_DEF_REFR_PERIOD;
+
+        TickType_t wait = next == LV_NO_TIMER_READY ? portMAX_DELAY : pdMS_TO_TICKS(next);
+        ulTaskNotifyTake(pdTRUE, wait > 0 ? wait : 1);
+        self->_wakeCount++;
+    }
+
+    serviceTask = NULL;
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,76 @@
+/**
+ **************************************************
+ * @file        LvglService.h
+ * @brief       Library managed LVGL task. Owns the LVGL tick source, runs lv_timer_handler() and sleeps until
+ *              the next LVGL timer deadline or until something is invalidated or an input event arrives.
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#ifndef __LVGL_SERVICE_H__
+#define __LVGL_SERVICE_H__
+
+#include "Arduino.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "../../lvgl/lvgl.h"
+
+#ifndef LVGL_SERVICE_STACK_SIZE
+#define LVGL_SERVICE_STACK_SIZE 16000
+#endif
+
+#ifndef LVGL_SERVICE_PRIORITY
+#define LVGL_SERVICE_PRIORITY 2
+#endif
+
+#ifndef LVGL_SERVICE_CORE
+#define LVGL_SERVICE_CORE 1
+#endif
+
+/**
+ * @brief       LVGL service task. While it runs, LVGL must only be used between lock() and unlock() (or from LVGL
+ *              callbacks, these are already called with the lock held).
+ *
+ * @note        When nothing is animated and nothing is invalidated the task blocks without a timeout, so the idle
+ *              task can enter tickless light sleep if power management is enabled in the sdkconfig.
+ */
+class LvglService
+{
+  public:
+    bool begin(lv_display_t *_disp, UBaseType_t _priority = LVGL_SERVICE_PRIORITY,
+               BaseType_t _core = LVGL_SERVICE_CORE);
+    void end();
+    bool isRunning();
+
+    bool lock(uint32_t _timeoutMs = portMAX_DELAY);
+    void unlock();
+
+    void wake();
+    static void wakeFromISR();
+
+    void setEventDriven(lv_indev_t *_indev);
+    uint32_t getWakeCount();
+
+  private:
+    static void task(void *_arg);
+    static void refrRequestCallback(lv_event_t *_e);
+    bool readEventDevices();
+
+    lv_display_t *_display = NULL;
+    SemaphoreHandle_t _mutex = NULL;
+    volatile bool _stop = false;
+    volatile uint32_t _wakeCount = 0;
+};
+
+#endif
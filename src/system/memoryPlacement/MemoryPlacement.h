@@ -0,0 +1,70 @@
+/**
+ **************************************************
+ * @file        MemoryPlacement.h
+ * @brief       Memory placement policy. Says which buffers of the display stack must be in internal RAM and
+ *              which may go to PSRAM. Passed to Inkplate::begin().
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#ifndef __MEMORY_PLACEMENT_H__
+#define __MEMORY_PLACEMENT_H__
+
+#include "esp_heap_caps.h"
+#include <stdint.h>
+
+// Where the buffer is allocated.
+#define MEMORY_PLACE_ANY      0 // Internal RAM if there is enough, PSRAM otherwise.
+#define MEMORY_PLACE_INTERNAL 1 // Internal RAM only.
+#define MEMORY_PLACE_PSRAM    2 // PSRAM only.
+
+// The smallest partial render buffer, if even this doesn't fit into internal RAM, PSRAM is used.
+#define MEMORY_PLACEMENT_MIN_ROWS 8
+
+/**
+ * @brief       Memory placement policy. DMA line buffers are not listed, I2S DMA can only read internal RAM so
+ *              they are always there. For full screen render buffers (LV_DISP_RENDER_MODE_FULL and _DIRECT)
+ *              MEMORY_PLACE_INTERNAL is treated as MEMORY_PLACE_ANY, they rarely fit into internal RAM.
+ */
+struct memoryPlacement
+{
+    uint8_t renderBuffers; // LVGL render buffers.
+    uint8_t luts;          // Waveform LUTs and the line/row staging buffers of the waveform engine.
+    uint8_t ditherRows;    // Error diffusion rows of the dithering.
+
+    uint16_t partialRows;     // Rows of each partial render buffer, 0 picks the largest that fits.
+    uint16_t maxPartialRows;  // Upper limit for the automatic pick.
+    uint32_t internalReserve; // Internal RAM left free for WiFi, task stacks etc.
+};
+
+#define MEMORY_PLACEMENT_DEFAULT                                                                                       \
+    {MEMORY_PLACE_INTERNAL, MEMORY_PLACE_INTERNAL, MEMORY_PLACE_ANY, 0, 128, 64 * 1024}
+
+/**
+ * @brief       memoryPlacementCaps converts MEMORY_PLACE_xxx into heap_caps_malloc() capabilities.
+ *
+ * @param       uint8_t _place
+ *              MEMORY_PLACE_xxx
+ *
+ * @return      Memory capabilities (MALLOC_CAP_xxx).
+ */
+static inline uint32_t memoryPlacementCaps(uint8_t _place)
+{
+    if (_place == MEMORY_PLACE_INTERNAL)
+        return MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    if (_place == MEMORY_PLACE_PSRAM)
+        return MALLOC_CAP_SPIRAM;
+    return MALLOC_CAP_8BIT;
+}
+
+#endif
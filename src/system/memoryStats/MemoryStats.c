@@ -0,0 +1,185 @@
+/**
+ **************************************************
+ * @file        MemoryStats.c
+ * @brief       Memory usage telemetry, counters are updated on every tracked allocation.
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#include "MemoryStats.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include <string.h>
+
+static const uint32_t histogramLimits[MEMORY_HISTOGRAM_BINS] = MEMORY_HISTOGRAM_LIMITS;
+static const char *tagNames[MEMORY_TAG_COUNT] = {"lvgl",   "drawBuffer", "framebuffer", "driver",
+                                                 "dither", "download",   "fsCache",     "memFs"};
+
+static struct memoryStats stats;
+static uint32_t lastAllocCount = 0;
+static int64_t lastTime = 0;
+
+static uint8_t histogramBin(size_t _size)
+{
+    uint8_t i = 0;
+    while (_size > histogramLimits[i])
+        i++;
+    return i;
+}
+
+// Counters are updated from every task that allocates (LVGL and draw threads, SD, network and driver tasks), not all
+// of them under the same lock, so each update is atomic.
+#define STATS_ADD(_counter, _n) __atomic_add_fetch(&(_counter), (_n), __ATOMIC_RELAXED)
+#define STATS_SUB(_counter, _n) __atomic_sub_fetch(&(_counter), (_n), __ATOMIC_RELAXED)
+
+/**
+ * @brief       memoryStatsAdd records new allocation.
+ *
+ * @param       uint8_t _tag
+ *              Allocation tag (MEMORY_TAG_xxx).
+ * @param       size_t _size
+ *              Size of the allocated block in bytes.
+ */
+void memoryStatsAdd(uint8_t _tag, size_t _size)
+{
+    uint32_t live = STATS_ADD(stats.liveBytes[_tag], _size);
+    STATS_ADD(stats.liveBlocks[_tag], 1);
+    STATS_ADD(stats.allocCount[_tag], 1);
+    STATS_ADD(stats.histogram[_tag][histogramBin(_size)], 1);
+
+    // Raise the peak only if no other task raised it higher meanwhile.
+    uint32_t peak = __atomic_load_n(&stats.peakBytes[_tag], __ATOMIC_RELAXED);
+    while (live > peak && !__atomic_compare_exchange_n(&stats.peakBytes[_tag], &peak, live, 1, __ATOMIC_RELAXED,
+                                                       __ATOMIC_RELAXED))
+    {
+    }
+}
+
+/**
+ * @brief       memoryStatsRemove records freed block.
+ *
+ * @param       uint8_t _tag
+ *              Allocation tag (MEMORY_TAG_xxx), same as for memoryStatsAdd().
+ * @param       size_t _size
+ *              Size of the block in bytes, same as for memoryStatsAdd().
+ */
+void memoryStatsRemove(uint8_t _tag, size_t _size)
+{
+    STATS_SUB(stats.liveBytes[_tag], _size);
+    STATS_SUB(stats.liveBlocks[_tag], 1);
+    STATS_SUB(stats.histogram[_tag][histogramBin(_size)], 1);
+}
+
+/**
+ * @brief       trackedMalloc allocates memory with heap_caps_malloc() and records the allocation.
+ *
+ * @param       uint8_t _tag
+ *              Allocation tag (MEMORY_TAG_xxx).
+ * @param       size_t _size
+ *              Size of the block in bytes.
+ * @param       uint32_t _caps
+ *              Memory capabilities (MALLOC_CAP_xxx).
+ *
+ * @return      Pointer to the block, NULL if allocation failed.
+ */
+void *trackedMalloc(uint8_t _tag, size_t _size, uint32_t _caps)
+{
+    void *p = heap_caps_malloc(_size, _caps);
+    if (p != NULL)
+        memoryStatsAdd(_tag, _size);
+    return p;
+}
+
+/**
+ * @brief       trackedFree frees the block allocated with trackedMalloc().
+ *
+ * @param       uint8_t _tag
+ *              Allocation tag used for trackedMalloc().
+ * @param       void *_p
+ *              Pointer to the block, NULL is ignored.
+ * @param       size_t _size
+ *              Size used for trackedMalloc().
+ */
+void trackedFree(uint8_t _tag, void *_p, size_t _size)
+{
+    if (_p == NULL)
+        return;
+    heap_caps_free(_p);
+    memoryStatsRemove(_tag, _size);
+}
+
+/**
+ * @brief       memoryStatsGet fills the snapshot of the memory usage.
+ *
+ * @param       struct memoryStats *_stats
+ *              Pointer to the struct that will be filled.
+ *
+ * @note        Allocation rate is calculated since the previous call of this function.
+ */
+void memoryStatsGet(struct memoryStats *_stats)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t allocs = 0;
+
+    for (int i = 0; i < MEMORY_TAG_COUNT; i++)
+        allocs += stats.allocCount[i];
+
+    stats.allocRate = now > lastTime ? (allocs - lastAllocCount) * 1000000.0f / (now - lastTime) : 0;
+    stats.uptime = now / 1000;
+    lastAllocCount = allocs;
+    lastTime = now;
+
+    stats.freePsram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    stats.largestFreePsram = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+    stats.minFreePsram = heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM);
+    stats.freeInternal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    stats.largestFreeInternal = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    stats.minFreeInternal = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+
+    memcpy(_stats, &stats, sizeof(stats));
+}
+
+/**
+ * @brief       memoryStatsBudget fills how much memory the display stack holds and how much is free.
+ *
+ * @param       struct memoryBudget *_budget
+ *              Pointer to the struct that will be filled.
+ *
+ * @note        Unlike memoryStatsGet(), this does not restart the allocation rate measurement.
+ */
+void memoryStatsBudget(struct memoryBudget *_budget)
+{
+    _budget->framebuffers = stats.liveBytes[MEMORY_TAG_FRAMEBUFFER];
+    _budget->drawBuffers = stats.liveBytes[MEMORY_TAG_DRAW_BUFFER];
+    _budget->driver = stats.liveBytes[MEMORY_TAG_DRIVER];
+    _budget->lvgl = stats.liveBytes[MEMORY_TAG_LVGL];
+    _budget->total = _budget->framebuffers + _budget->drawBuffers + _budget->driver + _budget->lvgl;
+
+    _budget->freePsram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    _budget->largestFreePsram = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+    _budget->freeInternal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    _budget->largestFreeInternal = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+}
+
+/**
+ * @brief       memoryStatsTagName returns printable name of the tag.
+ *
+ * @param       uint8_t _tag
+ *              Allocation tag (MEMORY_TAG_xxx).
+ *
+ * @return      Name of the tag, "?" for unknown tag.
+ */
+const char *memoryStatsTagName(uint8_t _tag)
+{
+    return _tag < MEMORY_TAG_COUNT ? tagNames[_tag] : "?";
+}
@@ -0,0 +1,106 @@
+/**
+ **************************************************
+ * @file        MemoryStats.h
+ * @brief       Memory usage telemetry. Tracks live and peak bytes per allocation tag, size histograms and
+ *              allocation rate of the LVGL allocator and of the driver buffers.
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#ifndef __MEMORY_STATS_H__
+#define __MEMORY_STATS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Allocation tags, each tag has its own live/peak counters.
+#define MEMORY_TAG_LVGL        0 // Everything allocated by LVGL (lv_malloc).
+#define MEMORY_TAG_DRAW_BUFFER 1 // LVGL draw buffers.
+#define MEMORY_TAG_FRAMEBUFFER 2 // EPD framebuffers (DMemoryNew, _partial, _pBuffer, DMemory4Bit).
+#define MEMORY_TAG_DRIVER      3 // DMA line buffers, waveform LUTs and line staging buffers.
+#define MEMORY_TAG_DITHER      4 // Dithering scratch buffers.
+#define MEMORY_TAG_DOWNLOAD    5 // Buffers of the downloaded files.
+#define MEMORY_TAG_FS_CACHE    6 // Read-ahead caches of the files open on the SD card ('S:' LVGL driver).
+#define MEMORY_TAG_MEM_FS      7 // Files on the 'M:' RAM drive.
+#define MEMORY_TAG_COUNT       8
+
+// Size histogram bins, upper limit of each bin in bytes (last bin holds everything larger).
+#define MEMORY_HISTOGRAM_BINS 12
+#define MEMORY_HISTOGRAM_LIMITS {16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 16384, 65536, UINT32_MAX}
+
+/**
+ * @brief       Snapshot of the memory usage, filled by memoryStatsGet().
+ */
+struct memoryStats
+{
+    uint32_t liveBytes[MEMORY_TAG_COUNT];  // Bytes currently allocated.
+    uint32_t peakBytes[MEMORY_TAG_COUNT];  // Max of liveBytes since boot.
+    uint32_t liveBlocks[MEMORY_TAG_COUNT]; // Blocks currently allocated.
+    uint32_t allocCount[MEMORY_TAG_COUNT]; // Allocations since boot.
+
+    // Live blocks of each tag sorted by size (see MEMORY_HISTOGRAM_LIMITS).
+    uint32_t histogram[MEMORY_TAG_COUNT][MEMORY_HISTOGRAM_BINS];
+
+    float allocRate; // Allocations per second since the previous memoryStatsGet() call.
+    uint32_t uptime; // Milliseconds since boot.
+
+    uint32_t freePsram;
+    uint32_t largestFreePsram;
+    uint32_t minFreePsram; // Lowest free PSRAM since boot.
+    uint32_t freeInternal;
+    uint32_t largestFreeInternal;
+    uint32_t minFreeInternal;
+
+    // LVGL allocator (filled by Inkplate::getMemoryStats()).
+    uint32_t lvglTotal;
+    uint32_t lvglFree;
+    uint32_t lvglLargestFree;
+    uint8_t lvglFragmentation; // [%]
+};
+
+/**
+ * @brief       Memory held by the display stack and memory still available, filled by memoryStatsBudget().
+ *              Use it to size image caches and downloads against what is actually free.
+ */
+struct memoryBudget
+{
+    uint32_t framebuffers; // EPD framebuffers of the current display mode.
+    uint32_t drawBuffers;  // LVGL draw buffers.
+    uint32_t driver;       // DMA line buffers, waveform LUTs.
+    uint32_t lvgl;         // LVGL heap in use (objects, styles, image cache...).
+    uint32_t total;        // Sum of all of the above.
+
+    uint32_t freePsram;
+    uint32_t largestFreePsram; // Biggest block that can still be allocated from PSRAM.
+    uint32_t freeInternal;
+    uint32_t largestFreeInternal;
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+void memoryStatsAdd(uint8_t _tag, size_t _size);
+void memoryStatsRemove(uint8_t _tag, size_t _size);
+void *trackedMalloc(uint8_t _tag, size_t _size, uint32_t _caps);
+void trackedFree(uint8_t _tag, void *_p, size_t _size);
+void memoryStatsGet(struct memoryStats *_stats);
+void memoryStatsBudget(struct memoryBudget *_budget);
+const char *memoryStatsTagName(uint8_t _tag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
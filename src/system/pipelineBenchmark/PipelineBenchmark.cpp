@@ -0,0 +1,554 @@
+/**
+ **************************************************
+ * @file        PipelineBenchmark.cpp
+ * @brief       Microbenchmarks of the display pipeline hot paths (LVGL flush, dithering, waveform LUTs, partial
+ *              update diff and line building) on synthetic and real-world frames at the resolution of the board.
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#include "PipelineBenchmark.h"
+#include "../../Inkplate-LVGL.h"
+
+#ifdef INKPLATE_SIMULATOR
+// Time of the simulator is simulated panel time, kernels are timed with the host clock.
+#include <time.h>
+
+static uint64_t benchNanos()
+{
+    struct timespec _ts;
+    clock_gettime(CLOCK_MONOTONIC, &_ts);
+    return (uint64_t)_ts.tv_sec * 1000000000ULL + _ts.tv_nsec;
+}
+#else
+#include "esp_timer.h"
+
+static uint64_t benchNanos()
+{
+    return (uint64_t)esp_timer_get_time() * 1000ULL;
+}
+#endif
+
+// calculateLUTs() is too short for the microsecond timer, it's repeated this many times in one run.
+#define PIPELINE_LUT_REPEAT 100
+
+static const char *const frameNames[PIPELINE_FRAME_COUNT] = {"white", "gradient", "noise", "text", "ui", "photo"};
+
+// Benchmark that is capturing a screen rendered by LVGL (flush callback has no user pointer of its own).
+static PipelineBenchmark *captureTarget = NULL;
+
+/**
+ * @brief       begin allocates the test frame at the LVGL resolution and the buffers of the partial update diff.
+ *
+ * @param       Inkplate *_inkplatePtr
+ *              Inkplate object, begin() must already be called.
+ *
+ * @return      true if ready, false if LVGL is not initialized or there is not enough memory.
+ */
+bool PipelineBenchmark::begin(Inkplate *_inkplatePtr)
+{
+    if (_inkplatePtr == NULL || _inkplatePtr->disp == NULL)
+        return false;
+
+    end();
+    _inkplate = _inkplatePtr;
+    _width = lv_display_get_horizontal_resolution(_inkplate->disp);
+    _height = lv_display_get_vertical_resolution(_inkplate->disp);
+    _pixelSize = (LV_COLOR_DEPTH == 16) ? 2 : 1;
+
+    _frameBuffer = (uint8_t *)trackedMalloc(MEMORY_TAG_DITHER, frameSize(), MALLOC_CAP_SPIRAM);
+#ifdef USES_WAVEFORM_ENGINE
+    _oldPartial = (uint8_t *)trackedMalloc(MEMORY_TAG_FRAMEBUFFER, E_INK_WIDTH * E_INK_HEIGHT / 8, MALLOC_CAP_SPIRAM);
+    _partialOut = (uint8_t *)trackedMalloc(MEMORY_TAG_FRAMEBUFFER, E_INK_WIDTH * E_INK_HEIGHT / 4, MALLOC_CAP_SPIRAM);
+    if (_oldPartial == NULL || _partialOut == NULL)
+    {
+        end();
+        return false;
+    }
+#endif
+    if (_frameBuffer == NULL)
+    {
+        end();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief       end frees the benchmark buffers.
+ */
+void PipelineBenchmark::end()
+{
+    if (_frameBuffer != NULL)
+        trackedFree(MEMORY_TAG_DITHER, _frameBuffer, frameSize());
+    _frameBuffer = NULL;
+#ifdef USES_WAVEFORM_ENGINE
+    if (_oldPartial != NULL)
+        trackedFree(MEMORY_TAG_FRAMEBUFFER, _oldPartial, E_INK_WIDTH * E_INK_HEIGHT / 8);
+    if (_partialOut != NULL)
+        trackedFree(MEMORY_TAG_FRAMEBUFFER, _partialOut, E_INK_WIDTH * E_INK_HEIGHT / 4);
+    _oldPartial = NULL;
+    _partialOut = NULL;
+#endif
+}
+
+/**
+ * @brief       run runs every kernel on every selected frame and prints the results.
+ *
+ * @param       Print &_out
+ *              Where the CSV lines are printed (Serial, SD card file...).
+ * @param       uint16_t _iterations
+ *              Timed runs of each kernel, the fastest one is reported.
+ * @param       uint8_t _frames
+ *              Bit mask of the frames (1 << PIPELINE_FRAME_xxx).
+ *
+ * @return      true if all selected frames were benchmarked, false if begin() wasn't called or a display mode
+ *              couldn't be selected.
+ */
+bool PipelineBenchmark::run(Print &_out, uint16_t _iterations, uint8_t _frames)
+{
+    if (_frameBuffer == NULL)
+        return false;
+
+    this->_iterations = _iterations ? _iterations : 1;
+    _out.println("bench,board,kernel,frame,pixels,bytes,iterations,nsMin,nsMean,nsPerPixel,MBps");
+
+    bool _ok = true;
+    bool _ditherEnabled = _inkplate->ditherEnabled;
+
+#ifdef USES_WAVEFORM_ENGINE
+    uint8_t _oldMode = _inkplate->getDisplayMode();
+    benchLUTs(_out);
+    memset(_oldPartial, 0, E_INK_WIDTH * E_INK_HEIGHT / 8);
+
+    // Both modes need their own framebuffers, go through all frames in one mode before switching.
+    for (uint8_t _mode = INKPLATE_1BIT; _mode <= INKPLATE_3BIT && _ok; _mode++)
+    {
+        _inkplate->selectDisplayMode(_mode);
+        if (_inkplate->getDisplayMode() != _mode)
+        {
+            _ok = false;
+            break;
+        }
+
+        for (uint8_t f = 0; f < PIPELINE_FRAME_COUNT && _ok; f++)
+        {
+            if ((_frames & (1 << f)) && makeFrame(f))
+                _ok = benchGrayscale(_out, f, _mode);
+        }
+    }
+
+    _inkplate->selectDisplayMode(_oldMode);
+#else
+    for (uint8_t f = 0; f < PIPELINE_FRAME_COUNT; f++)
+    {
+        if (!(_frames & (1 << f)) || !makeFrame(f))
+            continue;
+        benchFlush(_out, "flush", f);
+        benchDither(_out, "dither", f);
+    }
+#endif
+
+    _inkplate->ditherEnabled = _ditherEnabled;
+    _inkplate->clearDisplay();
+
+    return _ok;
+}
+
+#ifdef USES_WAVEFORM_ENGINE
+/**
+ * @brief       benchGrayscale runs the kernels of one display mode on the current frame.
+ *
+ * @param       Print &_out
+ *              Where the results are printed.
+ * @param       uint8_t _frame
+ *              Frame in _frameBuffer (PIPELINE_FRAME_xxx).
+ * @param       uint8_t _mode
+ *              INKPLATE_1BIT or INKPLATE_3BIT, already selected.
+ *
+ * @return      Always true.
+ */
+bool PipelineBenchmark::benchGrayscale(Print &_out, uint8_t _frame, uint8_t _mode)
+{
+    if (_mode == INKPLATE_1BIT)
+    {
+        benchFlush(_out, "flush1bit", _frame);
+        benchDither(_out, "dither1bit", _frame);
+
+        // Diff and lines work on the undithered frame, same as after a flush without dithering.
+        _inkplate->ditherEnabled = false;
+        _inkplate->clearDisplay();
+        lv_area_t _area = {0, 0, (int32_t)_width - 1, (int32_t)_height - 1};
+        display_flush_callback(_inkplate->disp, &_area, _frameBuffer);
+
+        benchPartial(_out, _frame);
+        benchLines(_out, "lines1bit", _frame, WAVEFORM_SOURCE_1BIT, _inkplate->_partial);
+    }
+    else
+    {
+        benchFlush(_out, "flush3bit", _frame);
+        benchDither(_out, "dither3bit", _frame);
+
+        _inkplate->ditherEnabled = false;
+        lv_area_t _area = {0, 0, (int32_t)_width - 1, (int32_t)_height - 1};
+        display_flush_callback(_inkplate->disp, &_area, _frameBuffer);
+
+        benchLines(_out, "lines3bit", _frame, WAVEFORM_SOURCE_3BIT, _inkplate->DMemory4Bit);
+    }
+
+    return true;
+}
+
+/**
+ * @brief       benchLUTs times calculateLUTs() (3 bit waveform to the LUT of all 9 phases).
+ *
+ * @param       Print &_out
+ *              Where the results are printed.
+ */
+void PipelineBenchmark::benchLUTs(Print &_out)
+{
+    WaveformEngine *_engine = _inkplate;
+
+    resetTimes();
+    for (uint16_t i = 0; i < _iterations; i++)
+    {
+        uint64_t _start = benchNanos();
+        for (int k = 0; k < PIPELINE_LUT_REPEAT; k++)
+            _engine->calculateLUTs();
+        addTime((benchNanos() - _start) / PIPELINE_LUT_REPEAT);
+    }
+
+    // One LUT entry per framebuffer byte value and phase.
+    report(_out, "calculateLUTs", PIPELINE_FRAME_COUNT, 256 * 9, sizeof(_engine->waveform3Bit));
+}
+
+/**
+ * @brief       benchPartial times the partial update diff of the previous frame and the current one (1 bit
+ *              framebuffers), then keeps the current one for the next frame.
+ *
+ * @param       Print &_out
+ *              Where the results are printed.
+ * @param       uint8_t _frame
+ *              Current frame, already flushed into the 1 bit framebuffer.
+ */
+void PipelineBenchmark::benchPartial(Print &_out, uint8_t _frame)
+{
+    WaveformEngine *_engine = _inkplate;
+
+    resetTimes();
+    for (uint16_t i = 0; i < _iterations; i++)
+    {
+        uint64_t _start = benchNanos();
+        _engine->calculatePartial(_oldPartial, _inkplate->_partial, _partialOut);
+        addTime(benchNanos() - _start);
+    }
+    report(_out, "partialDiff", _frame, E_INK_WIDTH * E_INK_HEIGHT, E_INK_WIDTH * E_INK_HEIGHT / 4);
+
+    memcpy(_oldPartial, _inkplate->_partial, E_INK_WIDTH * E_INK_HEIGHT / 8);
+}
+
+/**
+ * @brief       benchLines times building all lines of one frame of the waveform (row copy and conversion into
+ *              EPD data), without sending them to the panel. The 3 bit source goes through all 9 columns of the
+ *              waveform, one per run.
+ *
+ * @param       Print &_out
+ *              Where the results are printed.
+ * @param       const char *_kernel
+ *              Kernel name used in the results.
+ * @param       uint8_t _frame
+ *              Current frame, already flushed into _fb.
+ * @param       uint8_t _source
+ *              WAVEFORM_SOURCE_1BIT or WAVEFORM_SOURCE_3BIT.
+ * @param       const uint8_t *_fb
+ *              Framebuffer of the source.
+ */
+void PipelineBenchmark::benchLines(Print &_out, const char *_kernel, uint8_t _frame, uint8_t _source,
+                                   const uint8_t *_fb)
+{
+    WaveformEngine *_engine = _inkplate;
+    const struct waveformPhase _phase = {_source, (uint8_t)(_source == WAVEFORM_SOURCE_1BIT ? WAVEFORM_LUT_BW : 0), 1,
+                                         0};
+    const int _stride = (_source == WAVEFORM_SOURCE_1BIT) ? (E_INK_WIDTH / 8) : (E_INK_WIDTH / 2);
+
+    resetTimes();
+    for (uint16_t i = 0; i < _iterations; i++)
+    {
+        uint8_t _column = (_source == WAVEFORM_SOURCE_3BIT) ? (i % 9) : 0;
+        uint64_t _start = benchNanos();
+        for (int y = 0; y < E_INK_HEIGHT; y++)
+        {
+            memcpy(_engine->_waveformRow, _fb + (y * _stride), _stride);
+            _engine->buildLine(_engine->_waveformLine, &_phase, _column, _engine->_waveformRow);
+        }
+        addTime(benchNanos() - _start);
+    }
+    report(_out, _kernel, _frame, E_INK_WIDTH * E_INK_HEIGHT, _stride * E_INK_HEIGHT);
+}
+#endif
+
+/**
+ * @brief       benchFlush times the LVGL flush callback of the board on the whole frame, dithering off.
+ *
+ * @param       Print &_out
+ *              Where the results are printed.
+ * @param       const char *_kernel
+ *              Kernel name used in the results.
+ * @param       uint8_t _frame
+ *              Frame in _frameBuffer.
+ */
+void PipelineBenchmark::benchFlush(Print &_out, const char *_kernel, uint8_t _frame)
+{
+    lv_area_t _area = {0, 0, (int32_t)_width - 1, (int32_t)_height - 1};
+    _inkplate->ditherEnabled = false;
+
+    resetTimes();
+    for (uint16_t i = 0; i < _iterations; i++)
+    {
+        uint64_t _start = benchNanos();
+        display_flush_callback(_inkplate->disp, &_area, _frameBuffer);
+        addTime(benchNanos() - _start);
+    }
+    report(_out, _kernel, _frame, (uint32_t)_width * _height, frameSize());
+}
+
+/**
+ * @brief       benchDither times DitherAlgorithm::ditherFramebuffer() of the current display mode on the frame.
+ *
+ * @param       Print &_out
+ *              Where the results are printed.
+ * @param       const char *_kernel
+ *              Kernel name used in the results.
+ * @param       uint8_t _frame
+ *              Frame in _frameBuffer.
+ */
+void PipelineBenchmark::benchDither(Print &_out, const char *_kernel, uint8_t _frame)
+{
+    resetTimes();
+    for (uint16_t i = 0; i < _iterations; i++)
+    {
+        uint64_t _start = benchNanos();
+#ifdef USE_COLOR_IMAGE
+        _inkplate->dither.ditherFramebuffer(_frameBuffer, _width, _height);
+#else
+        _inkplate->dither.ditherFramebuffer(_frameBuffer, _width, _height, _inkplate->getDisplayMode());
+#endif
+        addTime(benchNanos() - _start);
+    }
+    report(_out, _kernel, _frame, (uint32_t)_width * _height, frameSize());
+}
+
+/**
+ * @brief       makeFrame fills _frameBuffer with the test frame.
+ *
+ * @param       uint8_t _frame
+ *              PIPELINE_FRAME_xxx.
+ *
+ * @return      true if the frame is ready, false if it's unknown.
+ */
+bool PipelineBenchmark::makeFrame(uint8_t _frame)
+{
+    uint32_t _seed = 12345;
+
+    switch (_frame)
+    {
+    case PIPELINE_FRAME_WHITE:
+        memset(_frameBuffer, 0xFF, frameSize());
+        break;
+    case PIPELINE_FRAME_GRADIENT:
+        for (uint16_t y = 0; y < _height; y++)
+            for (uint16_t x = 0; x < _width; x++)
+            {
+                uint8_t _v = (uint32_t)x * 255 / (_width - 1);
+                setPixel((uint32_t)y * _width + x, _v, (uint32_t)y * 255 / (_height - 1), 255 - _v);
+            }
+        break;
+    case PIPELINE_FRAME_NOISE:
+        for (uint32_t i = 0; i < (uint32_t)_width * _height; i++)
+        {
+            _seed = _seed * 1103515245 + 12345;
+            setPixel(i, _seed >> 24, _seed >> 16, _seed >> 8);
+        }
+        break;
+    case PIPELINE_FRAME_PHOTO:
+        // Soft overlapping shapes, a vignette and film grain: large areas of slowly changing tones like a photo.
+        for (uint16_t y = 0; y < _height; y++)
+        {
+            float _fy = (float)y / _height;
+            for (uint16_t x = 0; x < _width; x++)
+            {
+                float _fx = (float)x / _width;
+                float _v = 0.5f + 0.25f * sinf(_fx * 7.1f + 0.8f) * cosf(_fy * 5.3f) + 0.15f * sinf((_fx + _fy) * 11.7f);
+                float _d = (_fx - 0.5f) * (_fx - 0.5f) + (_fy - 0.5f) * (_fy - 0.5f);
+                _v -= 0.6f * _d;
+                _seed = _seed * 1103515245 + 12345;
+                int _grain = (int)((_seed >> 24) & 0x0F) - 8;
+                int _l = (int)(_v * 255.0f) + _grain;
+                _l = _l < 0 ? 0 : (_l > 255 ? 255 : _l);
+                int _warm = (int)(40.0f * sinf(_fx * 3.0f));
+                setPixel((uint32_t)y * _width + x, constrain(_l + _warm, 0, 255), _l, constrain(_l - _warm, 0, 255));
+            }
+        }
+        break;
+    case PIPELINE_FRAME_TEXT:
+    case PIPELINE_FRAME_UI:
+        renderScreen(_frame);
+        break;
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief       setPixel writes one pixel of the test frame in the LVGL color format of the board.
+ *
+ * @param       uint32_t _i
+ *              Pixel index (y * width + x).
+ * @param       uint8_t _r, _g, _b
+ *              Color, grayscale boards use its luminance.
+ */
+void PipelineBenchmark::setPixel(uint32_t _i, uint8_t _r, uint8_t _g, uint8_t _b)
+{
+    if (_pixelSize == 2)
+    {
+        uint16_t _c = ((_r & 0xF8) << 8) | ((_g & 0xFC) << 3) | (_b >> 3);
+        _frameBuffer[_i * 2] = _c & 0xFF;
+        _frameBuffer[_i * 2 + 1] = _c >> 8;
+    }
+    else
+    {
+        _frameBuffer[_i] = RGB8BIT(_r, _g, _b);
+    }
+}
+
+/**
+ * @brief       renderScreen renders a screen of text or widgets with LVGL and captures it into _frameBuffer.
+ *              The active screen is restored (and invalidated) afterwards.
+ *
+ * @param       uint8_t _frame
+ *              PIPELINE_FRAME_TEXT or PIPELINE_FRAME_UI.
+ */
+void PipelineBenchmark::renderScreen(uint8_t _frame)
+{
+    static const char *const _paragraph =
+        "E-paper keeps the image without power, so the panel only draws current while it changes. Text is the "
+        "most common content: thin strokes, lots of edges and large white areas between the lines.";
+
+    lv_obj_t *_oldScreen = lv_screen_active();
+    lv_obj_t *_screen = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(_screen, lv_color_white(), LV_PART_MAIN);
+    lv_obj_set_style_pad_all(_screen, 10, LV_PART_MAIN);
+    lv_obj_set_flex_flow(_screen, _frame == PIPELINE_FRAME_TEXT ? LV_FLEX_FLOW_COLUMN : LV_FLEX_FLOW_ROW_WRAP);
+
+    if (_frame == PIPELINE_FRAME_TEXT)
+    {
+        for (int i = 0; i < 40; i++)
+        {
+            lv_obj_t *_label = lv_label_create(_screen);
+            lv_obj_set_width(_label, lv_pct(100));
+            lv_label_set_text(_label, _paragraph);
+            lv_obj_set_style_text_font(_label, (i % 4) ? &lv_font_montserrat_14 : &lv_font_montserrat_24, 0);
+        }
+    }
+    else
+    {
+        for (int i = 0; i < 24; i++)
+        {
+            lv_obj_t *_btn = lv_button_create(_screen);
+            lv_obj_t *_label = lv_label_create(_btn);
+            lv_label_set_text_fmt(_label, "Button %d", i);
+
+            lv_obj_t *_slider = lv_slider_create(_screen);
+            lv_obj_set_width(_slider, _width / 4);
+            lv_slider_set_value(_slider, (i * 13) % 100, LV_ANIM_OFF);
+
+            lv_obj_t *_sw = lv_switch_create(_screen);
+            if (i % 2)
+                lv_obj_add_state(_sw, LV_STATE_CHECKED);
+
+            lv_obj_t *_cb = lv_checkbox_create(_screen);
+            lv_checkbox_set_text(_cb, "Option");
+        }
+    }
+
+    lv_screen_load(_screen);
+
+    // Capture what LVGL renders instead of sending it to the framebuffer.
+    memset(_frameBuffer, 0xFF, frameSize());
+    captureTarget = this;
+    lv_display_set_flush_cb(_inkplate->disp, captureCallback);
+    lv_obj_invalidate(_screen);
+    lv_refr_now(_inkplate->disp);
+    lv_display_set_flush_cb(_inkplate->disp, display_flush_callback);
+    captureTarget = NULL;
+
+    lv_screen_load(_oldScreen);
+    lv_obj_delete(_screen);
+    lv_obj_invalidate(_oldScreen);
+}
+
+/**
+ * @brief       captureCallback copies the rendered area into the test frame (flush callback during renderScreen()).
+ */
+void PipelineBenchmark::captureCallback(lv_display_t *_disp, const lv_area_t *_area, uint8_t *_pxMap)
+{
+    PipelineBenchmark *self = captureTarget;
+    if (self != NULL)
+    {
+        int32_t _w = lv_area_get_width(_area);
+        for (int32_t y = _area->y1; y <= _area->y2 && y < self->_height; y++)
+        {
+            memcpy(self->_frameBuffer + ((uint32_t)y * self->_width + _area->x1) * self->_pixelSize,
+                   _pxMap + (uint32_t)(y - _area->y1) * _w * self->_pixelSize, _w * self->_pixelSize);
+        }
+    }
+    lv_display_flush_ready(_disp);
+}
+
+/**
+ * @brief       report prints one result line and clears the timer.
+ */
+void PipelineBenchmark::report(Print &_out, const char *_kernel, uint8_t _frame, uint32_t _pixels, uint32_t _bytes)
+{
+    uint64_t _mean = _runs ? _nsTotal / _runs : 0;
+    double _nsPerPixel = _pixels ? (double)_nsMin / _pixels : 0;
+    double _mbps = _nsMin ? (double)_bytes * 1000.0 / _nsMin : 0;
+
+    _out.printf("bench,%s,%s,%s,%lu,%lu,%u,%llu,%llu,%.3f,%.2f\n", INKPLATE_BOARD_NAME, _kernel,
+                _frame < PIPELINE_FRAME_COUNT ? frameNames[_frame] : "-", (unsigned long)_pixels,
+                (unsigned long)_bytes, _runs, (unsigned long long)_nsMin, (unsigned long long)_mean, _nsPerPixel,
+                _mbps);
+}
+
+uint32_t PipelineBenchmark::frameSize()
+{
+    return (uint32_t)_width * _height * _pixelSize;
+}
+
+void PipelineBenchmark::resetTimes()
+{
+    _nsMin = 0;
+    _nsTotal = 0;
+    _runs = 0;
+}
+
+void PipelineBenchmark::addTime(uint64_t _ns)
+{
+    if (_runs == 0 || _ns < _nsMin)
+        _nsMin = _ns;
+    _nsTotal += _ns;
+    _runs++;
+}
@@ -0,0 +1,100 @@
+/**
+ **************************************************
+ * @file        PipelineBenchmark.h
+ * @brief       Microbenchmarks of the display pipeline hot paths (LVGL flush, dithering, waveform LUTs, partial
+ *              update diff and line building) on synthetic and real-world frames at the resolution of the board.
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#ifndef __PIPELINE_BENCHMARK_H__
+#define __PIPELINE_BENCHMARK_H__
+
+#include "Arduino.h"
+#include "../../boardSelect.h"
+#include "../../lvgl/lvgl.h"
+
+class Inkplate;
+
+// Test frames. Synthetic ones are generated, text and UI are rendered by LVGL, photo is a generated
+// continuous tone image (smooth shapes with grain).
+#define PIPELINE_FRAME_WHITE    0
+#define PIPELINE_FRAME_GRADIENT 1
+#define PIPELINE_FRAME_NOISE    2
+#define PIPELINE_FRAME_TEXT     3
+#define PIPELINE_FRAME_UI       4
+#define PIPELINE_FRAME_PHOTO    5
+#define PIPELINE_FRAME_COUNT    6
+
+#define PIPELINE_FRAMES_ALL ((1 << PIPELINE_FRAME_COUNT) - 1)
+
+// Default number of timed runs of each kernel, the fastest one is reported.
+#ifndef PIPELINE_BENCHMARK_ITERATIONS
+#define PIPELINE_BENCHMARK_ITERATIONS 5
+#endif
+
+/**
+ * @brief       Pipeline benchmark. Every kernel runs on the real framebuffers of the board, results are printed
+ *              as CSV, one line per kernel and frame:
+ *
+ *              bench,<board>,<kernel>,<frame>,<pixels>,<bytes>,<iterations>,<ns min>,<ns mean>,<ns/pixel>,<MB/s>
+ *
+ *              ns/pixel and MB/s are calculated from the fastest run, bytes are the input bytes of one run.
+ *
+ * @note        Framebuffers are overwritten and the display mode is switched during the run, both are restored
+ *              (framebuffers cleared) at the end. Panel is not refreshed. Stop the refresh scheduler and the LVGL
+ *              service before the run.
+ */
+class PipelineBenchmark
+{
+  public:
+    bool begin(Inkplate *_inkplatePtr);
+    bool run(Print &_out, uint16_t _iterations = PIPELINE_BENCHMARK_ITERATIONS, uint8_t _frames = PIPELINE_FRAMES_ALL);
+    void end();
+
+  private:
+    bool makeFrame(uint8_t _frame);
+    void renderScreen(uint8_t _frame);
+    static void captureCallback(lv_display_t *_disp, const lv_area_t *_area, uint8_t *_pxMap);
+    void setPixel(uint32_t _i, uint8_t _r, uint8_t _g, uint8_t _b);
+    void benchFlush(Print &_out, const char *_kernel, uint8_t _frame);
+    void benchDither(Print &_out, const char *_kernel, uint8_t _frame);
+#ifdef USES_WAVEFORM_ENGINE
+    bool benchGrayscale(Print &_out, uint8_t _frame, uint8_t _mode);
+    void benchLUTs(Print &_out);
+    void benchPartial(Print &_out, uint8_t _frame);
+    void benchLines(Print &_out, const char *_kernel, uint8_t _frame, uint8_t _source, const uint8_t *_fb);
+#endif
+    void report(Print &_out, const char *_kernel, uint8_t _frame, uint32_t _pixels, uint32_t _bytes);
+    uint32_t frameSize();
+    void resetTimes();
+    void addTime(uint64_t _ns);
+
+    Inkplate *_inkplate = NULL;
+    uint16_t _width = 0;  // LVGL resolution, flush and dither get frames of this size.
+    uint16_t _height = 0;
+    uint8_t _pixelSize = 1; // Bytes per pixel of the frame (L8 or RGB565).
+    uint8_t *_frameBuffer = NULL;
+    uint16_t _iterations = PIPELINE_BENCHMARK_ITERATIONS;
+
+#ifdef USES_WAVEFORM_ENGINE
+    uint8_t *_oldPartial = NULL; // 1 bit framebuffer of the previous frame, for the partial update diff.
+    uint8_t *_partialOut = NULL; // EPD data of the partial update (2 bits per pixel).
+#endif
+
+    uint64_t _nsMin = 0;
+    uint64_t _nsTotal = 0;
+    uint16_t _runs = 0;
+};
+
+#endif
@@ -0,0 +1,344 @@
+/**
+ **************************************************
+ * @file        Profiler.c
+ * @brief       Hot path profiler. Trace points are written into a lock-free ring buffer with the CPU cycle
+ *              counter as the time source, the buffer is dumped as Chrome trace JSON (chrome://tracing,
+ *              ui.perfetto.dev). Also the backend of LVGL's LV_PROFILER_* hooks.
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#include "Profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_idf_version.h"
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include "esp_cpu.h"
+#else
+// Arduino core 2.x (ESP-IDF 4.4).
+#include "xtensa/core-macros.h"
+#endif
+#include "esp_heap_caps.h"
+#include "esp_ipc.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#define PROFILER_CORES portNUM_PROCESSORS
+#else
+// Host build (simulator, tests), monotonic clock in nanoseconds stands in for the cycle counter.
+#include <pthread.h>
+#include <time.h>
+#define PROFILER_CORES 1
+#endif
+
+#if (PROFILER_EVENT_COUNT & (PROFILER_EVENT_COUNT - 1)) != 0
+#error "PROFILER_EVENT_COUNT must be a power of 2"
+#endif
+
+// Cycle counter of each core at the known time, cycle counters of the cores are not in sync.
+struct profilerAnchor
+{
+    uint32_t cycles;
+    uint32_t ticks;
+    int64_t us;
+};
+
+static struct profilerEvent *events = NULL;
+static uint32_t writeIndex = 0;
+static volatile bool running = false;
+static struct profilerAnchor anchors[PROFILER_CORES];
+static uint32_t cyclesPerUs = 1;
+static uint32_t cyclesPerTick = 1;
+
+static inline uint32_t readCycles()
+{
+#ifdef ESP_PLATFORM
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    return (uint32_t)esp_cpu_get_cycle_count();
+#else
+    return (uint32_t)XTHAL_GET_CCOUNT();
+#endif
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint32_t)((uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec);
+#endif
+}
+
+static inline uint32_t readTicks()
+{
+#ifdef ESP_PLATFORM
+    return (uint32_t)xTaskGetTickCount();
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint32_t)((uint64_t)t.tv_sec * 1000ULL + t.tv_nsec / 1000000);
+#endif
+}
+
+static inline uint32_t readThread()
+{
+#ifdef ESP_PLATFORM
+    return (uint32_t)(uintptr_t)xTaskGetCurrentTaskHandle();
+#else
+    return (uint32_t)(uintptr_t)pthread_self();
+#endif
+}
+
+static inline uint8_t readCore()
+{
+#ifdef ESP_PLATFORM
+    return (uint8_t)xPortGetCoreID();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief       Reads the cycle counter and the core it belongs to. Interrupts are masked in between, so the task
+ *              can't be moved to the other core after one of the reads (cycle counters of the cores differ).
+ *
+ * @param       uint8_t *_core
+ *              Core the cycles were read on.
+ *
+ * @return      Cycle counter of that core.
+ */
+static inline uint32_t readCoreCycles(uint8_t *_core)
+{
+#ifdef ESP_PLATFORM
+    uint32_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+    uint32_t cycles = readCycles();
+    *_core = readCore();
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+    return cycles;
+#else
+    *_core = readCore();
+    return readCycles();
+#endif
+}
+
+static int64_t readUs()
+{
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time();
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (int64_t)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+#endif
+}
+
+/**
+ * @brief       Captures the anchor of the core it runs on. Called directly and through IPC on the other core.
+ *
+ * @param       void *_arg
+ *              Unused.
+ */
+static void captureAnchor(void *_arg)
+{
+    (void)_arg;
+    uint8_t core;
+    int64_t us = readUs();
+    uint32_t cycles = readCoreCycles(&core);
+    struct profilerAnchor *a = &anchors[core];
+
+    a->us = us;
+    a->cycles = cycles;
+    a->ticks = readTicks();
+}
+
+/**
+ * @brief       profilerStart allocates the ring buffer (first time only) and starts recording.
+ *
+ * @return      true if recording, false if there is not enough memory.
+ *
+ * @note        CPU frequency must not change while profiling (disable dynamic frequency scaling and light sleep).
+ */
+bool profilerStart()
+{
+    if (events == NULL)
+    {
+#ifdef ESP_PLATFORM
+        events = (struct profilerEvent *)heap_caps_calloc(PROFILER_EVENT_COUNT, sizeof(struct profilerEvent),
+                                                          MALLOC_CAP_SPIRAM);
+#else
+        events = (struct profilerEvent *)calloc(PROFILER_EVENT_COUNT, sizeof(struct profilerEvent));
+#endif
+        if (events == NULL)
+            return false;
+    }
+
+#ifdef ESP_PLATFORM
+    cyclesPerUs = esp_rom_get_cpu_ticks_per_us();
+    cyclesPerTick = cyclesPerUs * 1000 * portTICK_PERIOD_MS;
+    captureAnchor(NULL);
+    for (int i = 0; i < PROFILER_CORES; i++)
+    {
+        if (i != readCore())
+            esp_ipc_call_blocking(i, captureAnchor, NULL);
+    }
+#else
+    cyclesPerUs = 1000;
+    cyclesPerTick = 1000000;
+    captureAnchor(NULL);
+#endif
+
+    running = true;
+    return true;
+}
+
+/**
+ * @brief       profilerStop stops recording, recorded events are kept for the dump.
+ */
+void profilerStop()
+{
+    running = false;
+}
+
+/**
+ * @brief       profilerClear removes all recorded events.
+ */
+void profilerClear()
+{
+    __atomic_store_n(&writeIndex, 0, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief       profilerIsRunning checks if the profiler is recording.
+ *
+ * @return      true if recording.
+ */
+bool profilerIsRunning()
+{
+    return running;
+}
+
+/**
+ * @brief       profilerWrite records one event. Lock-free, safe to call from any task on any core. Use the
+ *              PROFILER_xxx macros instead, they are removed from the build if INKPLATE_PROFILER is 0.
+ *
+ * @param       const char *_name
+ *              Event name, pointer is stored, so it must stay valid until the dump.
+ * @param       char _phase
+ *              'B' begin, 'E' end, 'i' instant.
+ * @param       uint16_t _arg
+ *              Optional argument shown in the trace.
+ */
+void profilerWrite(const char *_name, char _phase, uint16_t _arg)
+{
+    if (!running)
+        return;
+
+    uint8_t core;
+    uint32_t cycles = readCoreCycles(&core);
+    uint32_t i = __atomic_fetch_add(&writeIndex, 1, __ATOMIC_RELAXED);
+    struct profilerEvent *e = &events[i & (PROFILER_EVENT_COUNT - 1)];
+
+    e->cycles = cycles;
+    e->ticks = readTicks();
+    e->name = _name;
+    e->thread = readThread();
+    e->arg = _arg;
+    e->core = core;
+    e->phase = _phase;
+}
+
+/**
+ * @brief       profilerGetEventCount returns the number of events in the ring buffer.
+ *
+ * @return      Number of events, at most PROFILER_EVENT_COUNT.
+ */
+uint32_t profilerGetEventCount()
+{
+    uint32_t written = __atomic_load_n(&writeIndex, __ATOMIC_RELAXED);
+    return written < PROFILER_EVENT_COUNT ? written : PROFILER_EVENT_COUNT;
+}
+
+/**
+ * @brief       profilerGetDropped returns how many of the oldest events were overwritten.
+ *
+ * @return      Number of lost events, increase PROFILER_EVENT_COUNT if it's not 0.
+ */
+uint32_t profilerGetDropped()
+{
+    uint32_t written = __atomic_load_n(&writeIndex, __ATOMIC_RELAXED);
+    return written > PROFILER_EVENT_COUNT ? written - PROFILER_EVENT_COUNT : 0;
+}
+
+/**
+ * @brief       Converts the event time into microseconds. The tick count tells roughly how much time has passed
+ *              since the anchor, the 32 bit cycle counter gives the exact time within the wrap around period.
+ *
+ * @param       const struct profilerEvent *_e
+ *              Recorded event.
+ *
+ * @return      Microseconds since boot.
+ */
+static double eventTime(const struct profilerEvent *_e)
+{
+    const struct profilerAnchor *a = &anchors[_e->core < PROFILER_CORES ? _e->core : 0];
+
+    int64_t coarse = (int64_t)(int32_t)(_e->ticks - a->ticks) * cyclesPerTick;
+    int32_t fine = (int32_t)(_e->cycles - (uint32_t)(a->cycles + coarse));
+    int64_t cycles = coarse + fine;
+
+    return (double)a->us + (double)cycles / cyclesPerUs;
+}
+
+/**
+ * @brief       profilerDumpJson writes the recorded events as Chrome trace JSON, oldest first.
+ *
+ * @param       void (*_write)(const char *_data, size_t _len, void *_user)
+ *              Called with every chunk of JSON.
+ * @param       void *_user
+ *              Passed to _write (e.g. Print object or FILE).
+ *
+ * @return      Number of bytes written.
+ *
+ * @note        Call profilerStop() first, events written during the dump can be torn.
+ */
+size_t profilerDumpJson(void (*_write)(const char *_data, size_t _len, void *_user), void *_user)
+{
+    char line[192];
+    size_t total = 0;
+    uint32_t written = __atomic_load_n(&writeIndex, __ATOMIC_RELAXED);
+    uint32_t first = written > PROFILER_EVENT_COUNT ? written - PROFILER_EVENT_COUNT : 0;
+    int len;
+
+    len = snprintf(line, sizeof(line), "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":%lu},\"traceEvents\":[",
+                   (unsigned long)first);
+    _write(line, len, _user);
+    total += len;
+
+    for (uint32_t i = first; events != NULL && i < written; i++)
+    {
+        const struct profilerEvent *e = &events[i & (PROFILER_EVENT_COUNT - 1)];
+
+        len = snprintf(line, sizeof(line),
+                       "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%lu,%s"
+                       "\"args\":{\"core\":%u,\"arg\":%u}}",
+                       i == first ? "" : ",", e->name != NULL ? e->name : "?", e->phase, eventTime(e),
+                       (unsigned long)e->thread, e->phase == 'i' ? "\"s\":\"t\"," : "", e->core, e->arg);
+        if (len >= (int)sizeof(line))
+            len = sizeof(line) - 1;
+        _write(line, len, _user);
+        total += len;
+    }
+
+    _write("\n]}\n", 4, _user);
+    return total + 4;
+}
@@ -0,0 +1,132 @@
+/**
+ **************************************************
+ * @file        Profiler.h
+ * @brief       Hot path profiler. Trace points are written into a lock-free ring buffer with the CPU cycle
+ *              counter as the time source, the buffer is dumped as Chrome trace JSON (chrome://tracing,
+ *              ui.perfetto.dev). Also the backend of LVGL's LV_PROFILER_* hooks.
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// INKPLATE_PROFILER switch lives in lv_conf.h.
+#include "../../lvgl/src/lv_conf_internal.h"
+
+// Number of events in the ring buffer, must be a power of 2. Oldest events are overwritten when it's full.
+#ifndef PROFILER_EVENT_COUNT
+#define PROFILER_EVENT_COUNT 4096
+#endif
+
+/**
+ * @brief       One trace event.
+ */
+struct profilerEvent
+{
+    uint32_t cycles;  // Lower 32 bits of the cycle counter of the core.
+    uint32_t ticks;   // Coarse time (RTOS ticks), used to unwrap the cycle counter.
+    const char *name; // Must stay valid until the dump (string literal, function name...).
+    uint32_t thread;  // Task that wrote the event.
+    uint16_t arg;     // Optional argument, e.g. waveform phase index.
+    uint8_t core;
+    char phase; // 'B' begin, 'E' end, 'i' instant.
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+bool profilerStart();
+void profilerStop();
+void profilerClear();
+bool profilerIsRunning();
+void profilerWrite(const char *_name, char _phase, uint16_t _arg);
+uint32_t profilerGetEventCount();
+uint32_t profilerGetDropped();
+size_t profilerDumpJson(void (*_write)(const char *_data, size_t _len, void *_user), void *_user);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if INKPLATE_PROFILER
+#define PROFILER_BEGIN(name)          profilerWrite((name), 'B', 0)
+#define PROFILER_END(name)            profilerWrite((name), 'E', 0)
+#define PROFILER_BEGIN_ARG(name, arg) profilerWrite((name), 'B', (arg))
+#define PROFILER_END_ARG(name, arg)   profilerWrite((name), 'E', (arg))
+#define PROFILER_INSTANT(name)        profilerWrite((name), 'i', 0)
+#else
+#define PROFILER_BEGIN(name)
+#define PROFILER_END(name)
+#define PROFILER_BEGIN_ARG(name, arg)
+#define PROFILER_END_ARG(name, arg)
+#define PROFILER_INSTANT(name)
+#endif
+
+#ifdef __cplusplus
+/**
+ * @brief       Writes begin event when created and end event when it goes out of scope, so functions with many
+ *              return paths need only one trace point.
+ */
+class ProfilerScope
+{
+  public:
+    ProfilerScope(const char *_name) : _scopeName(_name)
+    {
+        profilerWrite(_scopeName, 'B', 0);
+    }
+    ~ProfilerScope()
+    {
+        profilerWrite(_scopeName, 'E', 0);
+    }
+
+  private:
+    const char *_scopeName;
+};
+
+#if INKPLATE_PROFILER
+#define PROFILER_SCOPE(name) ProfilerScope _profilerScope(name)
+#else
+#define PROFILER_SCOPE(name)
+#endif
+
+#ifdef ARDUINO
+#include "Print.h"
+
+/**
+ * @brief       profilerDump writes the recorded events as Chrome trace JSON to Serial, a file on the SD card or
+ *              anything else that is Print.
+ *
+ * @param       Print &_out
+ *              Where to write the JSON.
+ *
+ * @return      Number of bytes written.
+ *
+ * @note        Call profilerStop() first, events written during the dump can be torn.
+ */
+static inline size_t profilerDump(Print &_out)
+{
+    return profilerDumpJson([](const char *_data, size_t _len, void *_user) {
+        ((Print *)_user)->write((const uint8_t *)_data, _len);
+    }, &_out);
+}
+#endif
+#endif
+
+#endif
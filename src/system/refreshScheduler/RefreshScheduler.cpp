@@ -0,0 +1,301 @@
+/**
+ **************************************************
+ * @file        RefreshScheduler.cpp
+ * @brief       Automatic panel refresh. Collects what LVGL has redrawn, waits until a burst of changes is over
+ *              and then picks partial, full or clean full refresh of the panel.
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#include "RefreshScheduler.h"
+#include "../../Inkplate-LVGL.h"
+
+#define SCREEN_PIXELS ((uint32_t)E_INK_WIDTH * E_INK_HEIGHT)
+
+/**
+ * @brief       begin starts the scheduler. After this, don't call display() or partialUpdate() after
+ *              lv_timer_handler(), the scheduler does it.
+ *
+ * @param       Inkplate *_inkplatePtr
+ *              Inkplate object, begin() must already be called.
+ * @param       const struct refreshSchedulerConfig *_cfg
+ *              Thresholds, REFRESH_SCHEDULER_DEFAULT is used if NULL.
+ *
+ * @return      true if started, false if already started or LVGL is not initialized.
+ *
+ * @note        Partial update limit of the driver (setFullUpdateThreshold()) is disabled, ghostBudget is used
+ *              instead.
+ */
+bool RefreshScheduler::begin(Inkplate *_inkplatePtr, const struct refreshSchedulerConfig *_cfg)
+{
+    if (_timer != NULL || _inkplatePtr == NULL || _inkplatePtr->disp == NULL)
+        return false;
+
+    _inkplate = _inkplatePtr;
+    if (_cfg != NULL)
+        _config = *_cfg;
+
+    // Debounce timer, it's (re)started on every finished LVGL refresh that has redrawn something.
+    _timer = lv_timer_create(timerCallback, _config.debounceMs, this);
+    if (_timer == NULL)
+        return false;
+    lv_timer_pause(_timer);
+
+    lv_display_add_event_cb(_inkplate->disp, eventCallback, LV_EVENT_FLUSH_START, this);
+    lv_display_add_event_cb(_inkplate->disp, eventCallback, LV_EVENT_REFR_READY, this);
+
+#ifdef USES_WAVEFORM_ENGINE
+    _inkplate->setFullUpdateThreshold(0);
+#endif
+
+    return true;
+}
+
+/**
+ * @brief       end stops the scheduler, panel has to be refreshed manually again.
+ */
+void RefreshScheduler::end()
+{
+    if (_timer == NULL)
+        return;
+
+    lv_display_remove_event_cb_with_user_data(_inkplate->disp, eventCallback, this);
+    lv_timer_delete(_timer);
+    _timer = NULL;
+}
+
+/**
+ * @brief       setConfig changes the scheduler thresholds.
+ *
+ * @param       const struct refreshSchedulerConfig *_cfg
+ *              New thresholds.
+ */
+void RefreshScheduler::setConfig(const struct refreshSchedulerConfig *_cfg)
+{
+    if (_cfg == NULL)
+        return;
+
+    _config = *_cfg;
+    if (_timer != NULL)
+        lv_timer_set_period(_timer, _config.debounceMs);
+}
+
+/**
+ * @brief       requestClean makes the next refresh a clean full one, even if nothing has changed.
+ *
+ * @note        Same as any other LVGL call, take the LVGL lock if the LVGL service is used.
+ */
+void RefreshScheduler::requestClean()
+{
+    _cleanRequested = true;
+
+    if (_timer != NULL)
+    {
+        lv_timer_reset(_timer);
+        lv_timer_resume(_timer);
+    }
+}
+
+/**
+ * @brief       getLastRefresh returns the type of the last panel refresh done by the scheduler.
+ *
+ * @return      REFRESH_NONE, REFRESH_PARTIAL, REFRESH_FULL or REFRESH_CLEAN.
+ */
+uint8_t RefreshScheduler::getLastRefresh()
+{
+    return _lastRefresh;
+}
+
+/**
+ * @brief       getRefreshCount returns how many refreshes of the type were done since begin().
+ *
+ * @param       uint8_t _type
+ *              REFRESH_PARTIAL, REFRESH_FULL or REFRESH_CLEAN.
+ *
+ * @return      Number of refreshes.
+ */
+uint32_t RefreshScheduler::getRefreshCount(uint8_t _type)
+{
+    return _type < 4 ? _refreshCount[_type] : 0;
+}
+
+/**
+ * @brief       getGhosting returns black to white pixels of partial updates since the last full update.
+ *
+ * @return      Number of pixels, full update is forced when it reaches ghostBudget.
+ */
+uint32_t RefreshScheduler::getGhosting()
+{
+    return _ghosting;
+}
+
+/**
+ * @brief       eventCallback collects the flushed area. In LV_DISPLAY_RENDER_MODE_FULL every flush is the whole
+ *              screen, pickRefresh() counts the changed pixels in the framebuffer instead.
+ *
+ * @param       lv_event_t *_e
+ *              LVGL display event, user data is the RefreshScheduler.
+ */
+void RefreshScheduler::eventCallback(lv_event_t *_e)
+{
+    RefreshScheduler *self = (RefreshScheduler *)lv_event_get_user_data(_e);
+    lv_event_code_t code = lv_event_get_code(_e);
+
+    if (code == LV_EVENT_FLUSH_START)
+    {
+        const lv_area_t *area = (const lv_area_t *)lv_event_get_param(_e);
+        uint32_t size = area != NULL ? lv_area_get_size(area) : SCREEN_PIXELS;
+
+        // Overlapping areas are counted twice, it's only an estimate.
+        self->_changedPixels += size;
+        if (self->_changedPixels > SCREEN_PIXELS)
+            self->_changedPixels = SCREEN_PIXELS;
+    }
+    else if (code == LV_EVENT_REFR_READY && self->_changedPixels != 0)
+    {
+        // Panel is refreshed when nothing new was drawn for debounceMs.
+        lv_timer_reset(self->_timer);
+        lv_timer_resume(self->_timer);
+    }
+}
+
+/**
+ * @brief       timerCallback is called when debounce time has passed since the last redraw.
+ *
+ * @param       lv_timer_t *_t
+ *              Debounce timer, user data is the RefreshScheduler.
+ */
+void RefreshScheduler::timerCallback(lv_timer_t *_t)
+{
+    RefreshScheduler *self = (RefreshScheduler *)lv_timer_get_user_data(_t);
+
+    lv_timer_pause(_t);
+    self->refresh();
+}
+
+/**
+ * @brief       pickRefresh selects the refresh type from the changed area, ghosting and clean interval.
+ *
+ * @return      REFRESH_PARTIAL, REFRESH_FULL or REFRESH_CLEAN.
+ */
+uint8_t RefreshScheduler::pickRefresh()
+{
+#ifdef USES_WAVEFORM_ENGINE
+    if (_inkplate->_renderMode == LV_DISPLAY_RENDER_MODE_FULL && _inkplate->getDisplayMode() == INKPLATE_1BIT)
+        _changedPixels = framebufferChanges();
+
+    bool smallChange = (uint64_t)_changedPixels * 100 <= (uint64_t)SCREEN_PIXELS * _config.partialMaxPercent;
+
+    if (!_cleanRequested && _inkplate->getDisplayMode() == INKPLATE_1BIT && smallChange &&
+        _ghosting < _config.ghostBudget)
+        return REFRESH_PARTIAL;
+#endif
+
+    if (_cleanRequested || (_config.cleanEvery != 0 && _fullSinceClean + 1 >= _config.cleanEvery))
+        return REFRESH_CLEAN;
+
+    return REFRESH_FULL;
+}
+
+#ifdef USES_WAVEFORM_ENGINE
+/**
+ * @brief       framebufferChanges counts the pixels of the 1 bit framebuffer that differ from the panel.
+ *
+ * @return      Number of changed pixels, whole screen if there are no framebuffers.
+ */
+uint32_t RefreshScheduler::framebufferChanges()
+{
+    if (!_inkplate->hasFramebuffers())
+        return SCREEN_PIXELS;
+
+    const uint8_t *next = _inkplate->_partial;
+    const uint8_t *shown = _inkplate->DMemoryNew;
+    uint32_t bytes = SCREEN_PIXELS / 8;
+    uint32_t words = bytes / 4;
+    uint32_t changed = 0;
+
+    for (uint32_t i = 0; i < words; i++)
+        changed += __builtin_popcount(((const uint32_t *)next)[i] ^ ((const uint32_t *)shown)[i]);
+    for (uint32_t i = words * 4; i < bytes; i++)
+        changed += __builtin_popcount(next[i] ^ shown[i]);
+
+    return changed;
+}
+
+/**
+ * @brief       partialFallsBack checks if partialUpdate() would do a full update instead: partial updates are
+ *              blocked (after begin, a display mode change or a clean) or its limiter is reached.
+ *
+ * @return      true if the next partialUpdate() is a full update.
+ */
+bool RefreshScheduler::partialFallsBack()
+{
+    return _inkplate->_blockPartial == 1 ||
+           (_inkplate->_partialUpdateLimiter != 0 &&
+            _inkplate->_partialUpdateCounter >= _inkplate->_partialUpdateLimiter);
+}
+#endif
+
+/**
+ * @brief       refresh updates the panel with the picked refresh type.
+ */
+void RefreshScheduler::refresh()
+{
+    uint8_t type = pickRefresh();
+
+    if (type == REFRESH_PARTIAL)
+    {
+#ifdef USES_WAVEFORM_ENGINE
+        bool full = partialFallsBack();
+        uint32_t blur = _inkplate->partialUpdate();
+
+        // Full update done by partialUpdate() (also when there was no memory for the partial buffer).
+        if (full || _inkplate->_pBuffer == NULL)
+        {
+            type = REFRESH_FULL;
+            _fullSinceClean++;
+            _ghosting = 0;
+        }
+        else
+        {
+            _ghosting += blur;
+        }
+#endif
+    }
+    else
+    {
+        if (type == REFRESH_CLEAN)
+        {
+#ifdef USES_WAVEFORM_ENGINE
+            _inkplate->clean(1, REFRESH_SCHEDULER_CLEAN_REP);
+            _inkplate->clean(0, REFRESH_SCHEDULER_CLEAN_REP);
+            _inkplate->clean(2, 1);
+#else
+            _inkplate->clean();
+#endif
+            _fullSinceClean = 0;
+            _cleanRequested = false;
+        }
+        else
+        {
+            _fullSinceClean++;
+        }
+
+        _inkplate->display();
+        _ghosting = 0;
+    }
+
+    _changedPixels = 0;
+    _lastRefresh = type;
+    _refreshCount[type]++;
+}
@@ -0,0 +1,89 @@
+/**
+ **************************************************
+ * @file        RefreshScheduler.h
+ * @brief       Automatic panel refresh. Collects what LVGL has redrawn, waits until a burst of changes is over
+ *              and then picks partial, full or clean full refresh of the panel.
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#ifndef __REFRESH_SCHEDULER_H__
+#define __REFRESH_SCHEDULER_H__
+
+#include "Arduino.h"
+#include "../../lvgl/lvgl.h"
+
+class Inkplate;
+
+// Refresh types picked by the scheduler.
+#define REFRESH_NONE    0
+#define REFRESH_PARTIAL 1 // Fast 1 bit partial update.
+#define REFRESH_FULL    2 // Full update in the current display mode (1 bit or grayscale).
+#define REFRESH_CLEAN   3 // Panel cleaning cycles followed by the full update.
+
+// Repetitions of the darken and lighten cycles of the clean full refresh.
+#define REFRESH_SCHEDULER_CLEAN_REP 8
+
+/**
+ * @brief       Scheduler thresholds.
+ */
+struct refreshSchedulerConfig
+{
+    uint32_t debounceMs;       // Panel is refreshed only after LVGL hasn't redrawn anything for this long.
+    uint8_t partialMaxPercent; // Changed area (percent of the screen) up to which partial update is used.
+    uint32_t ghostBudget;      // Black to white pixels of partial updates allowed before a full update.
+    uint16_t cleanEvery;       // Every Nth full update is a clean one, 0 - never.
+};
+
+#define REFRESH_SCHEDULER_DEFAULT {300, 30, 100000, 10}
+
+/**
+ * @brief       Refresh scheduler. Runs as an LVGL timer, so the panel is refreshed from lv_timer_handler()
+ *              (or from the LVGL service task).
+ *
+ * @note        Partial update is only possible in 1 bit mode on boards with the waveform engine, everything
+ *              else always gets a full update.
+ */
+class RefreshScheduler
+{
+  public:
+    bool begin(Inkplate *_inkplatePtr, const struct refreshSchedulerConfig *_cfg = NULL);
+    void end();
+    void setConfig(const struct refreshSchedulerConfig *_cfg);
+    void requestClean();
+
+    uint8_t getLastRefresh();
+    uint32_t getRefreshCount(uint8_t _type);
+    uint32_t getGhosting();
+
+  private:
+    static void eventCallback(lv_event_t *_e);
+    static void timerCallback(lv_timer_t *_t);
+    uint8_t pickRefresh();
+    uint32_t framebufferChanges(); // Boards with the waveform engine only.
+    bool partialFallsBack();
+    void refresh();
+
+    struct refreshSchedulerConfig _config = REFRESH_SCHEDULER_DEFAULT;
+    Inkplate *_inkplate = NULL;
+    lv_timer_t *_timer = NULL;
+
+    uint32_t _changedPixels = 0; // Sum of the redrawn areas since the last panel refresh.
+    uint32_t _ghosting = 0;      // Black to white pixels of partial updates since the last full update.
+    uint16_t _fullSinceClean = 0;
+    bool _cleanRequested = false;
+    uint8_t _lastRefresh = REFRESH_NONE;
+    uint32_t _refreshCount[4] = {0, 0, 0, 0};
+};
+
+#endif
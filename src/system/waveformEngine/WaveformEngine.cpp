@@ -0,0 +1,527 @@
+/**
+ **************************************************
+ * @file        WaveformEngine.cpp
+ * @brief       Table driven waveform engine shared by all parallel EPD boards
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#include "WaveformEngine.h"
+#include "../../boardSelect.h"
+#include "esp_heap_caps.h"
+#include "../memoryStats/MemoryStats.h"
+#include "../profiler/Profiler.h"
+#include "../../graphics/GraphicsDefs.h"
+#ifdef USES_WAVEFORM_ENGINE
+
+// Pixel data for each of the clean patterns (white, black, discharge, skip).
+static const uint8_t cleanPatterns[4] = {B10101010, B01010101, B00000000, B11111111};
+
+/**
+ * @brief       Initializes the waveform engine and allocates memory for the grayscale LUTs.
+ *
+ * @param       volatile uint8_t *_lineBuffer
+ *              Buffer for one line of EPD data (width / 4 bytes). If NULL, engine will allocate it.
+ *
+ * @param       int _width
+ *              Width of the panel in pixels.
+ *
+ * @param       int _height
+ *              Height of the panel in pixels.
+ *
+ * @param       uint8_t _flags
+ *              WAVEFORM_FLAG_xxx flags describing the board.
+ *
+ * @return      True if initialization is successful, false if memory allocation failed.
+ */
+bool WaveformEngine::beginWaveformEngine(volatile uint8_t *_lineBuffer, int _width, int _height, uint8_t _flags)
+{
+    _waveformWidth = _width;
+    _waveformHeight = _height;
+    _waveformFlags = _flags;
+
+    _waveformLine = _lineBuffer;
+    if (_waveformLine == NULL)
+        _waveformLine = (uint8_t *)trackedMalloc(MEMORY_TAG_DRIVER, _width / 4, _waveformCaps);
+
+    // Framebuffers are in PSRAM, each row is copied into internal RAM before it's converted into EPD data.
+    // Row of the 4 bit framebuffer is the largest one.
+    _waveformRow = (uint8_t *)trackedMalloc(MEMORY_TAG_DRIVER, _width / 2, _waveformCaps);
+
+    // One byte per framebuffer byte for each of the 9 phases, keep it in internal RAM.
+    GLUT = (uint8_t *)trackedMalloc(MEMORY_TAG_DRIVER, 256 * 9, _waveformCaps);
+
+    if (_waveformLine == NULL || _waveformRow == NULL || GLUT == NULL)
+        return false;
+
+    calculateLUTs();
+
+    return true;
+}
+
+/**
+ * @brief       Loads new 3 bit grayscale waveform. Can be called at any time, LUTs are
+ *              recalculated immediately.
+ *
+ * @param       const uint8_t _waveform[8][9]
+ *              Waveform, 9 phases for each of the 8 shades of gray.
+ */
+void WaveformEngine::setWaveform(const uint8_t _waveform[8][9])
+{
+    memcpy(waveform3Bit, _waveform, sizeof(waveform3Bit));
+
+    // LUTs are not allocated if this is called before the engine init. They will be calculated there.
+    if (GLUT != NULL)
+        calculateLUTs();
+}
+
+/**
+ * @brief       Selects the waveform table for the specific refresh type.
+ *
+ * @param       uint8_t _type
+ *              WAVEFORM_TABLE_1BIT, WAVEFORM_TABLE_3BIT or WAVEFORM_TABLE_PARTIAL.
+ *
+ * @param       const struct waveformTable *_table
+ *              Pointer to the new table. Table must stay valid as long as it's in use.
+ *
+ * @return      true if the table is set, false if the type or one of the phases is not valid (the table in use
+ *              is not changed then).
+ */
+bool WaveformEngine::setWaveformTable(uint8_t _type, const struct waveformTable *_table)
+{
+    if (_type > WAVEFORM_TABLE_PARTIAL)
+        return false;
+
+    if (_table != NULL)
+    {
+        if (_table->phaseCount != 0 && _table->phases == NULL)
+            return false;
+
+        for (int i = 0; i < _table->phaseCount; i++)
+        {
+            const struct waveformPhase *_phase = &_table->phases[i];
+            switch (_phase->source)
+            {
+            case WAVEFORM_SOURCE_CLEAN:
+                if (_phase->param > WAVEFORM_CLEAN_SKIP)
+                    return false;
+                break;
+            case WAVEFORM_SOURCE_1BIT:
+                if (_phase->param > WAVEFORM_LUT_BW)
+                    return false;
+                break;
+            case WAVEFORM_SOURCE_3BIT:
+                // Every frame uses the next of the 9 columns of GLUT.
+                if (_phase->param + _phase->repeat > 9)
+                    return false;
+                break;
+            case WAVEFORM_SOURCE_PARTIAL:
+                break;
+            default:
+                return false;
+            }
+        }
+    }
+
+    _waveformTables[_type] = _table;
+    return true;
+}
+
+/**
+ * @brief       Gets the currently used waveform table for the specific refresh type.
+ *
+ * @param       uint8_t _type
+ *              WAVEFORM_TABLE_1BIT, WAVEFORM_TABLE_3BIT or WAVEFORM_TABLE_PARTIAL.
+ *
+ * @return      Pointer to the table, NULL if not set.
+ */
+const struct waveformTable *WaveformEngine::getWaveformTable(uint8_t _type)
+{
+    if (_type > WAVEFORM_TABLE_PARTIAL)
+        return NULL;
+
+    return _waveformTables[_type];
+}
+
+/**
+ * @brief       Gets the number of phases sent during the last refresh.
+ *
+ * @return      Number of phases, use it with getPhaseTime().
+ */
+uint8_t WaveformEngine::getPhaseCount()
+{
+    return _phaseCount;
+}
+
+/**
+ * @brief       Gets how long it took to send one phase of the last refresh to the panel.
+ *
+ * @param       uint8_t _phase
+ *              Index of the phase in the waveform table.
+ *
+ * @return      Time in microseconds (all frames of the phase with frame delays), 0 if phase doesn't exist.
+ */
+uint32_t WaveformEngine::getPhaseTime(uint8_t _phase)
+{
+    if (_phase >= _phaseCount)
+        return 0;
+
+    return _phaseTime[_phase];
+}
+
+/**
+ * @brief       Calculates the values of the lookup table to
+ *              speed up rendering
+ *
+ * @note        Each entry holds EPD data (4 bits) for two pixels of one framebuffer byte. Two
+ *              framebuffer bytes make one byte of EPD data: (GLUT[first] << 4) | GLUT[second].
+ */
+void WaveformEngine::calculateLUTs()
+{
+    for (int j = 0; j < 9; ++j)
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            GLUT[j * 256 + i] = (waveform3Bit[i & 0x07][j] << 2) | (waveform3Bit[(i >> 4) & 0x07][j]);
+        }
+    }
+}
+
+/**
+ * @brief       Calculates the EPD data for the partial update from the difference of the two
+ *              1 bit framebuffers.
+ *
+ * @param       const uint8_t *_oldFramebuffer
+ *              Framebuffer with the image currently on the panel.
+ *
+ * @param       const uint8_t *_newFramebuffer
+ *              Framebuffer with the new image.
+ *
+ * @param       uint8_t *_pBuffer
+ *              Output buffer for the EPD data (2 bits per pixel).
+ *
+ * @return      Number of pixels changed from black to white, leaving blur
+ */
+uint32_t IRAM_ATTR WaveformEngine::calculatePartial(const uint8_t *_oldFramebuffer, const uint8_t *_newFramebuffer,
+                                                    uint8_t *_pBuffer)
+{
+    PROFILER_SCOPE("calculatePartial");
+
+    uint32_t changeCount = 0;
+    uint32_t _n = (_waveformWidth * _waveformHeight) / 8;
+
+    for (uint32_t i = 0; i < _n; ++i)
+    {
+        uint8_t diffw = _oldFramebuffer[i] & ~_newFramebuffer[i];
+        uint8_t diffb = ~_oldFramebuffer[i] & _newFramebuffer[i];
+
+        // Count pixels turning from black to white as these are visible blur
+        changeCount += __builtin_popcount(diffw);
+
+        _pBuffer[(i * 2) + 1] = LUTW[diffw >> 4] & (LUTB[diffb >> 4]);
+        _pBuffer[i * 2] = LUTW[diffw & 0x0F] & (LUTB[diffb & 0x0F]);
+    }
+
+    return changeCount;
+}
+
+/**
+ * @brief       Fills the whole line buffer with the same data.
+ *
+ * @param       volatile uint8_t *_line
+ *              Line buffer.
+ *
+ * @param       uint8_t _data
+ *              EPD data for 4 pixels.
+ */
+void IRAM_ATTR WaveformEngine::fillLine(volatile uint8_t *_line, uint8_t _data)
+{
+    for (int i = 0; i < (_waveformWidth / 4); i++)
+    {
+        _line[i] = _data;
+    }
+}
+
+/**
+ * @brief       Converts one framebuffer row into the EPD data for the current phase. Rows are sent
+ *              to the panel from the last pixel to the first one.
+ *
+ * @param       volatile uint8_t *_line
+ *              Line buffer for the EPD data.
+ *
+ * @param       const struct waveformPhase *_phase
+ *              Current phase.
+ *
+ * @param       uint8_t _frame
+ *              Current frame of the phase.
+ *
+ * @param       const uint8_t *_row
+ *              Start of the framebuffer row.
+ */
+void IRAM_ATTR WaveformEngine::buildLine(volatile uint8_t *_line, const struct waveformPhase *_phase, uint8_t _frame,
+                                         const uint8_t *_row)
+{
+    // I2S sends 16 bit halves of the 32 bit word in swapped order.
+    const uint8_t _swizzle = (_waveformFlags & WAVEFORM_FLAG_I2S_SWIZZLE) ? 2 : 0;
+    int _lineBytes = _waveformWidth / 4;
+
+    switch (_phase->source)
+    {
+    case WAVEFORM_SOURCE_1BIT: {
+        const uint8_t *_lut = (_phase->param == WAVEFORM_LUT_BW) ? LUT2 : LUTB;
+        const uint8_t *_dp = _row + (_waveformWidth / 8);
+        for (int j = 0; j < _lineBytes; j += 2)
+        {
+            uint8_t _dram = *(--_dp);
+            _line[j ^ _swizzle] = _lut[(_dram >> 4) & 0x0F];
+            _line[(j + 1) ^ _swizzle] = _lut[_dram & 0x0F];
+        }
+        break;
+    }
+    case WAVEFORM_SOURCE_3BIT: {
+        const uint8_t *_glut = GLUT + ((_phase->param + _frame) * 256);
+        const uint8_t *_dp = _row + (_waveformWidth / 2);
+        for (int j = 0; j < _lineBytes; j++)
+        {
+            uint8_t _t = _glut[*(--_dp)] << 4;
+            _t |= _glut[*(--_dp)];
+            _line[j ^ _swizzle] = _t;
+        }
+        break;
+    }
+    case WAVEFORM_SOURCE_PARTIAL: {
+        const uint8_t *_dp = _row + _lineBytes;
+        for (int j = 0; j < _lineBytes; j++)
+        {
+            _line[j ^ _swizzle] = *(--_dp);
+        }
+        break;
+    }
+    }
+}
+
+/**
+ * @brief       Sends the waveform table for the selected refresh type to the panel.
+ *
+ * @param       uint8_t _type
+ *              WAVEFORM_TABLE_1BIT, WAVEFORM_TABLE_3BIT or WAVEFORM_TABLE_PARTIAL.
+ *
+ * @param       const uint8_t *_framebuffer
+ *              Framebuffer used by the data phases of the table.
+ */
+void WaveformEngine::runWaveform(uint8_t _type, const uint8_t *_framebuffer)
+{
+    if (_type > WAVEFORM_TABLE_PARTIAL || _waveformTables[_type] == NULL)
+        return;
+
+    runWaveform(_waveformTables[_type], _framebuffer);
+}
+
+/**
+ * @brief       Sends all phases of the waveform table to the panel.
+ *
+ * @param       const struct waveformTable *_table
+ *              Table with the waveform phases.
+ *
+ * @param       const uint8_t *_framebuffer
+ *              Framebuffer used by the data phases of the table. Can be NULL if the table
+ *              has only clean phases.
+ *
+ * @note        Panel power supply must be already turned on!
+ */
+void IRAM_ATTR WaveformEngine::runWaveform(const struct waveformTable *_table, const uint8_t *_framebuffer)
+{
+    PROFILER_SCOPE("runWaveform");
+
+    bool _async = (_waveformFlags & WAVEFORM_FLAG_ASYNC_LINES);
+    bool _cleanLines = (_waveformFlags & WAVEFORM_FLAG_CLEAN_LINES);
+    uint32_t _refreshStart = micros();
+    _cpuFreeTime = 0;
+    _phaseCount = _table->phaseCount < WAVEFORM_MAX_PHASES ? _table->phaseCount : WAVEFORM_MAX_PHASES;
+
+    for (int p = 0; p < _table->phaseCount; ++p)
+    {
+        const struct waveformPhase *_phase = &_table->phases[p];
+        uint32_t _phaseStart = micros();
+        bool _isClean = (_phase->source == WAVEFORM_SOURCE_CLEAN);
+        int _stride = 0;
+
+        // Clean phase has the same line for the whole frame, build it only once (async mode fills each
+        // line buffer when it's free). Boards with prepared clean lines don't need it at all.
+        if (_isClean && !_async && !_cleanLines)
+            fillLine(_waveformLine, cleanPatterns[_phase->param & 0x03]);
+        else if (!_isClean && _framebuffer == NULL)
+            continue;
+
+        PROFILER_BEGIN_ARG("waveformPhase", p);
+
+        if (_phase->source == WAVEFORM_SOURCE_1BIT)
+            _stride = _waveformWidth / 8;
+        else if (_phase->source == WAVEFORM_SOURCE_3BIT)
+            _stride = _waveformWidth / 2;
+        else if (_phase->source == WAVEFORM_SOURCE_PARTIAL)
+            _stride = _waveformWidth / 4;
+
+        for (int k = 0; k < _phase->repeat; ++k)
+        {
+            vscan_start();
+            for (int i = 0; i < _waveformHeight; ++i)
+            {
+                volatile uint8_t *_line = _waveformLine;
+
+                // Board sends the prepared clean line, nothing to build.
+                if (_isClean && _cleanLines)
+                {
+                    uint32_t _waitStart = micros();
+                    sendCleanLine(_phase->param & 0x03);
+                    if (_async)
+                        _cpuFreeTime += micros() - _waitStart;
+                    else
+                        vscan_end();
+                    continue;
+                }
+
+                // Lines are sent in the background, wait for the free line buffer. CPU is free while waiting.
+                if (_async)
+                {
+                    uint32_t _waitStart = micros();
+                    _line = getFreeLine();
+                    _cpuFreeTime += micros() - _waitStart;
+
+                    if (_isClean)
+                        fillLine(_line, cleanPatterns[_phase->param & 0x03]);
+                }
+
+                if (!_isClean)
+                {
+                    // Read the whole row from PSRAM with one forward copy instead of byte by byte backwards.
+                    int _row = (_waveformFlags & WAVEFORM_FLAG_BOTTOM_UP) ? (_waveformHeight - 1 - i) : i;
+                    memcpy(_waveformRow, _framebuffer + (_row * _stride), _stride);
+                    buildLine(_line, _phase, k, _waveformRow);
+                }
+                sendLine();
+
+                // In async mode, board ends the row by itself as soon as the line is sent.
+                if (!_async)
+                    vscan_end();
+            }
+
+            // All lines of the frame must be sent before the next frame starts.
+            if (_async)
+            {
+                uint32_t _waitStart = micros();
+                waitForLines();
+                _cpuFreeTime += micros() - _waitStart;
+            }
+
+            if (_phase->frameDelay)
+                delayMicroseconds(_phase->frameDelay);
+        }
+
+        if (p < WAVEFORM_MAX_PHASES)
+            _phaseTime[p] = micros() - _phaseStart;
+        PROFILER_END_ARG("waveformPhase", p);
+    }
+
+    if (_table->parkGates)
+        vscan_start();
+
+    _refreshTime = micros() - _refreshStart;
+}
+
+/**
+ * @brief       Default free line hook for the boards that send lines synchronously,
+ *              there is only one line buffer.
+ *
+ * @return      Line buffer for the next line.
+ */
+volatile uint8_t *WaveformEngine::getFreeLine()
+{
+    return _waveformLine;
+}
+
+/**
+ * @brief       Default hook for the boards without prepared clean lines (WAVEFORM_FLAG_CLEAN_LINES),
+ *              it's never called for them.
+ *
+ * @param       uint8_t _clean
+ *              Clean pattern (WAVEFORM_CLEAN_xxx).
+ */
+void WaveformEngine::sendCleanLine(uint8_t _clean)
+{
+}
+
+/**
+ * @brief       Default hook for the boards that send lines synchronously, nothing to wait for.
+ */
+void WaveformEngine::waitForLines()
+{
+}
+
+/**
+ * @brief       Default hook for the boards that can't send lines in the background.
+ *
+ * @return      Always false, async mode is not supported.
+ */
+bool WaveformEngine::setLineSenderMode(bool _async)
+{
+    return false;
+}
+
+/**
+ * @brief       Enables or disables sending lines to the panel in the background (interrupt driven).
+ *              While lines are being sent, CPU is free for other tasks (LVGL rendering).
+ *
+ * @param       bool _enable
+ *              True to send lines in the background, false to wait for each line to be sent (polling).
+ *
+ * @return      True if mode is changed, false if board doesn't support it.
+ *
+ * @note        Off by default, lines are sent using polling. Background sending changes the panel timing (CKV low
+ *              time between the lines) and is not checked on every panel yet.
+ */
+bool WaveformEngine::setAsyncLines(bool _enable)
+{
+    if (!setLineSenderMode(_enable))
+        return false;
+
+    if (_enable)
+        _waveformFlags |= WAVEFORM_FLAG_ASYNC_LINES;
+    else
+        _waveformFlags &= ~WAVEFORM_FLAG_ASYNC_LINES;
+
+    return true;
+}
+
+/**
+ * @brief       Gets how long the last refresh (or clean) took.
+ *
+ * @return      Time in microseconds.
+ */
+uint32_t WaveformEngine::getRefreshTime()
+{
+    return _refreshTime;
+}
+
+/**
+ * @brief       Gets how much time CPU was free (waiting for the lines to be sent) during the last
+ *              refresh. CPU usage of the refresh is 1 - getCpuFreeTime() / getRefreshTime().
+ *
+ * @return      Time in microseconds. Always 0 if lines are sent using polling.
+ */
+uint32_t WaveformEngine::getCpuFreeTime()
+{
+    return _cpuFreeTime;
+}
+
+#endif
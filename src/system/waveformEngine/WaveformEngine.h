@@ -0,0 +1,145 @@
+/**
+ **************************************************
+ * @file        WaveformEngine.h
+ * @brief       Table driven waveform engine shared by all parallel EPD boards
+ *              (Inkplate 6, Inkplate 10, Inkplate 5V2 and Inkplate 6FLICK).
+ *
+ *              https://github.com/e-radionicacom/Inkplate-Arduino-library
+ *              For support, please reach over forums: forum.e-radionica.com/en
+ *              For more info about the product, please check: www.inkplate.io
+ *
+ *              This code is released under the GNU Lesser General Public
+ *License v3.0: https://www.gnu.org/licenses/lgpl-3.0.en.html Please review the
+ *LICENSE file included with this example. If you have any questions about
+ *licensing, please contact techsupport@e-radionica.com Distributed as-is; no
+ *warranty is given.
+ *
+ * @authors     Soldered
+ ***************************************************/
+
+#ifndef __WAVEFORM_ENGINE_H__
+#define __WAVEFORM_ENGINE_H__
+
+#include "Arduino.h"
+#include "esp_heap_caps.h"
+
+// Data source of a single waveform phase.
+#define WAVEFORM_SOURCE_CLEAN   0 // Constant pattern on every pixel, param selects the pattern (same as clean(c, rep)).
+#define WAVEFORM_SOURCE_1BIT    1 // 1 bit framebuffer, param selects the LUT (WAVEFORM_LUT_xxx).
+#define WAVEFORM_SOURCE_3BIT    2 // 4 bit framebuffer, param is the first column of the 3 bit waveform.
+#define WAVEFORM_SOURCE_PARTIAL 3 // Already converted 2 bit per pixel EPD data (partial update buffer).
+
+// LUTs for the 1 bit data source.
+#define WAVEFORM_LUT_BLACK 0 // Drive only black pixels (LUTB).
+#define WAVEFORM_LUT_BW    1 // Drive both black and white pixels (LUT2).
+
+// Clean patterns (param of the WAVEFORM_SOURCE_CLEAN).
+#define WAVEFORM_CLEAN_WHITE     0
+#define WAVEFORM_CLEAN_BLACK     1
+#define WAVEFORM_CLEAN_DISCHARGE 2
+#define WAVEFORM_CLEAN_SKIP      3
+
+// Flags describing how the board clocks lines into the panel.
+#define WAVEFORM_FLAG_BOTTOM_UP   0x01 // Send the last framebuffer row first.
+#define WAVEFORM_FLAG_I2S_SWIZZLE 0x02 // Swap 16 bit halves of each 32 bit word (I2S FIFO byte order).
+#define WAVEFORM_FLAG_ASYNC_LINES 0x04 // sendLine() only queues the line, board ends the row when the line is sent.
+#define WAVEFORM_FLAG_CLEAN_LINES 0x08 // Board has prepared clean lines, clean phases use sendCleanLine().
+
+// Max number of phases that are timed in one waveform table.
+#define WAVEFORM_MAX_PHASES 24
+
+// Refresh types that have their own waveform table. Typed, so a plain 0 doesn't also match the table pointer
+// overload of runWaveform().
+#define WAVEFORM_TABLE_1BIT    ((uint8_t)0)
+#define WAVEFORM_TABLE_3BIT    ((uint8_t)1)
+#define WAVEFORM_TABLE_PARTIAL ((uint8_t)2)
+
+/**
+ * @brief       One phase of the waveform. Phase is sent to the panel "repeat" times (frames) and after
+ *              each frame engine waits for "frameDelay" microseconds.
+ *
+ * @note        For the WAVEFORM_SOURCE_3BIT source, each frame uses the next column of the
+ *              3 bit waveform, starting from the column in "param".
+ */
+struct waveformPhase
+{
+    uint8_t source;
+    uint8_t param;
+    uint8_t repeat;
+    uint16_t frameDelay;
+};
+
+/**
+ * @brief       Complete waveform for one refresh type. If parkGates is set, gate drivers are
+ *              moved into the start position (vscan_start()) after the last phase.
+ */
+struct waveformTable
+{
+    const struct waveformPhase *phases;
+    uint8_t phaseCount;
+    uint8_t parkGates;
+};
+
+#define WAVEFORM_TABLE(_phases, _parkGates) {(_phases), sizeof(_phases) / sizeof((_phases)[0]), (_parkGates)}
+
+/**
+ * @brief       WaveformEngine class. Board driver inherits it and implements the panel
+ *              timing hooks, engine does everything else.
+ */
+class WaveformEngine
+{
+    // Times the protected LUT, diff and line building kernels.
+    friend class PipelineBenchmark;
+
+  public:
+    void setWaveform(const uint8_t _waveform[8][9]);
+    bool setWaveformTable(uint8_t _type, const struct waveformTable *_table);
+    const struct waveformTable *getWaveformTable(uint8_t _type);
+    uint8_t getPhaseCount();
+    uint32_t getPhaseTime(uint8_t _phase);
+    uint32_t getRefreshTime();
+    uint32_t getCpuFreeTime();
+    bool setAsyncLines(bool _enable);
+
+    uint8_t waveform3Bit[8][9];
+    uint8_t *GLUT = NULL;
+
+  protected:
+    bool beginWaveformEngine(volatile uint8_t *_lineBuffer, int _width, int _height, uint8_t _flags);
+    void runWaveform(const struct waveformTable *_table, const uint8_t *_framebuffer);
+    void runWaveform(uint8_t _type, const uint8_t *_framebuffer);
+    uint32_t calculatePartial(const uint8_t *_oldFramebuffer, const uint8_t *_newFramebuffer, uint8_t *_pBuffer);
+    void calculateLUTs();
+
+    // Panel timing hooks, implemented by the board driver.
+    virtual void vscan_start() = 0;
+    virtual void vscan_end() = 0;
+    virtual void sendLine() = 0;
+
+    // Hooks for the boards that send lines in the background (WAVEFORM_FLAG_ASYNC_LINES).
+    virtual volatile uint8_t *getFreeLine();
+    virtual void waitForLines();
+    virtual bool setLineSenderMode(bool _async);
+    virtual void sendCleanLine(uint8_t _clean);
+
+    volatile uint8_t *_waveformLine = NULL;
+    uint8_t *_waveformRow = NULL;
+
+    // Where the LUTs and line/row buffers are allocated, set before beginWaveformEngine() (memory placement policy).
+    uint32_t _waveformCaps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+
+  private:
+    void buildLine(volatile uint8_t *_line, const struct waveformPhase *_phase, uint8_t _frame, const uint8_t *_row);
+    void fillLine(volatile uint8_t *_line, uint8_t _data);
+
+    const struct waveformTable *_waveformTables[3] = {NULL, NULL, NULL};
+    int _waveformWidth = 0;
+    int _waveformHeight = 0;
+    uint8_t _waveformFlags = 0;
+    uint8_t _phaseCount = 0;
+    uint32_t _phaseTime[WAVEFORM_MAX_PHASES];
+    uint32_t _refreshTime = 0;
+    uint32_t _cpuFreeTime = 0;
+};
+
+#endif